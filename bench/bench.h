@@ -0,0 +1,39 @@
+/* bench.h
+ *
+ * Small timing helpers shared by the libcgs benchmarks.
+ */
+#pragma once
+
+#include <stdio.h>
+#include <time.h>
+
+/**
+ * bench_now
+ *
+ * @return      A monotonic timestamp in seconds.
+ */
+static inline double
+bench_now(void)
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * bench_report
+ *
+ * Print one result line: the name, the time per run and the throughput.
+ *
+ * @param name  The name of the measurement.
+ * @param secs  The total time of all runs in seconds.
+ * @param runs  The number of runs.
+ * @param items The number of items processed per run.
+ */
+static inline void
+bench_report(const char* name, double secs, size_t runs, size_t items)
+{
+        double per = secs / (double)runs;
+        printf("%-32s %10.3f ms %10.2f Mitems/s\n", name, per * 1e3,
+                        (double)items / per * 1e-6);
+}
@@ -0,0 +1,105 @@
+/* bench_find.c
+ *
+ * Substring search with cgs_memfind against the byte-at-a-time double loop
+ * cgs_string_find used before, on generated text and random binary data.
+ * Needles are taken from the corpus with their last byte changed so that
+ * they never match and the whole buffer is scanned.
+ *
+ * Usage: find_bench [megabytes]
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "cgs_string_utils.h"
+
+enum { RUNS = 5 };
+
+static size_t
+naive_find(const char* s, size_t n, const char* sub, size_t m)
+{
+        size_t i = 0;
+        while (i < n) {
+                for (size_t j = 0; j < m; ++j)
+                        if ((i + j >= n) || (s[i+j] != sub[j]))
+                                goto next_iter;
+                return i;
+next_iter:
+                ++i;
+        }
+        return n;
+}
+
+static void
+fill_text(char* buf, size_t n)
+{
+        static const char* words[] = {
+                "the", "quick", "brown", "fox", "jumps", "over", "lazy",
+                "dog", "and", "then", "some", "more", "words", "follow",
+        };
+        unsigned x = 1;
+        for (size_t i = 0; i < n; ) {
+                x = x * 1103515245u + 12345u;
+                const char* w = words[(x >> 16) % 14];
+                for ( ; *w && i < n; ++w)
+                        buf[i++] = *w;
+                if (i < n)
+                        buf[i++] = ' ';
+        }
+}
+
+static void
+fill_binary(char* buf, size_t n)
+{
+        unsigned x = 1;
+        for (size_t i = 0; i < n; ++i) {
+                x = x * 1103515245u + 12345u;
+                buf[i] = (char)(x >> 16);
+        }
+}
+
+static size_t
+run(const char* corpus, const char* buf, size_t n)
+{
+        static const size_t lens[] = { 1, 4, 16, 64, 256 };
+        char name[64];
+        char sub[256];
+        size_t sink = 0;
+
+        for (size_t k = 0; k < sizeof(lens) / sizeof(lens[0]); ++k) {
+                const size_t m = lens[k];
+                memcpy(sub, &buf[n / 2], m);
+                sub[m - 1] = '#';
+
+                double t = bench_now();
+                for (int r = 0; r < RUNS; ++r)
+                        sink += naive_find(buf, n, sub, m);
+                snprintf(name, sizeof(name), "%s naive m=%zu", corpus, m);
+                bench_report(name, bench_now() - t, RUNS, n);
+
+                t = bench_now();
+                for (int r = 0; r < RUNS; ++r)
+                        sink += cgs_memfind(buf, n, sub, m);
+                snprintf(name, sizeof(name), "%s memfind m=%zu", corpus, m);
+                bench_report(name, bench_now() - t, RUNS, n);
+        }
+        return sink;
+}
+
+int main(int argc, char* argv[])
+{
+        size_t mb = argc > 1 ? strtoul(argv[1], NULL, 10) : 8;
+        size_t n = mb * 1024 * 1024;
+
+        char* buf = malloc(n);
+        if (!buf)
+                return EXIT_FAILURE;
+
+        fill_text(buf, n);
+        size_t sink = run("text", buf, n);
+        fill_binary(buf, n);
+        sink += run("binary", buf, n);
+
+        free(buf);
+        return sink == 1;               // keep the results alive
+}
@@ -0,0 +1,100 @@
+/* bench_format.c
+ *
+ * Number formatting with the cgs_string append functions against snprintf
+ * into a stack buffer and against the push-and-reverse loop
+ * cgs_string_from_int used before. The appends build one long string; the
+ * others produce each number on its own and copy nothing.
+ *
+ * Usage: format_bench [count]
+ */
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "cgs_string.h"
+
+enum { RUNS = 5 };
+
+static size_t
+push_reverse(int n)
+{
+        struct cgs_string t = cgs_string_new();
+        int sign = n < 0 ? -1 : 1;
+        n *= sign;
+        do {
+                cgs_string_push(&t, '0' + n % 10);
+        } while ((n /= 10) != 0);
+        if (sign == -1)
+                cgs_string_push(&t, '-');
+        cgs_string_reverse(&t);
+
+        size_t len = t.length;
+        cgs_string_free(&t);
+        return len;
+}
+
+int main(int argc, char* argv[])
+{
+        size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+        uint64_t* vals = malloc(count * sizeof(uint64_t));
+        if (!vals)
+                return EXIT_FAILURE;
+
+        uint64_t x = 1;
+        for (size_t i = 0; i < count; ++i) {
+                x = x * 6364136223846793005u + 1442695040888963407u;
+                vals[i] = x >> (x >> 58);       // a spread of lengths
+        }
+
+        struct cgs_string s = cgs_string_new();
+        size_t sink = 0;
+        char buf[32];
+
+        double t = bench_now();
+        for (int r = 0; r < RUNS; ++r)
+                for (size_t i = 0; i < count; ++i)
+                        sink += push_reverse((int)vals[i]);
+        bench_report("int push/reverse", bench_now() - t, RUNS, count);
+
+        t = bench_now();
+        for (int r = 0; r < RUNS; ++r)
+                for (size_t i = 0; i < count; ++i)
+                        sink += snprintf(buf, sizeof(buf), "%d", (int)vals[i]);
+        bench_report("int snprintf", bench_now() - t, RUNS, count);
+
+        t = bench_now();
+        for (int r = 0; r < RUNS; ++r, sink += s.length, cgs_string_clear(&s))
+                for (size_t i = 0; i < count; ++i)
+                        cgs_string_append_int(&s, (int)vals[i]);
+        bench_report("int append", bench_now() - t, RUNS, count);
+
+        t = bench_now();
+        for (int r = 0; r < RUNS; ++r)
+                for (size_t i = 0; i < count; ++i)
+                        sink += snprintf(buf, sizeof(buf), "%" PRIu64, vals[i]);
+        bench_report("u64 snprintf", bench_now() - t, RUNS, count);
+
+        t = bench_now();
+        for (int r = 0; r < RUNS; ++r, sink += s.length, cgs_string_clear(&s))
+                for (size_t i = 0; i < count; ++i)
+                        cgs_string_append_u64(&s, vals[i]);
+        bench_report("u64 append", bench_now() - t, RUNS, count);
+
+        t = bench_now();
+        for (int r = 0; r < RUNS; ++r)
+                for (size_t i = 0; i < count; ++i)
+                        sink += snprintf(buf, sizeof(buf), "%.17g", (double)vals[i] * 1e-9);
+        bench_report("double snprintf %.17g", bench_now() - t, RUNS, count);
+
+        t = bench_now();
+        for (int r = 0; r < RUNS; ++r, sink += s.length, cgs_string_clear(&s))
+                for (size_t i = 0; i < count; ++i)
+                        cgs_string_append_double(&s, (double)vals[i] * 1e-9);
+        bench_report("double append", bench_now() - t, RUNS, count);
+
+        cgs_string_free(&s);
+        free(vals);
+        return sink == 1;               // keep the results alive
+}
@@ -0,0 +1,56 @@
+/* bench_hugepage.c
+ *
+ * Random reads over a large vector allocated by the C library, the aligned
+ * allocator and the huge page allocator. With 4 KiB pages nearly every read
+ * misses the TLB once the vector is far larger than the TLB reach.
+ *
+ * Usage: hugepage_bench [megabytes]
+ */
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "cgs_alloc.h"
+#include "cgs_vector.h"
+
+enum { RUNS = 3, READS = 1 << 24 };
+
+static uint64_t
+run(size_t n, const struct cgs_allocator* a, const char* name)
+{
+        struct cgs_vector v = cgs_vector_new_with(sizeof(uint64_t), a);
+        if (!cgs_vector_resize(&v, n))
+                exit(EXIT_FAILURE);
+
+        uint64_t* p = cgs_vector_data_mut(&v);
+        for (size_t i = 0; i < n; ++i)          // fault every page in
+                p[i] = i;
+
+        uint64_t sink = 0;
+        uint64_t x = 88172645463325252ull;
+        double t = bench_now();
+        for (int r = 0; r < RUNS; ++r) {
+                for (size_t i = 0; i < READS; ++i) {
+                        x ^= x << 13;           // xorshift64
+                        x ^= x >> 7;
+                        x ^= x << 17;
+                        sink += p[x % n];
+                }
+        }
+        bench_report(name, bench_now() - t, RUNS, READS);
+
+        cgs_vector_free(&v);
+        return sink;
+}
+
+int main(int argc, char* argv[])
+{
+        size_t mb = argc > 1 ? strtoul(argv[1], NULL, 10) : 256;
+        size_t n = mb * 1024 * 1024 / sizeof(uint64_t);
+
+        uint64_t sink = run(n, NULL, "random read malloc");
+        sink += run(n, cgs_allocator_aligned(), "random read aligned");
+        sink += run(n, cgs_allocator_huge(), "random read huge");
+
+        return sink == 1;               // keep the sums alive
+}
@@ -0,0 +1,101 @@
+/* bench_multimatch.c
+ *
+ * Keyword scanning of log lines with one Aho-Corasick pass per line against
+ * one cgs_memfind call per keyword per line.
+ *
+ * Usage: multimatch_bench [lines] [keywords]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "cgs_multimatch.h"
+#include "cgs_string_utils.h"
+
+enum { RUNS = 3, LINE = 120, WORD = 8 };
+
+static unsigned rng = 1;
+
+static char
+random_letter(void)
+{
+        rng = rng * 1103515245u + 12345u;
+        return 'a' + (rng >> 16) % 26;
+}
+
+static void
+count_hit(const void* hit, size_t i, void* data)
+{
+        (void)hit;
+        (void)i;
+        ++*(size_t*)data;
+}
+
+int main(int argc, char* argv[])
+{
+        size_t lines = argc > 1 ? strtoul(argv[1], NULL, 10) : 20000;
+        size_t nkeys = argc > 2 ? strtoul(argv[2], NULL, 10) : 300;
+
+        // words of lowercase letters, so keywords hit now and then
+        char* log = malloc(lines * LINE);
+        char* keys = malloc(nkeys * WORD);
+        if (!log || !keys)
+                return EXIT_FAILURE;
+        for (size_t i = 0; i < lines * LINE; ++i)
+                log[i] = i % WORD == WORD - 1 ? ' ' : random_letter();
+        for (size_t i = 0; i < nkeys * WORD; ++i)
+                keys[i] = random_letter();
+
+        const size_t klen = 4;          // short enough to occur
+        struct cgs_multimatch mm = cgs_multimatch_new();
+        for (size_t k = 0; k < nkeys; ++k) {
+                struct cgs_strsub ss = cgs_strsub_new(&keys[k * WORD], klen);
+                cgs_multimatch_add(&mm, &ss);
+        }
+
+        double t = bench_now();
+        if (!cgs_multimatch_compile(&mm))
+                return EXIT_FAILURE;
+        printf("compiled %zu keywords into %zu states x %zu classes "
+                        "in %.3f ms\n", nkeys, mm.states, mm.classes,
+                        (bench_now() - t) * 1e3);
+
+        size_t loop = 0;
+        t = bench_now();
+        for (int r = 0; r < RUNS; ++r) {
+                for (size_t l = 0; l < lines; ++l) {
+                        const char* line = &log[l * LINE];
+                        for (size_t k = 0; k < nkeys; ++k) {
+                                const char* key = &keys[k * WORD];
+                                size_t n = LINE;
+                                for (size_t i = 0; i < n; ++i) {
+                                        size_t p = cgs_memfind(&line[i],
+                                                        n - i, key, klen);
+                                        if (p == n - i)
+                                                break;
+                                        ++loop;
+                                        i += p;
+                                }
+                        }
+                }
+        }
+        bench_report("per-keyword memfind", bench_now() - t, RUNS, lines);
+
+        size_t ac = 0;
+        t = bench_now();
+        for (int r = 0; r < RUNS; ++r) {
+                for (size_t l = 0; l < lines; ++l) {
+                        struct cgs_strsub ss = cgs_strsub_new(&log[l * LINE],
+                                        LINE);
+                        cgs_multimatch_scan(&mm, &ss, count_hit, &ac);
+                }
+        }
+        bench_report("multimatch", bench_now() - t, RUNS, lines);
+        printf("matches: %zu / %zu\n", loop / RUNS, ac / RUNS);
+
+        cgs_multimatch_free(&mm);
+        free(keys);
+        free(log);
+        return loop != ac;
+}
@@ -0,0 +1,91 @@
+/* bench_parallel.c
+ *
+ * Scaling of the parallel vector operations over the thread count.
+ *
+ * Usage: parallel_bench [elements] [max threads]
+ */
+#include <stdlib.h>
+
+#include "bench.h"
+#include "cgs_vector.h"
+#include "cgs_parallel.h"
+
+enum { RUNS = 5 };
+
+static void
+heavy_op(void* p, size_t i, void* data)
+{
+        (void)i;
+        (void)data;
+        double* x = p;
+        double acc = *x;
+        for (int k = 0; k < 64; ++k)    // stand-in for parsing or scoring
+                acc = acc * 0.999 + 1.0 / (acc + 1.0);
+        *x = acc;
+}
+
+static void
+sum_double(void* acc, const void* e)
+{
+        *(double*)acc += *(const double*)e;
+}
+
+static void
+combine_double(void* acc, const void* part)
+{
+        *(double*)acc += *(const double*)part;
+}
+
+int main(int argc, char* argv[])
+{
+        size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+        size_t max = argc > 2
+                ? strtoul(argv[2], NULL, 10)
+                : cgs_parallel_threads(NULL);
+
+        struct cgs_vector v = cgs_vector_new(sizeof(double));
+        if (!cgs_vector_resize(&v, n))
+                return EXIT_FAILURE;
+
+        double t = bench_now();
+        for (int r = 0; r < RUNS; ++r)
+                cgs_vector_transform(&v, heavy_op, NULL);
+        bench_report("transform sequential", bench_now() - t, RUNS, n);
+
+        char name[64];
+        for (size_t th = 1; th <= max; th *= 2) {
+                struct cgs_parallel_opts opts = { .threads = th };
+
+                t = bench_now();
+                for (int r = 0; r < RUNS; ++r)
+                        cgs_vector_transform_parallel(&v, heavy_op, NULL,
+                                        &opts);
+                snprintf(name, sizeof(name), "transform_parallel %zu", th);
+                bench_report(name, bench_now() - t, RUNS, n);
+        }
+
+        double sink = 0.0;
+        for (size_t th = 1; th <= max; th *= 2) {
+                for (int ordered = 0; ordered <= 1; ++ordered) {
+                        struct cgs_parallel_opts opts = {
+                                .threads = th,
+                                .ordered = ordered,
+                        };
+
+                        t = bench_now();
+                        for (int r = 0; r < RUNS; ++r) {
+                                double sum = 0.0;
+                                cgs_vector_reduce_parallel(&v, &sum,
+                                                sizeof(sum), sum_double,
+                                                combine_double, &opts);
+                                sink += sum;
+                        }
+                        snprintf(name, sizeof(name), "reduce_parallel %zu%s",
+                                        th, ordered ? " ordered" : "");
+                        bench_report(name, bench_now() - t, RUNS, n);
+                }
+        }
+
+        cgs_vector_free(&v);
+        return sink != sink;            // keep the sums alive
+}
@@ -0,0 +1,105 @@
+/* bench_parse.c
+ *
+ * Number parsing with cgs_parse against the C library and the digit-at-a-
+ * time cgs_strtoi, on generated newline-separated data in the style of
+ * data/integers.txt. Integers are a mix of short values and full 64-bit
+ * ones; doubles are printed with six to seventeen significant digits.
+ *
+ * Usage: parse_bench [count]
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "cgs_parse.h"
+#include "cgs_string_utils.h"
+
+enum { RUNS = 5 };
+
+static char*
+fill(size_t count, int real, size_t* len)
+{
+        char* buf = malloc(count * 32);
+        if (!buf)
+                return NULL;
+
+        uint64_t x = 1;
+        size_t n = 0;
+        for (size_t i = 0; i < count; ++i) {
+                x = x * 6364136223846793005u + 1442695040888963407u;
+                if (real)
+                        n += sprintf(&buf[n], "%.*g\n", 6 + (int)(x >> 60),
+                                        (double)(x >> 11) * 0x1p-40);
+                else if (i % 2)
+                        n += sprintf(&buf[n], "%d\n", (int)(x >> 56) - 128);
+                else
+                        n += sprintf(&buf[n], "%lld\n", (long long)(x >> 1));
+        }
+        *len = n;
+        return buf;
+}
+
+int main(int argc, char* argv[])
+{
+        size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+        size_t n = 0;
+        char* ints = fill(count, 0, &n);
+        if (!ints)
+                return EXIT_FAILURE;
+        const char* end = ints + n;
+
+        int64_t sink = 0;
+        double t = bench_now();
+        for (int r = 0; r < RUNS; ++r)
+                for (char* p = ints; p < end; ++p)
+                        sink += strtoll(p, &p, 10);
+        bench_report("int strtoll", bench_now() - t, RUNS, count);
+
+        // cgs_strtoi rejects values past INT_MAX; skip those lines whole
+        t = bench_now();
+        for (int r = 0; r < RUNS; ++r)
+                for (const char* p = ints; p < end; ++p) {
+                        const char* q = p;
+                        sink += cgs_strtoi(p, &q);
+                        p = q != p ? q : strchr(p, '\n');
+                }
+        bench_report("int cgs_strtoi", bench_now() - t, RUNS, count);
+
+        t = bench_now();
+        for (int r = 0; r < RUNS; ++r) {
+                int64_t v;
+                for (const char* p = ints; p < end; ++p) {
+                        p = cgs_parse_i64(p, end - p, 10, &v);
+                        sink += v;
+                }
+        }
+        bench_report("int cgs_parse_i64", bench_now() - t, RUNS, count);
+        free(ints);
+
+        char* reals = fill(count, 1, &n);
+        if (!reals)
+                return EXIT_FAILURE;
+        end = reals + n;
+
+        double dsink = 0.0;
+        t = bench_now();
+        for (int r = 0; r < RUNS; ++r)
+                for (char* p = reals; p < end; ++p)
+                        dsink += strtod(p, &p);
+        bench_report("double strtod", bench_now() - t, RUNS, count);
+
+        t = bench_now();
+        for (int r = 0; r < RUNS; ++r) {
+                double d;
+                for (const char* p = reals; p < end; ++p) {
+                        p = cgs_parse_double(p, end - p, &d);
+                        dsink += d;
+                }
+        }
+        bench_report("double cgs_parse_double", bench_now() - t, RUNS, count);
+        free(reals);
+
+        return sink == 1 && dsink == 1.0;       // keep the results alive
+}
@@ -0,0 +1,72 @@
+/* bench_pool.c
+ *
+ * Red-black tree insert throughput and in-order traversal speed with nodes
+ * from the C library versus a node pool.
+ *
+ * Usage: pool_bench [elements]
+ */
+#include <stdlib.h>
+
+#include "bench.h"
+#include "cgs_compare.h"
+#include "cgs_pool.h"
+#include "cgs_rbt.h"
+
+enum { RUNS = 5 };
+
+static void
+sum_int(const void* e, size_t i, void* data)
+{
+        (void)i;
+        *(long*)data += *(const int*)e;
+}
+
+static long
+run(size_t n, struct cgs_pool* pool, const char* name)
+{
+        char label[64];
+        double insert = 0.0;
+        double traverse = 0.0;
+        long sink = 0;
+
+        for (int r = 0; r < RUNS; ++r) {
+                struct cgs_rbt tree = cgs_rbt_new(cgs_int_cmp, NULL);
+                if (pool)
+                        cgs_rbt_use_pool(&tree, pool);
+
+                struct cgs_variant var = { 0 };
+                unsigned x = 12345;
+                double t = bench_now();
+                for (size_t i = 0; i < n; ++i) {
+                        x = x * 1103515245u + 12345u;
+                        cgs_variant_set_int(&var, (int)(x >> 1));
+                        cgs_rbt_insert(&tree, &var);
+                }
+                insert += bench_now() - t;
+
+                t = bench_now();
+                cgs_rbt_foreach(&tree, sum_int, &sink);
+                traverse += bench_now() - t;
+
+                cgs_rbt_free(&tree);
+        }
+
+        snprintf(label, sizeof(label), "rbt insert %s", name);
+        bench_report(label, insert, RUNS, n);
+        snprintf(label, sizeof(label), "rbt traverse %s", name);
+        bench_report(label, traverse, RUNS, n);
+        return sink;
+}
+
+int main(int argc, char* argv[])
+{
+        size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+
+        long sink = run(n, NULL, "malloc");
+
+        struct cgs_pool pool = cgs_pool_new(cgs_rbt_node_size(), 0);
+        sink += run(n, &pool, "pool");
+        cgs_pool_free(&pool);
+
+        return sink == 1;               // keep the sums alive
+}
@@ -0,0 +1,99 @@
+/* bench_reader.c
+ *
+ * Line reading throughput of cgs_io_getline against cgs_reader on a stream
+ * and on a file descriptor, over a generated file of text lines of 20 to 140
+ * bytes. The file is read once beforehand so all three read from the page
+ * cache. Throughput is reported in bytes.
+ *
+ * Usage: reader_bench [megabytes]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "cgs_io.h"
+
+struct totals {
+        size_t lines;
+        size_t bytes;
+};
+
+static struct totals
+run_getline(FILE* file)
+{
+        struct totals t = { 0 };
+        struct cgs_string line = cgs_string_new();
+        // cgs_io_getline reports empty lines and the end alike; there are
+        // no empty lines in the file
+        while (cgs_io_getline(file, &line) > 0) {
+                ++t.lines;
+                t.bytes += line.length;
+                cgs_string_clear(&line);
+        }
+        cgs_string_free(&line);
+        return t;
+}
+
+static struct totals
+run_reader(struct cgs_reader* r)
+{
+        struct totals t = { 0 };
+        struct cgs_strsub line;
+        while (cgs_reader_getline(r, &line)) {
+                ++t.lines;
+                t.bytes += line.length;
+        }
+        cgs_reader_free(r);
+        return t;
+}
+
+int main(int argc, char* argv[])
+{
+        size_t mb = argc > 1 ? strtoul(argv[1], NULL, 10) : 1024;
+        size_t n = mb * 1024 * 1024;
+
+        FILE* file = tmpfile();
+        if (!file)
+                return EXIT_FAILURE;
+
+        char line[160];
+        unsigned x = 1;
+        for (size_t written = 0; written < n; ) {
+                x = x * 1103515245u + 12345u;
+                size_t len = 20 + (x >> 16) % 120;
+                for (size_t i = 0; i < len; ++i)
+                        line[i] = 'a' + (i + x) % 26;
+                line[len++] = '\n';
+                fwrite(line, 1, len, file);
+                written += len;
+        }
+        fflush(file);
+
+        rewind(file);
+        struct cgs_reader warm = cgs_reader_new_file(file);
+        run_reader(&warm);
+
+        rewind(file);
+        double t = bench_now();
+        struct totals a = run_getline(file);
+        bench_report("cgs_io_getline", bench_now() - t, 1, n);
+
+        rewind(file);
+        struct cgs_reader rf = cgs_reader_new_file(file);
+        t = bench_now();
+        struct totals b = run_reader(&rf);
+        bench_report("cgs_reader FILE*", bench_now() - t, 1, n);
+
+        lseek(fileno(file), 0, SEEK_SET);
+        struct cgs_reader rd = cgs_reader_new_fd(fileno(file));
+        t = bench_now();
+        struct totals c = run_reader(&rd);
+        bench_report("cgs_reader fd", bench_now() - t, 1, n);
+
+        fclose(file);
+
+        int same = a.lines == b.lines && a.lines == c.lines &&
+                a.bytes == b.bytes && a.bytes == c.bytes;
+        return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,68 @@
+/* bench_rope.c
+ *
+ * Random small replacements and inserts across a large document, applied to
+ * a cgs_rope and to a flat cgs_string with cgs_string_replace, which shifts
+ * the tail of the buffer on every edit.
+ *
+ * Usage: rope_bench [megabytes] [edits]
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "cgs_rope.h"
+#include "cgs_string.h"
+
+int main(int argc, char* argv[])
+{
+        size_t mb = argc > 1 ? strtoul(argv[1], NULL, 10) : 8;
+        size_t edits = argc > 2 ? strtoul(argv[2], NULL, 10) : 10000;
+        size_t n = mb * 1024 * 1024;
+
+        char* doc = malloc(n + 1);
+        if (!doc)
+                return EXIT_FAILURE;
+        for (size_t i = 0; i < n; ++i)
+                doc[i] = 'a' + i % 26;
+        doc[n] = '\0';
+
+        struct cgs_string rep = cgs_string_new();
+        cgs_string_from("REPLACEMENT", &rep);
+
+        struct cgs_string flat = cgs_string_new();
+        cgs_string_from(doc, &flat);
+        unsigned x = 1;
+        double t = bench_now();
+        for (size_t i = 0; i < edits; ++i) {
+                x = x * 1103515245u + 12345u;
+                size_t pos = (x >> 8) % flat.length;
+                cgs_string_replace(&flat, pos, i % 2 ? 11 : 4, &rep);
+        }
+        bench_report("string replace", bench_now() - t, 1, edits);
+
+        struct cgs_rope rope = cgs_rope_new();
+        cgs_rope_append(&rope, doc, n);
+        x = 1;
+        t = bench_now();
+        for (size_t i = 0; i < edits; ++i) {
+                x = x * 1103515245u + 12345u;
+                size_t pos = (x >> 8) % cgs_rope_length(&rope);
+                cgs_rope_replace(&rope, pos, i % 2 ? 11 : 4,
+                                cgs_string_data(&rep), rep.length);
+        }
+        bench_report("rope replace", bench_now() - t, 1, edits);
+
+        // both received the same edits
+        struct cgs_string out = cgs_string_new();
+        cgs_rope_to_string(&rope, &out);
+        int same = out.length == flat.length &&
+                memcmp(cgs_string_data(&out), cgs_string_data(&flat),
+                                out.length) == 0;
+
+        cgs_string_free(&out);
+        cgs_rope_free(&rope);
+        cgs_string_free(&flat);
+        cgs_string_free(&rep);
+        free(doc);
+        return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
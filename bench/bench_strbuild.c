@@ -0,0 +1,63 @@
+/* bench_strbuild.c
+ *
+ * Assemble a large text from many short pieces, once by appending to a
+ * growing cgs_string and once with a cgs_strbuild flattened at the end.
+ *
+ * Usage: strbuild_bench [pieces] [runs]
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "cgs_strbuild.h"
+#include "cgs_string.h"
+
+static const char* const words[] = {
+        "alpha, ", "beta, ", "gamma, ", "delta, ", "epsilon, ", "zeta, ",
+        "eta, ", "theta\n",
+};
+
+int main(int argc, char* argv[])
+{
+        size_t pieces = argc > 1 ? strtoul(argv[1], NULL, 10) : 4000000;
+        size_t runs = argc > 2 ? strtoul(argv[2], NULL, 10) : 5;
+
+        size_t lens[8];
+        for (size_t i = 0; i < 8; ++i)
+                lens[i] = strlen(words[i]);
+
+        struct cgs_string flat = cgs_string_new();
+        double t = bench_now();
+        for (size_t r = 0; r < runs; ++r) {
+                cgs_string_free(&flat);
+                flat = cgs_string_new();
+                for (size_t i = 0; i < pieces; ++i)
+                        cgs_string_cat_str(&flat, words[i % 8], lens[i % 8]);
+        }
+        bench_report("string cat_str", bench_now() - t, runs, pieces);
+
+        struct cgs_string out = cgs_string_new();
+        double build = 0.0;
+        double flatten = 0.0;
+        for (size_t r = 0; r < runs; ++r) {
+                struct cgs_strbuild sb = cgs_strbuild_new();
+                t = bench_now();
+                for (size_t i = 0; i < pieces; ++i)
+                        cgs_strbuild_append(&sb, words[i % 8], lens[i % 8]);
+                double mid = bench_now();
+                cgs_strbuild_to_string(&sb, &out);
+                flatten += bench_now() - mid;
+                build += mid - t;
+                cgs_strbuild_free(&sb);
+        }
+        bench_report("strbuild append", build, runs, pieces);
+        bench_report("strbuild flatten", flatten, runs, pieces);
+
+        int same = out.length == flat.length &&
+                memcmp(cgs_string_data(&out), cgs_string_data(&flat),
+                                out.length) == 0;
+
+        cgs_string_free(&out);
+        cgs_string_free(&flat);
+        return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,93 @@
+/* bench_utf8.c
+ *
+ * UTF-8 validation and code point counting over ASCII, mostly-ASCII and
+ * CJK text, against a byte-at-a-time decoding loop. Build with
+ * -march=native or -mssse3 for the vector validator.
+ *
+ * Usage: utf8_bench [megabytes] [runs]
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "cgs_utf8.h"
+
+static size_t
+byte_loop(const char* s, size_t n)
+{
+        size_t i = 0;
+        uint32_t cp;
+        while (i < n) {
+                size_t len = cgs_utf8_decode(&s[i], n - i, &cp);
+                if (len == 0)
+                        return i;
+                i += len;
+        }
+        return n;
+}
+
+static void
+fill(char* buf, size_t n, const char* piece)
+{
+        // whole pieces only, so no sequence is cut off at the end
+        size_t len = strlen(piece);
+        size_t i = 0;
+        for ( ; i + len <= n; i += len)
+                memcpy(&buf[i], piece, len);
+        memset(&buf[i], ' ', n - i);
+}
+
+int main(int argc, char* argv[])
+{
+        size_t mb = argc > 1 ? strtoul(argv[1], NULL, 10) : 64;
+        size_t runs = argc > 2 ? strtoul(argv[2], NULL, 10) : 10;
+        size_t n = mb * 1024 * 1024;
+
+        char* buf = malloc(n);
+        if (!buf)
+                return EXIT_FAILURE;
+
+        static const struct {
+                const char* name;
+                const char* piece;
+        } texts[] = {
+                { "ascii", "The quick brown fox jumps over the lazy dog. " },
+                { "latin", "Le c\xc5\x93ur a ses raisons que la raison ne "
+                        "conna\xc3\xaet point. " },
+                { "cjk", "\xe5\xad\xa6\xe8\x80\x8c\xe6\x97\xb6\xe4\xb9\xa0"
+                        "\xe4\xb9\x8b\xef\xbc\x8c\xe4\xb8\x8d\xe4\xba\xa6"
+                        "\xe8\xaf\xb4\xe4\xb9\x8e\xe3\x80\x82" },
+        };
+
+        int ok = 1;
+        for (size_t k = 0; k < sizeof(texts) / sizeof(texts[0]); ++k) {
+                fill(buf, n, texts[k].piece);
+                char name[64];
+                size_t sink = 0;
+
+                double t = bench_now();
+                for (size_t r = 0; r < runs; ++r)
+                        sink += byte_loop(buf, n);
+                snprintf(name, sizeof(name), "%s byte loop", texts[k].name);
+                bench_report(name, bench_now() - t, runs, n);
+
+                t = bench_now();
+                for (size_t r = 0; r < runs; ++r)
+                        sink -= cgs_utf8_validate(buf, n);
+
+                snprintf(name, sizeof(name), "%s validate", texts[k].name);
+                bench_report(name, bench_now() - t, runs, n);
+
+                t = bench_now();
+                for (size_t r = 0; r < runs; ++r)
+                        sink += cgs_utf8_count(buf, n);
+                snprintf(name, sizeof(name), "%s count", texts[k].name);
+                bench_report(name, bench_now() - t, runs, n);
+
+                ok = ok && sink > 0;
+        }
+
+        free(buf);
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -25,14 +25,26 @@
 #pragma once
 
 #include "cgs_vector.h"
+#include "cgs_alloc.h"
+#include "cgs_arena.h"
 #include "cgs_bst.h"
 #include "cgs_compare.h"
 #include "cgs_defs.h"
+#include "cgs_deque.h"
 #include "cgs_error.h"
+#include "cgs_format.h"
 #include "cgs_hashtab.h"
 #include "cgs_heap.h"
 #include "cgs_io.h"
+#include "cgs_multimatch.h"
+#include "cgs_parallel.h"
+#include "cgs_parse.h"
+#include "cgs_pool.h"
 #include "cgs_rbt.h"
+#include "cgs_rope.h"
+#include "cgs_segvec.h"
+#include "cgs_strbuild.h"
+#include "cgs_utf8.h"
 #include "cgs_variant.h"
 #include "cgs_string.h"
 #include "cgs_string_utils.h"
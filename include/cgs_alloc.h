@@ -0,0 +1,223 @@
+/* cgs_alloc.h
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_alloc.h
+ *
+ * This file contains the public API for the libcgs allocator interface.
+ *
+ * Allocators
+ *
+ * Every container holds a pointer to the allocator it was created with. A
+ * NULL allocator means the C library's malloc, realloc and free, which is
+ * what containers use unless told otherwise.
+ *
+ * The allocator a container is created with is the calling thread's default
+ * allocator at that time. Set the default to run a whole unit of work out
+ * of one allocator, or attach one to a single container with its
+ * `*_set_allocator` function before it allocates anything.
+ *
+ * Memory handed out of a container by one of the `*_xfer` functions still
+ * belongs to the container's allocator and must be released through it.
+ *
+ * Two allocators are provided for large buffers. `cgs_allocator_aligned`
+ * aligns every allocation to a cache line for SIMD kernels.
+ * `cgs_allocator_huge` does the same and maps allocations of at least a
+ * huge page directly, asking for explicit huge pages first and falling back
+ * to transparent huge pages, then to ordinary pages, when the system has
+ * none to give.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#pragma once
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Allocator Types
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * Allocator Constants
+ *
+ * CGS_ALLOC_ALIGN is the alignment of the aligned and huge allocators.
+ * CGS_ALLOC_HUGE_PAGE is the huge page size and the smallest allocation the
+ * huge allocator maps directly.
+ */
+enum cgs_alloc_constants {
+        CGS_ALLOC_ALIGN = 64,
+        CGS_ALLOC_HUGE_PAGE = 2 * 1024 * 1024,
+};
+
+/**
+ * struct cgs_allocator
+ *
+ * A set of memory management functions and the context they operate on.
+ * Sizes are passed back on realloc and free so that allocators that do not
+ * keep headers, like arenas and pools, can use them.
+ *
+ * @member alloc        Allocate 'size' bytes aligned for any type. Returns
+ *                      NULL on failure.
+ * @member realloc      Resize an allocation of 'old' bytes to 'size' bytes.
+ *                      Returns NULL on failure, leaving the old allocation
+ *                      intact. May be NULL to allocate, copy and free.
+ * @member free         Release an allocation of 'size' bytes. 'p' may be
+ *                      NULL.
+ * @member ctx          The context passed to each function.
+ */
+struct cgs_allocator {
+        void* (*alloc)(void* ctx, size_t size);
+        void* (*realloc)(void* ctx, void* p, size_t old, size_t size);
+        void (*free)(void* ctx, void* p, size_t size);
+        void* ctx;
+};
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Default Allocator Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_allocator_default
+ *
+ * Get the calling thread's default allocator.
+ *
+ * @return      The allocator new containers will use or NULL for the C
+ *              library.
+ */
+const struct cgs_allocator*
+cgs_allocator_default(void);
+
+/**
+ * cgs_allocator_set_default
+ *
+ * Set the calling thread's default allocator. Containers that already
+ * exist keep the allocator they were created with.
+ *
+ * @param a     The new default allocator or NULL for the C library.
+ *
+ * @return      The previous default so that it can be restored.
+ */
+const struct cgs_allocator*
+cgs_allocator_set_default(const struct cgs_allocator* a);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Large Buffer Allocator Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_allocator_aligned
+ *
+ * Get an allocator whose allocations are aligned to CGS_ALLOC_ALIGN bytes.
+ * Resizing always moves the allocation.
+ *
+ * @return      The aligned allocator.
+ */
+const struct cgs_allocator*
+cgs_allocator_aligned(void);
+
+/**
+ * cgs_allocator_huge
+ *
+ * Get an allocator for very large buffers. Allocations smaller than
+ * CGS_ALLOC_HUGE_PAGE behave like those of `cgs_allocator_aligned`. Larger
+ * ones are mapped in whole huge pages: explicit huge pages when the system
+ * has them reserved, otherwise huge-page-aligned memory advised for
+ * transparent huge pages. Resizing within the same number of huge pages
+ * does not move the allocation.
+ *
+ * @return      The huge page allocator.
+ */
+const struct cgs_allocator*
+cgs_allocator_huge(void);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Allocation Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_alloc
+ *
+ * Allocate memory from an allocator.
+ *
+ * @param a     The allocator or NULL for the C library.
+ * @param size  The number of bytes to allocate.
+ *
+ * @return      A pointer to the allocation or NULL on failure.
+ */
+inline void*
+cgs_alloc(const struct cgs_allocator* a, size_t size)
+{
+        return a ? a->alloc(a->ctx, size) : malloc(size);
+}
+
+/**
+ * cgs_realloc
+ *
+ * Resize an allocation made by the same allocator.
+ *
+ * @param a     The allocator or NULL for the C library.
+ * @param p     The allocation or NULL.
+ * @param old   The current size of the allocation in bytes.
+ * @param size  The new size in bytes.
+ *
+ * @return      A pointer to the resized allocation or NULL on failure, in
+ *              which case 'p' is untouched.
+ */
+inline void*
+cgs_realloc(const struct cgs_allocator* a, void* p, size_t old, size_t size)
+{
+        if (!a)
+                return realloc(p, size);
+        if (a->realloc)
+                return a->realloc(a->ctx, p, old, size);
+
+        void* q = a->alloc(a->ctx, size);
+        if (q && p) {
+                memcpy(q, p, old < size ? old : size);
+                a->free(a->ctx, p, old);
+        }
+        return q;
+}
+
+/**
+ * cgs_free
+ *
+ * Release an allocation made by the same allocator.
+ *
+ * @param a     The allocator or NULL for the C library.
+ * @param p     The allocation or NULL.
+ * @param size  The size of the allocation in bytes.
+ */
+inline void
+cgs_free(const struct cgs_allocator* a, void* p, size_t size)
+{
+        if (!a)
+                free(p);
+        else if (p)
+                a->free(a->ctx, p, size);
+}
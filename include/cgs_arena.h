@@ -0,0 +1,270 @@
+/* cgs_arena.h
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_arena.h
+ *
+ * This file contains the public API for the libcgs implementation of an
+ * arena, or bump, allocator.
+ *
+ * Arena
+ *
+ * Memory is handed out by bumping an offset through large chunks. Single
+ * allocations are never released; instead the whole arena is reset, or
+ * rewound to an earlier mark, at once. Chunks are kept for reuse until the
+ * arena is freed.
+ *
+ * An arena can back any container through `cgs_arena_allocator`. Frees from
+ * containers are then no-ops, apart from the most recent allocation which is
+ * given back so that a growing string or vector can extend in place.
+ *
+ * Builds defining CGS_ARENA_GUARD (Debug builds by default) place an
+ * inaccessible page after every chunk to catch overruns.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#pragma once
+
+#include <stddef.h>
+#include "cgs_alloc.h"
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Arena Types
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * Arena Constants
+ *
+ * CGS_ARENA_ALIGN is the alignment of allocations that do not ask for one.
+ * CGS_ARENA_CHUNK_SIZE is the default number of usable bytes per chunk.
+ */
+enum cgs_arena_constants {
+        CGS_ARENA_ALIGN = 16,
+        CGS_ARENA_CHUNK_SIZE = 64 * 1024,
+};
+
+/**
+ * struct cgs_arena_chunk
+ *
+ * Forward declaration of struct defined in source file.
+ */
+struct cgs_arena_chunk;
+
+/**
+ * struct cgs_arena
+ *
+ * A chunked bump allocator. Must not be moved once `cgs_arena_allocator` has
+ * been called on it.
+ *
+ * @member first        The first chunk.
+ * @member current      The chunk allocations are made from. Chunks after it
+ *                      are spare.
+ * @member chunk_size   The usable size of new chunks in bytes.
+ * @member last         The most recent allocation, for in-place growth.
+ * @member allocator    The allocator interface of this arena.
+ */
+struct cgs_arena {
+        struct cgs_arena_chunk* first;
+        struct cgs_arena_chunk* current;
+        size_t chunk_size;
+        void* last;
+        struct cgs_allocator allocator;
+};
+
+/**
+ * struct cgs_arena_mark
+ *
+ * A position in an arena to rewind to.
+ */
+struct cgs_arena_mark {
+        struct cgs_arena_chunk* chunk;
+        size_t used;
+};
+
+/**
+ * struct cgs_arena_stats
+ *
+ * @member used         Bytes handed out, including alignment padding.
+ * @member reserved     Usable bytes in all chunks.
+ * @member chunks       The number of chunks, in use or spare.
+ * @member chunks_used  The number of chunks holding allocations.
+ */
+struct cgs_arena_stats {
+        size_t used;
+        size_t reserved;
+        size_t chunks;
+        size_t chunks_used;
+};
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Arena Management Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_arena_new
+ *
+ * Create an empty arena. No memory is allocated until the first allocation.
+ *
+ * @param chunk_size    The usable size of each chunk in bytes or zero for
+ *                      CGS_ARENA_CHUNK_SIZE. Larger allocations get a chunk
+ *                      of their own.
+ *
+ * @return      An empty arena.
+ */
+struct cgs_arena
+cgs_arena_new(size_t chunk_size);
+
+/**
+ * cgs_arena_free
+ *
+ * Release all chunks of an arena. Everything allocated from it becomes
+ * invalid.
+ *
+ * @param a     The arena.
+ */
+void
+cgs_arena_free(struct cgs_arena* a);
+
+/**
+ * cgs_arena_reset
+ *
+ * Invalidate every allocation at once in O(1). The chunks are kept for
+ * reuse.
+ *
+ * @param a     The arena.
+ */
+void
+cgs_arena_reset(struct cgs_arena* a);
+
+/**
+ * cgs_arena_mark
+ *
+ * Record the current position of the arena.
+ *
+ * @param a     The arena.
+ *
+ * @return      A mark to pass to `cgs_arena_rewind`.
+ */
+struct cgs_arena_mark
+cgs_arena_mark(const struct cgs_arena* a);
+
+/**
+ * cgs_arena_rewind
+ *
+ * Release every allocation made since a mark in O(1). Marks nest: rewinding
+ * to a mark invalidates all marks taken after it.
+ *
+ * @param a     The arena.
+ * @param m     A mark taken from this arena.
+ */
+void
+cgs_arena_rewind(struct cgs_arena* a, struct cgs_arena_mark m);
+
+/**
+ * cgs_arena_stats
+ *
+ * Gather usage statistics. Walks the chunk list.
+ *
+ * @param a     The arena.
+ *
+ * @return      The statistics.
+ */
+struct cgs_arena_stats
+cgs_arena_stats(const struct cgs_arena* a);
+
+/**
+ * cgs_arena_allocator
+ *
+ * Get the allocator interface of an arena to attach to containers or to set
+ * as the thread's default. The arena must outlive the containers and must
+ * not be moved.
+ *
+ * @param a     The arena.
+ *
+ * @return      A pointer to the allocator.
+ */
+const struct cgs_allocator*
+cgs_arena_allocator(struct cgs_arena* a);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Arena Allocation Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_arena_alloc_aligned
+ *
+ * Allocate memory with a given alignment.
+ *
+ * @param a     The arena.
+ * @param size  The number of bytes to allocate.
+ * @param align The alignment. Must be a power of two.
+ *
+ * @return      A pointer to the allocation or NULL on failure.
+ */
+void*
+cgs_arena_alloc_aligned(struct cgs_arena* a, size_t size, size_t align);
+
+/**
+ * cgs_arena_alloc
+ *
+ * Allocate memory aligned to CGS_ARENA_ALIGN.
+ *
+ * @param a     The arena.
+ * @param size  The number of bytes to allocate.
+ *
+ * @return      A pointer to the allocation or NULL on failure.
+ */
+void*
+cgs_arena_alloc(struct cgs_arena* a, size_t size);
+
+/**
+ * cgs_arena_realloc
+ *
+ * Resize an allocation. The most recent allocation grows or shrinks in
+ * place when its chunk has room, others are copied.
+ *
+ * @param a     The arena.
+ * @param p     The allocation or NULL.
+ * @param old   The current size of the allocation.
+ * @param size  The new size.
+ *
+ * @return      A pointer to the resized allocation or NULL on failure.
+ */
+void*
+cgs_arena_realloc(struct cgs_arena* a, void* p, size_t old, size_t size);
+
+/**
+ * cgs_arena_strdup
+ *
+ * Duplicate a string into the arena.
+ *
+ * @param a     The arena.
+ * @param s     The string.
+ *
+ * @return      A pointer to the copy or NULL on failure.
+ */
+char*
+cgs_arena_strdup(struct cgs_arena* a, const char* s);
@@ -28,6 +28,8 @@
 
 #include "cgs_variant.h"
 #include "cgs_defs.h"
+#include "cgs_alloc.h"
+#include "cgs_pool.h"
 
 /**
  * Binary Search Tree
@@ -68,12 +70,14 @@ struct cgs_bst_node;
  * @member cmp          A comparison function to order the tree with.
  * @member ff           An optional freeing function for the elements of
  *                      the tree or NULL if they are trivially deallocated.
+ * @member alloc        The allocator of the nodes or NULL for the C library.
  */
 struct cgs_bst {
         struct cgs_bst_node* root;
         size_t length;
         CgsCmp3Way cmp;
         CgsFreeFunc ff;
+        const struct cgs_allocator* alloc;
 };
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
@@ -83,7 +87,8 @@ struct cgs_bst {
 /**
  * cgs_bst_new
  *
- * Create a new binary search tree.
+ * Create a new binary search tree. The tree uses the calling thread's
+ * default allocator.
  *
  * @param cmp   The comparison function to order the tree with.
  * @param ff    An optional freeing function for the elements of the tree or
@@ -104,6 +109,46 @@ cgs_bst_new(CgsCmp3Way cmp, CgsFreeFunc ff);
 void
 cgs_bst_free(struct cgs_bst* tree);
 
+/**
+ * cgs_bst_set_allocator
+ *
+ * Attach an allocator to an empty tree.
+ *
+ * @param tree  The tree.
+ * @param a     The allocator or NULL for the C library.
+ *
+ * @return      A pointer to the tree on success, NULL if the tree already
+ *              has nodes.
+ */
+void*
+cgs_bst_set_allocator(struct cgs_bst* tree, const struct cgs_allocator* a);
+
+/**
+ * cgs_bst_node_size
+ *
+ * Get the size of a tree node, the smallest block size of a pool that can
+ * hold the nodes of a binary search tree.
+ *
+ * @return      The size of a node in bytes.
+ */
+size_t
+cgs_bst_node_size(void);
+
+/**
+ * cgs_bst_use_pool
+ *
+ * Allocate the nodes of an empty tree from a pool. The pool must outlive
+ * the tree and may be shared by several trees.
+ *
+ * @param tree  The tree.
+ * @param pool  A pool with blocks of at least `cgs_bst_node_size()` bytes.
+ *
+ * @return      A pointer to the tree on success, NULL if the tree already
+ *              has nodes or the blocks of the pool are too small.
+ */
+void*
+cgs_bst_use_pool(struct cgs_bst* tree, struct cgs_pool* pool);
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * BST Inline Getters
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
@@ -182,3 +227,17 @@ cgs_bst_min(const struct cgs_bst* tree);
  */
 const void*
 cgs_bst_max(const struct cgs_bst* tree);
+
+/**
+ * cgs_bst_foreach
+ *
+ * Traverse a read-only tree in order and perform an operation using each of
+ * its elements.
+ *
+ * @param tree  A read-only pointer to the tree.
+ * @param f     A function to perform taking an element, its in-order index,
+ *              and a pointer to userdata.
+ * @param data  The userdata.
+ */
+void
+cgs_bst_foreach(const struct cgs_bst* tree, CgsUnaryOp f, void* data);
@@ -60,6 +60,19 @@ int cgs_int_cmp_rev(const void* a, const void* b);
  */
 int cgs_str_cmp(const void* a, const void* b);
 
+/**
+ * cgs_str_cmp_nocase
+ *
+ * Three-way comparison function for strings (char*, char[]) that ignores
+ * ASCII case.
+ *
+ * @param a	A pointer to the target string.
+ * @param b	A pointer to the compare string.
+ *
+ * @return	An integer indicating the result of the comparison.
+ */
+int cgs_str_cmp_nocase(const void* a, const void* b);
+
 /**
  * cgs_char_cmp
  *
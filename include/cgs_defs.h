@@ -194,3 +194,51 @@ typedef void* (*CgsCopyFunc)(const void* s, void* d);
  * @param d     The destination object.
  */
 typedef void (*CgsMoveFunc)(void* s, void* d);
+
+/**
+ * CgsGrowthFunc
+ *
+ * The signature of a growth policy for a dynamic container. Given the current
+ * capacity, return the next capacity to grow to. Used by
+ * `cgs_vector_set_growth()`.
+ *
+ * @param old   The current capacity, in elements. Zero for an unallocated
+ *              container.
+ *
+ * @return      The new capacity, in elements. Must be greater than 'old'.
+ */
+typedef size_t (*CgsGrowthFunc)(size_t old);
+
+/**
+ * CgsRangeOp
+ *
+ * The signature of the work function of `cgs_parallel_for()`. Called once
+ * per chunk of the index range.
+ *
+ * @param begin The first index of the chunk.
+ * @param end   One past the last index of the chunk.
+ * @param id    The index of the worker running the chunk, in [0:threads).
+ * @param data  The userdata.
+ */
+typedef void (*CgsRangeOp)(size_t begin, size_t end, size_t id, void* data);
+
+/**
+ * CgsReduceOp
+ *
+ * The signature of a reduction step. Fold an element into an accumulator.
+ *
+ * @param acc   The accumulator.
+ * @param e     The element.
+ */
+typedef void (*CgsReduceOp)(void* acc, const void* e);
+
+/**
+ * CgsCombineOp
+ *
+ * The signature of a function that merges one partial result of a
+ * reduction into another.
+ *
+ * @param acc   The accumulator to merge into.
+ * @param part  The partial result to merge.
+ */
+typedef void (*CgsCombineOp)(void* acc, const void* part);
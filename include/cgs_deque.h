@@ -0,0 +1,382 @@
+/* cgs_deque.h
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_deque.h
+ *
+ * This file contains the public API for the libcgs implementation of a
+ * double-ended queue.
+ *
+ * Deque
+ *
+ * A ring buffer with a power-of-two capacity. Elements may be pushed and
+ * popped at either end in O(1) and accessed by index relative to the front.
+ * When the ring is full it is unrolled into a buffer of twice the size so
+ * the front is back at offset zero.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#pragma once
+
+#include <stddef.h>
+#include "cgs_defs.h"
+#include "cgs_alloc.h"
+
+struct cgs_vector;
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Deque Types
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * struct cgs_deque
+ *
+ * A generic, double-ended queue.
+ *
+ * @member head         The offset of the front element in 'data'.
+ * @member length       The number of elements in the deque.
+ * @member capacity     The number of elements the deque has room for. Always
+ *                      zero or a power of two.
+ * @member element_size The size of the elements in the deque in bytes.
+ * @member data         A pointer to the allocated memory.
+ * @member alloc        The allocator of 'data' or NULL for the C library.
+ */
+struct cgs_deque {
+        size_t head;
+        size_t length;
+        size_t capacity;
+        size_t element_size;
+        char* data;
+        const struct cgs_allocator* alloc;
+};
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Deque Management Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_deque_new
+ *
+ * The deque uses the calling thread's default allocator.
+ *
+ * @param size  The size of the elements to be contained in the deque.
+ *
+ * @return      An empty deque initialized for elements of the given size.
+ */
+struct cgs_deque
+cgs_deque_new(size_t size);
+
+/**
+ * cgs_deque_from_vector
+ *
+ * Move the contents of a vector into a new deque. The vector's allocation
+ * and allocator are reused where possible and the vector is left empty.
+ *
+ * @param v     The vector to move from.
+ * @param dq    The deque to move to. Should not own any allocated memory.
+ *
+ * @return      A pointer to the deque on success, NULL on failure. On
+ *              failure the vector is left untouched.
+ */
+void*
+cgs_deque_from_vector(struct cgs_vector* v, struct cgs_deque* dq);
+
+/**
+ * cgs_deque_free
+ *
+ * Deallocates a deque.
+ *
+ * @param dq    The deque to deallocate.
+ */
+void
+cgs_deque_free(struct cgs_deque* dq);
+
+/**
+ * cgs_deque_reserve
+ *
+ * Ensure the deque has room for at least 'n' elements without further
+ * allocations. The capacity is rounded up to a power of two.
+ *
+ * @param dq    The deque.
+ * @param n     The minimum number of elements to make room for.
+ *
+ * @return      A pointer to the deque on success, NULL on failure.
+ */
+void*
+cgs_deque_reserve(struct cgs_deque* dq, size_t n);
+
+/**
+ * cgs_deque_set_allocator
+ *
+ * Attach an allocator to a deque that has not allocated yet.
+ *
+ * @param dq    The deque.
+ * @param a     The allocator or NULL for the C library.
+ *
+ * @return      A pointer to the deque on success, NULL if the deque already
+ *              owns memory.
+ */
+void*
+cgs_deque_set_allocator(struct cgs_deque* dq, const struct cgs_allocator* a);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Deque Inline Getters
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_deque_length
+ *
+ * Read the current length of a deque.
+ *
+ * @param dq    The deque.
+ *
+ * @return      The number of elements in the deque.
+ */
+inline size_t
+cgs_deque_length(const struct cgs_deque* dq)
+{
+        return dq->length;
+}
+
+/**
+ * cgs_deque_get
+ *
+ * Get a read-only pointer to an element in the deque. Index zero is the
+ * front. No bounds checking.
+ *
+ * @param dq    The deque.
+ * @param i     The index of the element to get.
+ *
+ * @return      A read-only pointer to the element.
+ */
+inline const void*
+cgs_deque_get(const struct cgs_deque* dq, size_t i)
+{
+        size_t offset = (dq->head + i) & (dq->capacity - 1);
+        return &dq->data[offset * dq->element_size];
+}
+
+/**
+ * cgs_deque_get_mut
+ *
+ * Get a mutable pointer to an element in the deque. Index zero is the
+ * front. No bounds checking.
+ *
+ * @param dq    The deque.
+ * @param i     The index of the element to get.
+ *
+ * @return      A mutable pointer to the element.
+ */
+inline void*
+cgs_deque_get_mut(struct cgs_deque* dq, size_t i)
+{
+        size_t offset = (dq->head + i) & (dq->capacity - 1);
+        return &dq->data[offset * dq->element_size];
+}
+
+/**
+ * cgs_deque_front
+ *
+ * Get a read-only pointer to the front element. No bounds checking.
+ *
+ * @param dq    The deque.
+ *
+ * @return      A read-only pointer to the front element.
+ */
+inline const void*
+cgs_deque_front(const struct cgs_deque* dq)
+{
+        return cgs_deque_get(dq, 0);
+}
+
+/**
+ * cgs_deque_back
+ *
+ * Get a read-only pointer to the back element. No bounds checking.
+ *
+ * @param dq    The deque.
+ *
+ * @return      A read-only pointer to the back element.
+ */
+inline const void*
+cgs_deque_back(const struct cgs_deque* dq)
+{
+        return cgs_deque_get(dq, dq->length - 1);
+}
+
+/**
+ * cgs_deque_clear
+ *
+ * Prepare an existing deque for re-use by setting length to zero. Does not
+ * deallocate memory.
+ *
+ * @param dq    The deque.
+ */
+inline void
+cgs_deque_clear(struct cgs_deque* dq)
+{
+        dq->head = 0;
+        dq->length = 0;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Deque Standard Operations
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_deque_push_back
+ *
+ * Add an element to the back of the deque. May invalidate existing pointers
+ * to elements.
+ *
+ * @param dq    The deque.
+ * @param src   A read-only pointer to the element to add.
+ *
+ * @return      A mutable pointer to the element added or NULL on failure.
+ */
+void*
+cgs_deque_push_back(struct cgs_deque* dq, const void* src);
+
+/**
+ * cgs_deque_push_front
+ *
+ * Add an element to the front of the deque. May invalidate existing
+ * pointers to elements.
+ *
+ * @param dq    The deque.
+ * @param src   A read-only pointer to the element to add.
+ *
+ * @return      A mutable pointer to the element added or NULL on failure.
+ */
+void*
+cgs_deque_push_front(struct cgs_deque* dq, const void* src);
+
+/**
+ * cgs_deque_pop_back
+ *
+ * Remove the back element of the deque, copying it into the provided memory
+ * location.
+ *
+ * @param dq    The deque.
+ * @param p     A pointer to the copy destination or NULL to discard it.
+ *
+ * @return      A pointer to the deque on successful pop, NULL when length
+ *              is zero.
+ */
+void*
+cgs_deque_pop_back(struct cgs_deque* dq, void* p);
+
+/**
+ * cgs_deque_pop_front
+ *
+ * Remove the front element of the deque, copying it into the provided
+ * memory location.
+ *
+ * @param dq    The deque.
+ * @param p     A pointer to the copy destination or NULL to discard it.
+ *
+ * @return      A pointer to the deque on successful pop, NULL when length
+ *              is zero.
+ */
+void*
+cgs_deque_pop_front(struct cgs_deque* dq, void* p);
+
+/**
+ * cgs_deque_push_back_n
+ *
+ * Append the contents of an array to the back of the deque with at most two
+ * copies.
+ *
+ * @param dq    The deque.
+ * @param arr   A read-only pointer to the source array.
+ * @param n     The number of elements in the source array.
+ *
+ * @return      A pointer to the deque on success, NULL on failure.
+ */
+void*
+cgs_deque_push_back_n(struct cgs_deque* dq, const void* arr, size_t n);
+
+/**
+ * cgs_deque_push_front_n
+ *
+ * Prepend the contents of an array to the front of the deque with at most
+ * two copies. The order of the array is kept: its first element becomes the
+ * front of the deque.
+ *
+ * @param dq    The deque.
+ * @param arr   A read-only pointer to the source array.
+ * @param n     The number of elements in the source array.
+ *
+ * @return      A pointer to the deque on success, NULL on failure.
+ */
+void*
+cgs_deque_push_front_n(struct cgs_deque* dq, const void* arr, size_t n);
+
+/**
+ * cgs_deque_pop_back_n
+ *
+ * Remove the last 'n' elements of the deque, copying them in order into the
+ * provided array.
+ *
+ * @param dq    The deque.
+ * @param arr   The destination array or NULL to discard the elements.
+ * @param n     The number of elements to remove.
+ *
+ * @return      A pointer to the deque on success, NULL if the deque holds
+ *              fewer than 'n' elements.
+ */
+void*
+cgs_deque_pop_back_n(struct cgs_deque* dq, void* arr, size_t n);
+
+/**
+ * cgs_deque_pop_front_n
+ *
+ * Remove the first 'n' elements of the deque, copying them in order into
+ * the provided array.
+ *
+ * @param dq    The deque.
+ * @param arr   The destination array or NULL to discard the elements.
+ * @param n     The number of elements to remove.
+ *
+ * @return      A pointer to the deque on success, NULL if the deque holds
+ *              fewer than 'n' elements.
+ */
+void*
+cgs_deque_pop_front_n(struct cgs_deque* dq, void* arr, size_t n);
+
+/**
+ * cgs_deque_foreach
+ *
+ * Traverse a read-only deque from front to back and perform an operation
+ * using each of its elements.
+ *
+ * @param dq    A read-only pointer to the deque.
+ * @param f     A function to perform taking an element, the current index,
+ *              and a pointer to userdata.
+ * @param data  The userdata.
+ */
+void
+cgs_deque_foreach(const struct cgs_deque* dq, CgsUnaryOp f, void* data);
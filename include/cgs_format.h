@@ -0,0 +1,101 @@
+/* cgs_format.h
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_format.h
+ *
+ * This file contains the public API for the libcgs number formatters.
+ *
+ * Format
+ *
+ * Integer and floating-point formatters that write into a caller-provided
+ * buffer and return the length written. They are the inverse of the
+ * cgs_parse functions. None of them depend on the current locale.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * enum cgs_format_sizes
+ *
+ * Buffer sizes, including the terminating '\0', large enough for any value
+ * of each type.
+ */
+enum cgs_format_sizes {
+        CGS_FORMAT_INT_SIZE = 21,       // "-9223372036854775808"
+        CGS_FORMAT_DOUBLE_SIZE = 25,    // "-2.2250738585072014e-308"
+};
+
+/**
+ * cgs_format_u64
+ *
+ * Write an unsigned integer in decimal. The number of digits is worked out
+ * first, then they are written from the back two at a time.
+ *
+ * @param buf   A buffer of at least CGS_FORMAT_INT_SIZE bytes.
+ * @param n     The value to write.
+ *
+ * @return      The number of characters written, not counting the '\0'.
+ */
+size_t
+cgs_format_u64(char* buf, uint64_t n);
+
+/**
+ * cgs_format_i64
+ *
+ * Write a signed integer in decimal.
+ *
+ * @param buf   A buffer of at least CGS_FORMAT_INT_SIZE bytes.
+ * @param n     The value to write.
+ *
+ * @return      The number of characters written, not counting the '\0'.
+ */
+size_t
+cgs_format_i64(char* buf, int64_t n);
+
+/**
+ * cgs_format_double
+ *
+ * Write the shortest decimal that reads back as the same double, choosing
+ * the closest one if there are several. The layout is that of printf's
+ * "%.17g": plain notation for decimal exponents from -5 to 16 and
+ * scientific otherwise, with no trailing zeros.
+ *
+ * Digits are generated with Grisu3, which proves its result shortest for
+ * all but about one in two hundred values. The rest are found by trying
+ * 15, 16 and 17 digits with snprintf.
+ *
+ * @param buf   A buffer of at least CGS_FORMAT_DOUBLE_SIZE bytes.
+ * @param d     The value to write.
+ *
+ * @return      The number of characters written, not counting the '\0'.
+ */
+size_t
+cgs_format_double(char* buf, double d);
@@ -27,6 +27,8 @@
 #include <stddef.h>
 #include "cgs_variant.h"
 #include "cgs_defs.h"
+#include "cgs_alloc.h"
+#include "cgs_pool.h"
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * Hash Table Types
@@ -54,6 +56,8 @@ struct cgs_htab_bucket;
  * @member size         The number of buckets in the table.
  * @member max_load     The highest the ratio of length to size is allowed to
  *                      get to before re-hashing.
+ * @member alloc        The allocator of the table, buckets and keys or NULL
+ *                      for the C library.
  */
 struct cgs_hashtab {
         size_t length;
@@ -65,6 +69,8 @@ struct cgs_hashtab {
 
         size_t size;
         double max_load;
+
+        const struct cgs_allocator* alloc;
 };
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
@@ -74,7 +80,8 @@ struct cgs_hashtab {
 /**
  * cgs_hashtab_new
  *
- * Create a new, empty, unallocated hash table.
+ * Create a new, empty, unallocated hash table. The table uses the calling
+ * thread's default allocator.
  *
  * Note: Hash and comparison functions are not required for this version. The
  * current implementation uses string keys so these functions are known.
@@ -117,6 +124,49 @@ cgs_hashtab_free(void* p);
 void*
 cgs_hashtab_reserve(struct cgs_hashtab* ht, size_t size);
 
+/**
+ * cgs_hashtab_set_allocator
+ *
+ * Attach an allocator to a hash table that has not allocated yet.
+ *
+ * @param ht    The hash table.
+ * @param a     The allocator or NULL for the C library.
+ *
+ * @return      A pointer to the hash table on success, NULL if the table
+ *              already owns memory.
+ */
+void*
+cgs_hashtab_set_allocator(struct cgs_hashtab* ht,
+                const struct cgs_allocator* a);
+
+/**
+ * cgs_hashtab_bucket_size
+ *
+ * Get the size of a bucket, the smallest block size of a pool that can hold
+ * the buckets of a hash table.
+ *
+ * @return      The size of a bucket in bytes.
+ */
+size_t
+cgs_hashtab_bucket_size(void);
+
+/**
+ * cgs_hashtab_use_pool
+ *
+ * Allocate the buckets of a hash table that has not allocated yet from a
+ * pool. Keys that fit in a block are pooled as well while the bucket array
+ * falls through to the C library. The pool must outlive the table.
+ *
+ * @param ht    The hash table.
+ * @param pool  A pool with blocks of at least `cgs_hashtab_bucket_size()`
+ *              bytes.
+ *
+ * @return      A pointer to the hash table on success, NULL if the table
+ *              already owns memory or the blocks of the pool are too small.
+ */
+void*
+cgs_hashtab_use_pool(struct cgs_hashtab* ht, struct cgs_pool* pool);
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * Hash Table Inline Functions
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
@@ -269,3 +319,19 @@ cgs_hashtab_iter_mut_get(struct cgs_hashtab_iter_mut* it);
  */
 size_t
 cgs_hash_str(const void* key, size_t size);
+
+/**
+ * cgs_hash_str_nocase
+ *
+ * Hash function for strings that ignores ASCII case. Pair it with
+ * `cgs_str_cmp_nocase` to look keys up without lower-casing copies of them.
+ * Keys that differ only in case hash alike, and all-lower-case keys hash as
+ * with `cgs_hash_str`.
+ *
+ * @param key   A void pointer to a string to be hashed.
+ * @param size  The number of buckets in the table to compress the hash to.
+ *
+ * @return      An unsigned value in the range of [0-size).
+ */
+size_t
+cgs_hash_str_nocase(const void* key, size_t size);
@@ -26,6 +26,7 @@
 
 #include <stddef.h>
 #include "cgs_defs.h"
+#include "cgs_alloc.h"
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * Heap Public Types
@@ -42,6 +43,7 @@
  * @member data         A pointer to the allocation.
  * @member cmp          A pointer to a 3-way comparison function to order the
  *                      elements of the heap.
+ * @member alloc        The allocator of 'data' or NULL for the C library.
  */
 struct cgs_heap {
         size_t length;
@@ -49,6 +51,7 @@ struct cgs_heap {
         size_t size;
         char* data;
         CgsCmp3Way cmp;
+        const struct cgs_allocator* alloc;
 };
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
@@ -58,7 +61,8 @@ struct cgs_heap {
 /**
  * cgs_heap_new
  *
- * Allocate and initialize a new heap.
+ * Allocate and initialize a new heap. The heap uses the calling thread's
+ * default allocator.
  *
  * @param size  The size of the elements of the heap.
  * @param cmp   A pointer to a 3-way comparison function to use to order the
@@ -80,6 +84,20 @@ cgs_heap_new(size_t size, CgsCmp3Way cmp);
 void
 cgs_heap_free(void* ph);
 
+/**
+ * cgs_heap_set_allocator
+ *
+ * Attach an allocator to a heap that has not allocated yet.
+ *
+ * @param h     The heap.
+ * @param a     The allocator or NULL for the C library.
+ *
+ * @return      A pointer to the heap on success, NULL if the heap already
+ *              owns memory.
+ */
+void*
+cgs_heap_set_allocator(struct cgs_heap* h, const struct cgs_allocator* a);
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * Heap Inline Getters, Etc..
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
@@ -24,13 +24,16 @@
  */
 #pragma once
 
+#include <stddef.h>
 #include <stdio.h>
+
 /* The cgs_string and cgs_vector headers are included rather than just forward
  * declaring the structs since usage of the io functions demands their
  * inclusion.
  */
 #include "cgs_string.h"
 #include "cgs_vector.h"
+#include "cgs_alloc.h"
 
 /**
  * cgs_io_getline
@@ -73,5 +76,214 @@ cgs_io_readline(FILE* file);
 void*
 cgs_io_readlines(FILE* file, struct cgs_vector* lines);
 
+/**
+ * cgs_io_readfile
+ *
+ * Read a whole file and append it to a string. A regular file is sized with
+ * fstat so the string grows once and the file is read in a single call;
+ * pipes, devices and files that report no size are read in growing chunks.
+ *
+ * @param fname The name of the file to read.
+ * @param buff  The string to append the contents to.
+ *
+ * @return      A pointer to the string on success or NULL if the file could
+ *              not be opened or read or the string could not grow.
+ */
 void*
 cgs_io_readfile(const char* fname, struct cgs_string* buff);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * File Mapping
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * struct cgs_io_mapping
+ *
+ * A read-only memory mapping of a whole file. The contents are not
+ * null-terminated.
+ *
+ * @member data         The start of the mapped file.
+ * @member length       The size of the file in bytes.
+ */
+struct cgs_io_mapping {
+        const char* data;
+        size_t length;
+};
+
+/**
+ * cgs_io_map
+ *
+ * Map a file read-only into memory and advise the kernel that it will be
+ * read sequentially. Pages are read in on first access rather than copied
+ * up front. An empty file gives an empty mapping with no memory behind it.
+ *
+ * The file must not be truncated while mapped; pages past the new end fault
+ * with SIGBUS.
+ *
+ * @param fname The name of the file to map.
+ * @param map   The mapping to fill in.
+ *
+ * @return      A pointer to the mapping on success or NULL if the file could
+ *              not be opened or mapped, including files that cannot be
+ *              mapped at all such as pipes.
+ */
+void*
+cgs_io_map(const char* fname, struct cgs_io_mapping* map);
+
+/**
+ * cgs_io_unmap
+ *
+ * Release a mapping made with `cgs_io_map`. Strsubs into it are invalid
+ * afterwards.
+ *
+ * @param map   The mapping.
+ */
+void
+cgs_io_unmap(struct cgs_io_mapping* map);
+
+/**
+ * cgs_io_mapping_strsub
+ *
+ * @param map   The mapping.
+ *
+ * @return      A strsub over the whole mapped file.
+ */
+inline struct cgs_strsub
+cgs_io_mapping_strsub(const struct cgs_io_mapping* map)
+{
+        return cgs_strsub_new(map->data, map->length);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Buffered Reader
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+enum cgs_reader_defaults {
+        CGS_READER_BUFFER_SIZE = 128 * 1024,
+};
+
+/**
+ * struct cgs_reader
+ *
+ * A line reader with its own read buffer. Lines are handed out as strsubs
+ * pointing into the buffer, so they are only copied when a line runs past
+ * the end of the buffered data and has to be moved to the front before the
+ * next read. Reading is done with read(2) on a file descriptor or fread on
+ * a stream.
+ *
+ * @member buf          The read buffer or NULL before the first read.
+ * @member cap          The size of the read buffer.
+ * @member pos          The start of the unread data.
+ * @member end          The end of the unread data.
+ * @member fd           The file descriptor to read from or -1.
+ * @member file         The stream to read from or NULL.
+ * @member eof          Set once the source is exhausted.
+ * @member err          The errno of a failed read or 0.
+ * @member alloc        The allocator of the read buffer.
+ */
+struct cgs_reader {
+        char* buf;
+        size_t cap;
+        size_t pos;
+        size_t end;
+        int fd;
+        FILE* file;
+        int eof;
+        int err;
+        const struct cgs_allocator* alloc;
+};
+
+/**
+ * cgs_reader_new_fd
+ *
+ * Create a reader on a file descriptor. The buffer is allocated on the first
+ * read with the calling thread's default allocator.
+ *
+ * @param fd    The file descriptor. It is not closed by the reader.
+ *
+ * @return      A reader.
+ */
+struct cgs_reader
+cgs_reader_new_fd(int fd);
+
+/**
+ * cgs_reader_new_file
+ *
+ * Create a reader on a stream. Data already in the stream's own buffer is
+ * read first, but the stream should not otherwise be read while the reader
+ * is in use.
+ *
+ * @param file  The stream. It is not closed by the reader.
+ *
+ * @return      A reader.
+ */
+struct cgs_reader
+cgs_reader_new_file(FILE* file);
+
+/**
+ * cgs_reader_free
+ *
+ * Deallocate a reader's buffer. The source is left open.
+ *
+ * @param r     The reader.
+ */
+void
+cgs_reader_free(struct cgs_reader* r);
+
+/**
+ * cgs_reader_set_allocator
+ *
+ * Attach an allocator to a reader that has not read yet.
+ *
+ * @param r     The reader.
+ * @param a     The allocator or NULL for the C library.
+ *
+ * @return      A pointer back to the reader on success, NULL if the reader
+ *              already owns a buffer.
+ */
+void*
+cgs_reader_set_allocator(struct cgs_reader* r, const struct cgs_allocator* a);
+
+/**
+ * cgs_reader_getdelim
+ *
+ * Read up to the next delimiter. The delimiter is consumed but not included
+ * in the result. A last line with no delimiter is returned if it is not
+ * empty.
+ *
+ * @param r     The reader.
+ * @param delim The delimiter byte.
+ * @param line  A strsub to point at the line. It is valid until the next
+ *              call on the reader.
+ *
+ * @return      A pointer back to the reader on success, NULL at the end of
+ *              the input or on failure. `cgs_reader_error` tells the two
+ *              apart.
+ */
+void*
+cgs_reader_getdelim(struct cgs_reader* r, int delim, struct cgs_strsub* line);
+
+/**
+ * cgs_reader_getline
+ *
+ * Read up to the next newline. See `cgs_reader_getdelim`.
+ */
+inline void*
+cgs_reader_getline(struct cgs_reader* r, struct cgs_strsub* line)
+{
+        return cgs_reader_getdelim(r, '\n', line);
+}
+
+/**
+ * cgs_reader_error
+ *
+ * @param r     The reader.
+ *
+ * @return      The errno of a failed read, ENOMEM if the buffer could not
+ *              grow, or 0 if there was no error.
+ */
+inline int
+cgs_reader_error(const struct cgs_reader* r)
+{
+        return r->err;
+}
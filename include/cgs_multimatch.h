@@ -0,0 +1,243 @@
+/* cgs_multimatch.h
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_multimatch.h
+ *
+ * This file contains the public API for the libcgs multi-pattern matcher.
+ *
+ * Multimatch
+ *
+ * A set of byte patterns compiled into an Aho-Corasick automaton, which
+ * finds every occurrence of every pattern in a single pass over the text,
+ * independent of the number of patterns.
+ *
+ * Patterns are added first, then the set is compiled. Bytes that occur in
+ * no pattern share one column of the transition table, so the table has one
+ * row per trie node and one column per distinct pattern byte plus one.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cgs_alloc.h"
+#include "cgs_defs.h"
+#include "cgs_string.h"
+#include "cgs_vector.h"
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Multimatch Types
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * struct cgs_multimatch_hit
+ *
+ * A single match.
+ *
+ * @member id           The pattern index, in the order patterns were added.
+ * @member offset       The position of the first byte of the match.
+ */
+struct cgs_multimatch_hit {
+        size_t id;
+        size_t offset;
+};
+
+/**
+ * struct cgs_multimatch
+ *
+ * A pattern set and its automaton.
+ *
+ * @member bytes        The bytes of all patterns, back to back.
+ * @member lengths      The length of each pattern.
+ * @member states       The number of automaton states or 0 if the set has
+ *                      not been compiled since the last pattern was added.
+ * @member rows         The number of states the tables have room for.
+ * @member classes      The number of columns of the transition table.
+ * @member cls          The column of each byte value.
+ * @member delta        The transition table, 'states' rows of 'classes'.
+ * @member out          One plus the first pattern ending at each state, or 0.
+ * @member dict         The nearest proper suffix state with output, or 0.
+ * @member next         One plus the next pattern ending at the same state as
+ *                      each pattern, or 0.
+ * @member alloc        The allocator of the tables or NULL for the C library.
+ */
+struct cgs_multimatch {
+        struct cgs_vector bytes;
+        struct cgs_vector lengths;
+
+        size_t states;
+        size_t rows;
+        size_t classes;
+        unsigned char cls[256];
+        uint32_t* delta;
+        uint32_t* out;
+        uint32_t* dict;
+        uint32_t* next;
+
+        const struct cgs_allocator* alloc;
+};
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Multimatch Management Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_multimatch_new
+ *
+ * Create an empty pattern set. The set uses the calling thread's default
+ * allocator.
+ *
+ * @return      An empty pattern set.
+ */
+struct cgs_multimatch
+cgs_multimatch_new(void);
+
+/**
+ * cgs_multimatch_free
+ *
+ * Deallocate a pattern set and its automaton.
+ *
+ * @param mm    The pattern set.
+ */
+void
+cgs_multimatch_free(struct cgs_multimatch* mm);
+
+/**
+ * cgs_multimatch_add
+ *
+ * Add a pattern to the set. The pattern's id is the number of patterns
+ * added before it. The set must be compiled again before scanning.
+ *
+ * @param mm    The pattern set.
+ * @param pat   The pattern. Must not be empty.
+ *
+ * @return      A pointer to the pattern set on success, NULL on failure.
+ */
+void*
+cgs_multimatch_add(struct cgs_multimatch* mm, const struct cgs_strsub* pat);
+
+/**
+ * cgs_multimatch_compile
+ *
+ * Build the automaton of the pattern set.
+ *
+ * @param mm    The pattern set.
+ *
+ * @return      A pointer to the pattern set on success, NULL on failure.
+ */
+void*
+cgs_multimatch_compile(struct cgs_multimatch* mm);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Multimatch Inline Getters
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_multimatch_count
+ *
+ * Get the number of patterns in the set.
+ *
+ * @param mm    The pattern set.
+ *
+ * @return      The number of patterns.
+ */
+inline size_t
+cgs_multimatch_count(const struct cgs_multimatch* mm)
+{
+        return cgs_vector_length(&mm->lengths);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Multimatch Standard Operations
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_multimatch_scan
+ *
+ * Report every occurrence of every pattern in a text, including overlapping
+ * ones, in order of their end position. Matches ending at the same position
+ * are reported longest first.
+ *
+ * @param mm    A compiled pattern set.
+ * @param text  The text to scan.
+ * @param f     A function taking a read-only pointer to a
+ *              `struct cgs_multimatch_hit`, the match number, and a pointer
+ *              to userdata.
+ * @param data  The userdata.
+ *
+ * @return      The number of matches.
+ */
+size_t
+cgs_multimatch_scan(const struct cgs_multimatch* mm,
+                const struct cgs_strsub* text, CgsUnaryOp f, void* data);
+
+/**
+ * cgs_multimatch_find_all
+ *
+ * Collect every occurrence of every pattern in a text, in the order
+ * `cgs_multimatch_scan` reports them.
+ *
+ * @param mm    A compiled pattern set.
+ * @param text  The text to scan.
+ * @param vec   A vector of `struct cgs_multimatch_hit` to push the matches
+ *              onto.
+ *
+ * @return      A pointer back to the vector on success, NULL on failure.
+ */
+void*
+cgs_multimatch_find_all(const struct cgs_multimatch* mm,
+                const struct cgs_strsub* text, struct cgs_vector* vec);
+
+/**
+ * cgs_multimatch_scan_string
+ *
+ * Same as `cgs_multimatch_scan` for a whole string.
+ */
+inline size_t
+cgs_multimatch_scan_string(const struct cgs_multimatch* mm,
+                const struct cgs_string* s, CgsUnaryOp f, void* data)
+{
+        struct cgs_strsub ss = cgs_strsub_new(cgs_string_data(s),
+                        cgs_string_length(s));
+        return cgs_multimatch_scan(mm, &ss, f, data);
+}
+
+/**
+ * cgs_multimatch_find_all_string
+ *
+ * Same as `cgs_multimatch_find_all` for a whole string.
+ */
+inline void*
+cgs_multimatch_find_all_string(const struct cgs_multimatch* mm,
+                const struct cgs_string* s, struct cgs_vector* vec)
+{
+        struct cgs_strsub ss = cgs_strsub_new(cgs_string_data(s),
+                        cgs_string_length(s));
+        return cgs_multimatch_find_all(mm, &ss, vec);
+}
@@ -0,0 +1,134 @@
+/* cgs_parallel.h
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_parallel.h
+ *
+ * This file contains the public API for the libcgs data-parallel helpers.
+ *
+ * Parallel For
+ *
+ * An index range is cut into fixed-size chunks that are handed out to a
+ * team of POSIX threads through a shared atomic counter, so fast workers
+ * simply take more chunks. The calling thread is part of the team. Chunks
+ * should be large enough that two workers rarely write to the same cache
+ * line; `cgs_parallel_chunk` picks such a size for a given element size.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#pragma once
+
+#include <stddef.h>
+#include "cgs_defs.h"
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Parallel Types
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * Parallel Constants
+ *
+ * CGS_PARALLEL_CACHE_LINE is the assumed size of a cache line in bytes.
+ * CGS_PARALLEL_CHUNKS_PER_THREAD is the number of chunks each worker gets on
+ * average when the chunk size is chosen automatically.
+ */
+enum cgs_parallel_constants {
+        CGS_PARALLEL_CACHE_LINE = 64,
+        CGS_PARALLEL_CHUNKS_PER_THREAD = 4,
+};
+
+/**
+ * struct cgs_parallel_opts
+ *
+ * Tuning for the parallel operations. A NULL options pointer or zeroed
+ * members select the defaults.
+ *
+ * @member threads      The number of workers including the calling thread.
+ *                      Zero uses the number of online processors.
+ * @member chunk        The number of elements per chunk. Zero picks a size
+ *                      from the length, element size and thread count.
+ * @member ordered      For reductions, combine one partial result per chunk
+ *                      in index order. With a fixed 'chunk' the result is
+ *                      then independent of the thread count and scheduling,
+ *                      which matters for floating-point sums.
+ */
+struct cgs_parallel_opts {
+        size_t threads;
+        size_t chunk;
+        int ordered;
+};
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Parallel Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_parallel_threads
+ *
+ * Resolve the number of workers to use.
+ *
+ * @param opts  The options or NULL.
+ *
+ * @return      The requested thread count, or the number of online
+ *              processors if none was requested. Always at least 1.
+ */
+size_t
+cgs_parallel_threads(const struct cgs_parallel_opts* opts);
+
+/**
+ * cgs_parallel_chunk
+ *
+ * Resolve the chunk size to use for a range. An automatic chunk is rounded
+ * up to a whole number of cache lines worth of elements.
+ *
+ * @param n             The length of the range.
+ * @param size          The size of the elements in bytes.
+ * @param threads       The number of workers.
+ * @param opts          The options or NULL.
+ *
+ * @return      The number of elements per chunk. Always at least 1.
+ */
+size_t
+cgs_parallel_chunk(size_t n, size_t size, size_t threads,
+                const struct cgs_parallel_opts* opts);
+
+/**
+ * cgs_parallel_for
+ *
+ * Run 'f' over the range [0:n) in chunks of 'chunk' indices using up to
+ * 'threads' workers. Returns once every chunk has run. If threads cannot be
+ * started the remaining workers, at minimum the caller, do all the work.
+ *
+ * @param n             The length of the range.
+ * @param chunk         The number of indices per chunk.
+ * @param threads       The maximum number of workers.
+ * @param f             The work function. Must be safe to call
+ *                      concurrently.
+ * @param data          The userdata passed to 'f'.
+ */
+void
+cgs_parallel_for(size_t n, size_t chunk, size_t threads, CgsRangeOp f,
+                void* data);
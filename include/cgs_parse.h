@@ -0,0 +1,204 @@
+/* cgs_parse.h
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_parse.h
+ *
+ * This file contains the public API for the libcgs number parsers.
+ *
+ * Parse
+ *
+ * Integer and floating-point parsers that read a pointer and length rather
+ * than a NUL-terminated string, so they can be run directly on sub-strings
+ * of a larger buffer. Each parser skips leading ASCII whitespace, reads as
+ * much of the input as forms a number and returns a pointer to the first
+ * byte it did not use. None of them depend on the current locale.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cgs_string.h"
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Integer Parsing
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_parse_u64
+ *
+ * Parse an unsigned 64-bit integer. Decimal digits are read eight at a time
+ * where possible.
+ *
+ * @param s     The text to parse.
+ * @param n     The length of the text.
+ * @param base  10, 16 or 0. Base 16 accepts an optional "0x" prefix and
+ *              base 0 reads hexadecimal after a "0x" prefix and decimal
+ *              otherwise.
+ * @param out   Receives the value on success.
+ *
+ * @return      A pointer past the last byte of the number on success. NULL
+ *              if there is no number, the value does not fit, it has a
+ *              minus sign or the base is not supported.
+ */
+const char*
+cgs_parse_u64(const char* s, size_t n, int base, uint64_t* out);
+
+/**
+ * cgs_parse_i64
+ *
+ * Parse a signed 64-bit integer with an optional sign.
+ *
+ * @param s     The text to parse.
+ * @param n     The length of the text.
+ * @param base  10, 16 or 0, as for cgs_parse_u64.
+ * @param out   Receives the value on success.
+ *
+ * @return      A pointer past the last byte of the number on success. NULL
+ *              if there is no number or the value does not fit.
+ */
+const char*
+cgs_parse_i64(const char* s, size_t n, int base, int64_t* out);
+
+/**
+ * cgs_parse_i32
+ *
+ * Parse a signed 32-bit integer with an optional sign.
+ *
+ * @param s     The text to parse.
+ * @param n     The length of the text.
+ * @param base  10, 16 or 0, as for cgs_parse_u64.
+ * @param out   Receives the value on success.
+ *
+ * @return      A pointer past the last byte of the number on success. NULL
+ *              if there is no number or the value does not fit.
+ */
+const char*
+cgs_parse_i32(const char* s, size_t n, int base, int32_t* out);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Floating-Point Parsing
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_parse_double
+ *
+ * Parse a decimal floating-point number of the form
+ * [sign] digits [. digits] [(e|E) [sign] digits], where either side of the
+ * point may be empty but not both. The result is correctly rounded.
+ *
+ * Numbers with at most 19 significant digits whose value and power of ten
+ * are exact doubles are computed with a single multiply or divide. Others
+ * fall back to strtod. Values out of range give an infinity or zero, as
+ * strtod does.
+ *
+ * @param s     The text to parse.
+ * @param n     The length of the text.
+ * @param out   Receives the value on success.
+ *
+ * @return      A pointer past the last byte of the number on success, NULL
+ *              if there is no number.
+ */
+const char*
+cgs_parse_double(const char* s, size_t n, double* out);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Strsub Parsing
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_strsub_parse_u64
+ *
+ * Parse an unsigned 64-bit integer from a sub-string.
+ *
+ * @param ss    The sub-string to parse.
+ * @param base  10, 16 or 0, as for cgs_parse_u64.
+ * @param out   Receives the value on success.
+ *
+ * @return      A pointer past the last byte of the number on success, NULL
+ *              on failure.
+ */
+inline const char*
+cgs_strsub_parse_u64(const struct cgs_strsub* ss, int base, uint64_t* out)
+{
+        return cgs_parse_u64(ss->data, ss->length, base, out);
+}
+
+/**
+ * cgs_strsub_parse_i64
+ *
+ * Parse a signed 64-bit integer from a sub-string.
+ *
+ * @param ss    The sub-string to parse.
+ * @param base  10, 16 or 0, as for cgs_parse_u64.
+ * @param out   Receives the value on success.
+ *
+ * @return      A pointer past the last byte of the number on success, NULL
+ *              on failure.
+ */
+inline const char*
+cgs_strsub_parse_i64(const struct cgs_strsub* ss, int base, int64_t* out)
+{
+        return cgs_parse_i64(ss->data, ss->length, base, out);
+}
+
+/**
+ * cgs_strsub_parse_i32
+ *
+ * Parse a signed 32-bit integer from a sub-string.
+ *
+ * @param ss    The sub-string to parse.
+ * @param base  10, 16 or 0, as for cgs_parse_u64.
+ * @param out   Receives the value on success.
+ *
+ * @return      A pointer past the last byte of the number on success, NULL
+ *              on failure.
+ */
+inline const char*
+cgs_strsub_parse_i32(const struct cgs_strsub* ss, int base, int32_t* out)
+{
+        return cgs_parse_i32(ss->data, ss->length, base, out);
+}
+
+/**
+ * cgs_strsub_parse_double
+ *
+ * Parse a floating-point number from a sub-string.
+ *
+ * @param ss    The sub-string to parse.
+ * @param out   Receives the value on success.
+ *
+ * @return      A pointer past the last byte of the number on success, NULL
+ *              on failure.
+ */
+inline const char*
+cgs_strsub_parse_double(const struct cgs_strsub* ss, double* out)
+{
+        return cgs_parse_double(ss->data, ss->length, out);
+}
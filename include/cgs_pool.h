@@ -0,0 +1,172 @@
+/* cgs_pool.h
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_pool.h
+ *
+ * This file contains the public API for the libcgs implementation of a
+ * fixed-size object pool.
+ *
+ * Pool
+ *
+ * Blocks of a single size are carved out of cache-line-aligned slabs and
+ * recycled through an intrusive free list, so allocating and releasing a
+ * block is a pointer swap. Blocks from the same slab are handed out in
+ * address order which keeps nodes created together close in memory.
+ *
+ * Trees and hash tables opt in with their `*_use_pool` functions. Through
+ * the allocator interface, requests larger than a block fall through to
+ * the C library so a table's bucket array can live beside pooled buckets.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#pragma once
+
+#include <stddef.h>
+#include "cgs_alloc.h"
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Pool Types
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * Pool Constants
+ *
+ * CGS_POOL_ALIGN is the granularity of block sizes.
+ * CGS_POOL_SLAB_ALIGN is the alignment of each slab, a cache line.
+ * CGS_POOL_SLAB_BLOCKS is the default number of blocks per slab.
+ */
+enum cgs_pool_constants {
+        CGS_POOL_ALIGN = 16,
+        CGS_POOL_SLAB_ALIGN = 64,
+        CGS_POOL_SLAB_BLOCKS = 256,
+};
+
+/**
+ * struct cgs_pool
+ *
+ * A fixed-size block allocator. Must not be moved once
+ * `cgs_pool_allocator` has been called on it.
+ *
+ * @member block_size   The size of each block in bytes.
+ * @member slab_blocks  The number of blocks allocated per slab.
+ * @member free_list    The first free block.
+ * @member slabs        The most recent slab. Each slab links to the one
+ *                      before it.
+ * @member in_use       The number of blocks currently handed out.
+ * @member allocator    The allocator interface of this pool.
+ */
+struct cgs_pool {
+        size_t block_size;
+        size_t slab_blocks;
+        void* free_list;
+        void* slabs;
+        size_t in_use;
+        struct cgs_allocator allocator;
+};
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Pool Management Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_pool_new
+ *
+ * Create an empty pool. No memory is allocated until the first block is
+ * requested.
+ *
+ * @param size          The size of the objects to pool. Rounded up to a
+ *                      multiple of CGS_POOL_ALIGN.
+ * @param slab_blocks   The number of blocks per slab or zero for
+ *                      CGS_POOL_SLAB_BLOCKS.
+ *
+ * @return      An empty pool.
+ */
+struct cgs_pool
+cgs_pool_new(size_t size, size_t slab_blocks);
+
+/**
+ * cgs_pool_free
+ *
+ * Release every slab of a pool. All blocks become invalid.
+ *
+ * @param pool  The pool.
+ */
+void
+cgs_pool_free(struct cgs_pool* pool);
+
+/**
+ * cgs_pool_reserve
+ *
+ * Allocate slabs until at least 'n' blocks are free.
+ *
+ * @param pool  The pool.
+ * @param n     The number of blocks to have ready.
+ *
+ * @return      A pointer to the pool on success, NULL on failure.
+ */
+void*
+cgs_pool_reserve(struct cgs_pool* pool, size_t n);
+
+/**
+ * cgs_pool_allocator
+ *
+ * Get the allocator interface of a pool to attach to a container. The pool
+ * must outlive the container and must not be moved.
+ *
+ * @param pool  The pool.
+ *
+ * @return      A pointer to the allocator.
+ */
+const struct cgs_allocator*
+cgs_pool_allocator(struct cgs_pool* pool);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Pool Allocation Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_pool_alloc
+ *
+ * Take a block from the pool.
+ *
+ * @param pool  The pool.
+ *
+ * @return      A pointer to a block or NULL on failure.
+ */
+void*
+cgs_pool_alloc(struct cgs_pool* pool);
+
+/**
+ * cgs_pool_release
+ *
+ * Return a block to the pool.
+ *
+ * @param pool  The pool.
+ * @param p     A block from this pool or NULL.
+ */
+void
+cgs_pool_release(struct cgs_pool* pool, void* p);
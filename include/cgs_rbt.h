@@ -53,6 +53,8 @@
 
 #include "cgs_variant.h"
 #include "cgs_defs.h"
+#include "cgs_alloc.h"
+#include "cgs_pool.h"
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * RBT Types
@@ -75,12 +77,14 @@ struct cgs_rbt_node;
  * @member cmp          A comparison function to order the tree with.
  * @member ff           An optional freeing function for the elements of
  *                      the tree or NULL if they are trivially deallocated.
+ * @member alloc        The allocator of the nodes or NULL for the C library.
  */
 struct cgs_rbt {
         struct cgs_rbt_node* root;
         size_t length;
         CgsCmp3Way cmp;
         CgsFreeFunc ff;
+        const struct cgs_allocator* alloc;
 };
 
 
@@ -91,7 +95,8 @@ struct cgs_rbt {
 /**
  * cgs_rbt_new
  *
- * Create a new red-black tree.
+ * Create a new red-black tree. The tree uses the calling thread's default
+ * allocator.
  *
  * @param cmp   The comparison function to order the tree with.
  * @param ff    An optional freeing function for the elements of the tree or
@@ -112,6 +117,46 @@ cgs_rbt_new(CgsCmp3Way cmp, CgsFreeFunc ff);
 void
 cgs_rbt_free(struct cgs_rbt* tree);
 
+/**
+ * cgs_rbt_set_allocator
+ *
+ * Attach an allocator to an empty tree.
+ *
+ * @param tree  The tree.
+ * @param a     The allocator or NULL for the C library.
+ *
+ * @return      A pointer to the tree on success, NULL if the tree already
+ *              has nodes.
+ */
+void*
+cgs_rbt_set_allocator(struct cgs_rbt* tree, const struct cgs_allocator* a);
+
+/**
+ * cgs_rbt_node_size
+ *
+ * Get the size of a tree node, the smallest block size of a pool that can
+ * hold the nodes of a red-black tree.
+ *
+ * @return      The size of a node in bytes.
+ */
+size_t
+cgs_rbt_node_size(void);
+
+/**
+ * cgs_rbt_use_pool
+ *
+ * Allocate the nodes of an empty tree from a pool. The pool must outlive
+ * the tree and may be shared by several trees.
+ *
+ * @param tree  The tree.
+ * @param pool  A pool with blocks of at least `cgs_rbt_node_size()` bytes.
+ *
+ * @return      A pointer to the tree on success, NULL if the tree already
+ *              has nodes or the blocks of the pool are too small.
+ */
+void*
+cgs_rbt_use_pool(struct cgs_rbt* tree, struct cgs_pool* pool);
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * RBT Inline Getters
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
@@ -189,3 +234,16 @@ cgs_rbt_min(const struct cgs_rbt* tree);
 const void*
 cgs_rbt_max(const struct cgs_rbt* tree);
 
+/**
+ * cgs_rbt_foreach
+ *
+ * Traverse a read-only tree in order and perform an operation using each of
+ * its elements.
+ *
+ * @param tree  A read-only pointer to the tree.
+ * @param f     A function to perform taking an element, its in-order index,
+ *              and a pointer to userdata.
+ * @param data  The userdata.
+ */
+void
+cgs_rbt_foreach(const struct cgs_rbt* tree, CgsUnaryOp f, void* data);
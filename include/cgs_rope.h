@@ -0,0 +1,266 @@
+/* cgs_rope.h
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_rope.h
+ *
+ * This file contains the public API for the libcgs rope.
+ *
+ * Rope
+ *
+ * A string for large texts that are edited in place. The text is held in
+ * fixed-size chunks kept in order by a balanced tree, so inserting, erasing
+ * or replacing anywhere costs O(log n) plus the length of the edit, rather
+ * than a shift of everything after it.
+ *
+ * Chunks are treap nodes keyed implicitly by position. Small edits that
+ * fit in the chunk they land in are made inside it with no allocation.
+ * Neighbouring chunks are coalesced whenever their text fits in one, so
+ * chunks stay more than half full on average however the text is edited.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cgs_alloc.h"
+#include "cgs_defs.h"
+#include "cgs_string.h"
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Rope Types
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+struct cgs_rope_node;
+
+/**
+ * struct cgs_rope
+ *
+ * @member root         The root of the chunk tree or NULL if empty.
+ * @member length       The number of bytes of text.
+ * @member seed         The state of the priority generator.
+ * @member alloc        The allocator used for the chunks.
+ */
+struct cgs_rope {
+        struct cgs_rope_node* root;
+        size_t length;
+        uint32_t seed;
+        const struct cgs_allocator* alloc;
+};
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Rope Management Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_rope_new
+ *
+ * Create a new empty rope.
+ *
+ * @return      An empty rope using the default allocator.
+ */
+struct cgs_rope
+cgs_rope_new(void);
+
+/**
+ * cgs_rope_free
+ *
+ * Deallocate a rope.
+ *
+ * @param rope  The rope.
+ */
+void
+cgs_rope_free(struct cgs_rope* rope);
+
+/**
+ * cgs_rope_set_allocator
+ *
+ * Attach an allocator to a rope that has not allocated yet.
+ *
+ * @param rope  The rope.
+ * @param a     The allocator or NULL for the C library.
+ *
+ * @return      A pointer back to the rope on success, NULL if the rope
+ *              already owns memory.
+ */
+void*
+cgs_rope_set_allocator(struct cgs_rope* rope, const struct cgs_allocator* a);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Rope Inline Getters
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_rope_length
+ *
+ * @param rope  The rope.
+ *
+ * @return      The number of bytes of text.
+ */
+inline size_t
+cgs_rope_length(const struct cgs_rope* rope)
+{
+        return rope->length;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Rope Editing
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_rope_insert
+ *
+ * Insert text at a position.
+ *
+ * @param rope  The rope.
+ * @param pos   The position to insert at, up to the length of the rope.
+ * @param s     The text to insert.
+ * @param n     The length of the text.
+ *
+ * @return      A pointer back to the rope on success, NULL if 'pos' is out
+ *              of range or on allocation failure, in which case the rope
+ *              is unchanged.
+ */
+void*
+cgs_rope_insert(struct cgs_rope* rope, size_t pos, const char* s, size_t n);
+
+/**
+ * cgs_rope_append
+ *
+ * Add text to the end of a rope.
+ *
+ * @param rope  The rope.
+ * @param s     The text to append.
+ * @param n     The length of the text.
+ *
+ * @return      A pointer back to the rope on success, NULL on failure.
+ */
+inline void*
+cgs_rope_append(struct cgs_rope* rope, const char* s, size_t n)
+{
+        return cgs_rope_insert(rope, rope->length, s, n);
+}
+
+/**
+ * cgs_rope_erase
+ *
+ * Remove a range of text.
+ *
+ * @param rope  The rope.
+ * @param pos   The start of the range.
+ * @param count The length of the range. Counts past the end of the rope
+ *              are cut short.
+ *
+ * @return      A pointer back to the rope on success, NULL if 'pos' is out
+ *              of range or on allocation failure, in which case the rope
+ *              is unchanged.
+ */
+void*
+cgs_rope_erase(struct cgs_rope* rope, size_t pos, size_t count);
+
+/**
+ * cgs_rope_replace
+ *
+ * Replace a range of text.
+ *
+ * @param rope  The rope.
+ * @param pos   The start of the range.
+ * @param count The length of the range, cut short at the end of the rope.
+ * @param s     The replacement text.
+ * @param n     The length of the replacement text.
+ *
+ * @return      A pointer back to the rope on success, NULL if 'pos' is out
+ *              of range or on allocation failure, in which case the rope
+ *              is unchanged.
+ */
+void*
+cgs_rope_replace(struct cgs_rope* rope, size_t pos, size_t count,
+                const char* s, size_t n);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Rope Access
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_rope_get
+ *
+ * Get the character at a position.
+ *
+ * @param rope  The rope.
+ * @param pos   The position, less than the length of the rope.
+ *
+ * @return      The character.
+ */
+char
+cgs_rope_get(const struct cgs_rope* rope, size_t pos);
+
+/**
+ * cgs_rope_substr
+ *
+ * Copy a range of text into a string, replacing its contents.
+ *
+ * @param rope  The rope.
+ * @param pos   The start of the range.
+ * @param count The length of the range, cut short at the end of the rope.
+ * @param dst   The string to copy into.
+ *
+ * @return      A pointer back to 'dst' on success, NULL if 'pos' is out of
+ *              range or on allocation failure.
+ */
+void*
+cgs_rope_substr(const struct cgs_rope* rope, size_t pos, size_t count,
+                struct cgs_string* dst);
+
+/**
+ * cgs_rope_to_string
+ *
+ * Copy the whole text into a string, replacing its contents.
+ *
+ * @param rope  The rope.
+ * @param dst   The string to copy into.
+ *
+ * @return      A pointer back to 'dst' on success, NULL on failure.
+ */
+inline void*
+cgs_rope_to_string(const struct cgs_rope* rope, struct cgs_string* dst)
+{
+        return cgs_rope_substr(rope, 0, rope->length, dst);
+}
+
+/**
+ * cgs_rope_foreach
+ *
+ * Call a function on each chunk of text in order. The element passed is a
+ * `const struct cgs_strsub*` that is only valid for the call.
+ *
+ * @param rope  The rope.
+ * @param f     The function, called with the chunk, its index and 'data'.
+ * @param data  User data passed through to 'f'.
+ */
+void
+cgs_rope_foreach(const struct cgs_rope* rope, CgsUnaryOp f, void* data);
@@ -0,0 +1,296 @@
+/* cgs_segvec.h
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_segvec.h
+ *
+ * This file contains the public API for the libcgs implementation of a
+ * segmented vector.
+ *
+ * Segmented Vector
+ *
+ * A dynamic array made of geometrically growing blocks. The first block
+ * holds CGS_SEGVEC_FIRST_BLOCK elements and each following block holds twice
+ * as many as the one before it. Blocks are never reallocated so elements
+ * never move: pointers into a segmented vector stay valid until it is freed.
+ * Indexed access is O(1).
+ *
+ * Space may be claimed from several threads at once with `cgs_segvec_claim`.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#pragma once
+
+#include <stddef.h>
+#include "cgs_defs.h"
+#include "cgs_alloc.h"
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Segmented Vector Types
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+enum cgs_segvec_constants {
+        CGS_SEGVEC_FIRST_SHIFT = 4,
+        CGS_SEGVEC_FIRST_BLOCK = 1 << CGS_SEGVEC_FIRST_SHIFT,
+        CGS_SEGVEC_MAX_BLOCKS = 48,
+};
+
+/**
+ * struct cgs_segvec
+ *
+ * A generic, dynamic array with stable element addresses.
+ *
+ * @member length       The number of elements in the vector.
+ * @member element_size The size of the elements in the vector in bytes.
+ * @member blocks       The block allocations. Block 'b' holds
+ *                      CGS_SEGVEC_FIRST_BLOCK << b elements.
+ * @member alloc        The allocator of the blocks or NULL for the C
+ *                      library. Must be thread-safe if claims are made
+ *                      from several threads.
+ */
+struct cgs_segvec {
+        size_t length;
+        size_t element_size;
+        char* blocks[CGS_SEGVEC_MAX_BLOCKS];
+        const struct cgs_allocator* alloc;
+};
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Segmented Vector Management Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_segvec_new
+ *
+ * The vector uses the calling thread's default allocator.
+ *
+ * @param size  The size of the elements to be contained in the vector.
+ *
+ * @return      An empty segmented vector initialized for elements of the
+ *              given size.
+ */
+struct cgs_segvec
+cgs_segvec_new(size_t size);
+
+/**
+ * cgs_segvec_free
+ *
+ * Deallocates the blocks of a segmented vector.
+ *
+ * @param sv    The segmented vector to deallocate.
+ */
+void
+cgs_segvec_free(struct cgs_segvec* sv);
+
+/**
+ * cgs_segvec_reserve
+ *
+ * Allocate enough blocks to hold at least 'n' elements.
+ *
+ * @param sv    The segmented vector.
+ * @param n     The minimum number of elements to make room for.
+ *
+ * @return      A pointer to the segmented vector on success, NULL on failure.
+ */
+void*
+cgs_segvec_reserve(struct cgs_segvec* sv, size_t n);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Segmented Vector Inline Getters
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_segvec_length
+ *
+ * Read the current length of a segmented vector.
+ *
+ * @param sv    The segmented vector.
+ *
+ * @return      The number of elements in the vector.
+ */
+inline size_t
+cgs_segvec_length(const struct cgs_segvec* sv)
+{
+        return sv->length;
+}
+
+/**
+ * cgs_segvec_block_of
+ *
+ * Get the index of the block that holds a given element index.
+ *
+ * @param i     The element index.
+ *
+ * @return      The block index.
+ */
+inline size_t
+cgs_segvec_block_of(size_t i)
+{
+        size_t j = (i >> CGS_SEGVEC_FIRST_SHIFT) + 1;
+        size_t b = 0;
+#if defined(__GNUC__)
+        b = sizeof(unsigned long long) * 8 - 1
+                - __builtin_clzll((unsigned long long)j);
+#else
+        while (j >>= 1)
+                ++b;
+#endif
+        return b;
+}
+
+/**
+ * cgs_segvec_block_start
+ *
+ * Get the index of the first element held by a block.
+ *
+ * @param b     The block index.
+ *
+ * @return      The element index at the start of the block.
+ */
+inline size_t
+cgs_segvec_block_start(size_t b)
+{
+        return ((size_t)CGS_SEGVEC_FIRST_BLOCK << b) - CGS_SEGVEC_FIRST_BLOCK;
+}
+
+/**
+ * cgs_segvec_get
+ *
+ * Get a read-only pointer to an element in the vector. No bounds checking.
+ *
+ * @param sv    The segmented vector.
+ * @param i     The index of the element to get.
+ *
+ * @return      A read-only pointer to the element.
+ */
+inline const void*
+cgs_segvec_get(const struct cgs_segvec* sv, size_t i)
+{
+        size_t b = cgs_segvec_block_of(i);
+        size_t offset = i - cgs_segvec_block_start(b);
+        return &sv->blocks[b][offset * sv->element_size];
+}
+
+/**
+ * cgs_segvec_get_mut
+ *
+ * Get a mutable pointer to an element in the vector. No bounds checking.
+ *
+ * @param sv    The segmented vector.
+ * @param i     The index of the element to get.
+ *
+ * @return      A mutable pointer to the element.
+ */
+inline void*
+cgs_segvec_get_mut(struct cgs_segvec* sv, size_t i)
+{
+        size_t b = cgs_segvec_block_of(i);
+        size_t offset = i - cgs_segvec_block_start(b);
+        return &sv->blocks[b][offset * sv->element_size];
+}
+
+/**
+ * cgs_segvec_clear
+ *
+ * Set the length of the vector to zero. Does not deallocate memory.
+ *
+ * @param sv    The segmented vector.
+ */
+inline void
+cgs_segvec_clear(struct cgs_segvec* sv)
+{
+        sv->length = 0;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Segmented Vector Standard Operations
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_segvec_push
+ *
+ * Add an element to the end of the vector. Never invalidates pointers to
+ * existing elements. Not safe to call concurrently with other pushes or
+ * claims.
+ *
+ * @param sv    The segmented vector.
+ * @param src   A read-only pointer to the element to add.
+ *
+ * @return      A mutable pointer to the element added or NULL on failure.
+ */
+void*
+cgs_segvec_push(struct cgs_segvec* sv, const void* src);
+
+/**
+ * cgs_segvec_pop
+ *
+ * Remove the last element of the vector, copying it into the provided
+ * memory location.
+ *
+ * @param sv    The segmented vector.
+ * @param p     A pointer to the copy destination.
+ *
+ * @return      A pointer back to p on successful pop, NULL when length is
+ *              zero.
+ */
+void*
+cgs_segvec_pop(struct cgs_segvec* sv, void* p);
+
+/**
+ * cgs_segvec_claim
+ *
+ * Atomically claim 'n' consecutive elements at the end of the vector. The
+ * blocks covering the claimed range are allocated before the claim is made
+ * so a failed claim leaves the vector unchanged. Safe to call from several
+ * threads at once, typically to claim a batch of elements per thread that
+ * is then filled with `cgs_segvec_get_mut`.
+ *
+ * The length includes claimed elements immediately. Other threads must not
+ * read the elements until the claiming thread has finished writing them
+ * and published that fact, for example by being joined.
+ *
+ * @param sv    The segmented vector.
+ * @param n     The number of elements to claim.
+ * @param first A pointer to store the index of the first claimed element.
+ *
+ * @return      A pointer to the segmented vector on success, NULL on failure.
+ */
+void*
+cgs_segvec_claim(struct cgs_segvec* sv, size_t n, size_t* first);
+
+/**
+ * cgs_segvec_foreach
+ *
+ * Traverse a read-only segmented vector block by block and perform an
+ * operation using each of its elements.
+ *
+ * @param sv    A read-only pointer to the segmented vector.
+ * @param f     A function to perform taking an element, the current index,
+ *              and a pointer to userdata.
+ * @param data  The userdata.
+ */
+void
+cgs_segvec_foreach(const struct cgs_segvec* sv, CgsUnaryOp f, void* data);
@@ -0,0 +1,287 @@
+/* cgs_strbuild.h
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_strbuild.h
+ *
+ * This file contains the public API for the libcgs string builder.
+ *
+ * String Builder
+ *
+ * An append-only text accumulator for output assembled from many small
+ * pieces. Text is kept in a chain of chunks that grow geometrically, so
+ * growing never copies what was already appended. The result is flattened
+ * once into a string of exactly the right capacity, or written straight to
+ * a stream or file descriptor without being flattened at all.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#pragma once
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cgs_alloc.h"
+#include "cgs_defs.h"
+#include "cgs_string.h"
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * String Builder Types
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+struct cgs_strbuild_chunk;
+
+/**
+ * struct cgs_strbuild
+ *
+ * @member head         The first chunk or NULL if nothing was allocated.
+ * @member tail         The chunk being appended to.
+ * @member length       The number of bytes appended.
+ * @member chunks       The number of chunks.
+ * @member alloc        The allocator used for the chunks.
+ */
+struct cgs_strbuild {
+        struct cgs_strbuild_chunk* head;
+        struct cgs_strbuild_chunk* tail;
+        size_t length;
+        size_t chunks;
+        const struct cgs_allocator* alloc;
+};
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * String Builder Management Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_strbuild_new
+ *
+ * Create a new empty builder.
+ *
+ * @return      An empty builder using the default allocator.
+ */
+struct cgs_strbuild
+cgs_strbuild_new(void);
+
+/**
+ * cgs_strbuild_free
+ *
+ * Deallocate a builder's chunks.
+ *
+ * @param sb    The builder.
+ */
+void
+cgs_strbuild_free(struct cgs_strbuild* sb);
+
+/**
+ * cgs_strbuild_set_allocator
+ *
+ * Attach an allocator to a builder that has not allocated yet.
+ *
+ * @param sb    The builder.
+ * @param a     The allocator or NULL for the C library.
+ *
+ * @return      A pointer back to the builder on success, NULL if the
+ *              builder already owns memory.
+ */
+void*
+cgs_strbuild_set_allocator(struct cgs_strbuild* sb,
+                const struct cgs_allocator* a);
+
+/**
+ * cgs_strbuild_clear
+ *
+ * Empty a builder, keeping its first chunk for reuse.
+ *
+ * @param sb    The builder.
+ */
+void
+cgs_strbuild_clear(struct cgs_strbuild* sb);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * String Builder Inline Getters
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_strbuild_length
+ *
+ * @param sb    The builder.
+ *
+ * @return      The number of bytes appended.
+ */
+inline size_t
+cgs_strbuild_length(const struct cgs_strbuild* sb)
+{
+        return sb->length;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * String Builder Appending
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_strbuild_append
+ *
+ * Add bytes to the end of the builder.
+ *
+ * @param sb    The builder.
+ * @param s     The bytes to append.
+ * @param n     The number of bytes.
+ *
+ * @return      A pointer back to the builder on success, NULL on allocation
+ *              failure, in which case nothing was appended.
+ */
+void*
+cgs_strbuild_append(struct cgs_strbuild* sb, const char* s, size_t n);
+
+/**
+ * cgs_strbuild_append_str
+ *
+ * Add a null-terminated string to the end of the builder.
+ */
+inline void*
+cgs_strbuild_append_str(struct cgs_strbuild* sb, const char* s)
+{
+        return cgs_strbuild_append(sb, s, strlen(s));
+}
+
+/**
+ * cgs_strbuild_append_strsub
+ *
+ * Add a strsub to the end of the builder.
+ */
+inline void*
+cgs_strbuild_append_strsub(struct cgs_strbuild* sb,
+                const struct cgs_strsub* ss)
+{
+        return cgs_strbuild_append(sb, ss->data, ss->length);
+}
+
+/**
+ * cgs_strbuild_append_string
+ *
+ * Add a string to the end of the builder.
+ */
+inline void*
+cgs_strbuild_append_string(struct cgs_strbuild* sb, const struct cgs_string* s)
+{
+        return cgs_strbuild_append(sb, cgs_string_data(s), s->length);
+}
+
+/**
+ * cgs_strbuild_push
+ *
+ * Add a single character to the end of the builder.
+ */
+void*
+cgs_strbuild_push(struct cgs_strbuild* sb, char c);
+
+/**
+ * cgs_strbuild_appendf
+ *
+ * Append printf-style formatted output. The output is written straight into
+ * the last chunk if it fits, otherwise into a new chunk sized to hold it.
+ *
+ * @param sb    The builder.
+ * @param fmt   Printf-style format string.
+ * @param ...   The arguments of the format.
+ *
+ * @return      A pointer back to the builder on success, NULL on a
+ *              formatting or allocation failure, in which case nothing was
+ *              appended.
+ */
+void*
+cgs_strbuild_appendf(struct cgs_strbuild* sb, const char* fmt, ...);
+
+/**
+ * cgs_strbuild_vappendf
+ *
+ * The va_list version of cgs_strbuild_appendf.
+ */
+void*
+cgs_strbuild_vappendf(struct cgs_strbuild* sb, const char* fmt, va_list args);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * String Builder Output
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_strbuild_to_string
+ *
+ * Copy the text into a string, replacing its contents. The string is sized
+ * to hold exactly the text and its '\0' and is written in one pass.
+ *
+ * @param sb    The builder.
+ * @param dst   The string to copy into.
+ *
+ * @return      A pointer back to 'dst' on success, NULL on failure.
+ */
+void*
+cgs_strbuild_to_string(const struct cgs_strbuild* sb, struct cgs_string* dst);
+
+/**
+ * cgs_strbuild_write
+ *
+ * Write the text to a stream, one chunk at a time.
+ *
+ * @param sb    The builder.
+ * @param fp    The stream.
+ *
+ * @return      A pointer back to the builder on success, NULL on a write
+ *              error.
+ */
+void*
+cgs_strbuild_write(const struct cgs_strbuild* sb, FILE* fp);
+
+/**
+ * cgs_strbuild_write_fd
+ *
+ * Write the text to a file descriptor with writev, many chunks per call.
+ * Short writes are continued and interrupted calls retried.
+ *
+ * @param sb    The builder.
+ * @param fd    The file descriptor.
+ *
+ * @return      A pointer back to the builder on success, NULL on a write
+ *              error with errno set by writev.
+ */
+void*
+cgs_strbuild_write_fd(const struct cgs_strbuild* sb, int fd);
+
+/**
+ * cgs_strbuild_foreach
+ *
+ * Call a function on each non-empty chunk of text in order. The element
+ * passed is a `const struct cgs_strsub*` that is only valid for the call.
+ *
+ * @param sb    The builder.
+ * @param f     The function, called with the chunk, its index and 'data'.
+ * @param data  User data passed through to 'f'.
+ */
+void
+cgs_strbuild_foreach(const struct cgs_strbuild* sb, CgsUnaryOp f,
+                void* data);
@@ -24,29 +24,51 @@
  */
 #pragma once
 
+#include <stdarg.h>     /* va_list */
 #include <stddef.h>	/* size_t */
+#include <stdint.h>     /* uint64_t */
 #include <string.h>     /* strlen */
 
 #include "cgs_vector.h"  /* vector for str_split */
+#include "cgs_alloc.h"
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * String Type
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
 
+/**
+ * CGS_STRING_INLINE_SIZE
+ *
+ * The number of bytes, including the terminating '\0', a string can hold
+ * inside the struct itself before allocating.
+ */
+enum cgs_string_inline { CGS_STRING_INLINE_SIZE = 24 };
+
 /**
  * struct cgs_string
  *
  * A dynamic string.
  *
+ * Short strings keep their characters in 'local' and only allocate once they
+ * outgrow it, which is indicated by a NULL 'data'. Strings may be moved with
+ * memcpy or by assignment, so 'data' never points into the struct itself.
+ * Always access the characters through the getters below rather than the
+ * 'data' member.
+ *
  * @member length       The number of characters in the string.
  * @member capacity     The number of characters that the string has room for
  *                      plus 1 for the terminating '\0'.
- * @member data         A pointer to the allocation.
+ * @member data         A pointer to the allocation or NULL while the string
+ *                      is stored inline.
+ * @member alloc        The allocator of 'data' or NULL for the C library.
+ * @member local        Inline storage for short strings.
  */
 struct cgs_string {
         size_t length;
         size_t capacity;
         char* data;
+        const struct cgs_allocator* alloc;
+        char local[CGS_STRING_INLINE_SIZE];
 };
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
@@ -56,13 +78,27 @@ struct cgs_string {
 /**
  * cgs_string_new
  *
- * Create and return a new cgs_string struct. All fields will be set to 0.
+ * Create and return a new, empty cgs_string struct stored inline. The string
+ * will use the calling thread's default allocator.
  *
  * @return      A new cgs_string struct.
  */
 struct cgs_string
 cgs_string_new(void);
 
+/**
+ * cgs_string_new_with
+ *
+ * Create a new, empty string that uses the given allocator, for example
+ * `cgs_allocator_huge()` for strings of many megabytes.
+ *
+ * @param a     The allocator or NULL for the C library.
+ *
+ * @return      A new cgs_string struct.
+ */
+struct cgs_string
+cgs_string_new_with(const struct cgs_allocator* a);
+
 /**
  * cgs_string_copy
  *
@@ -145,15 +181,32 @@ cgs_string_shrink(struct cgs_string* s);
 /**
  * cgs_string_xfer
  *
- * Release ownership of the inner string buffer.
+ * Release ownership of the inner string buffer. The buffer is first shrunk
+ * to fit, or copied into an allocation if the string is stored inline, so
+ * it must be released with the string's allocator and a size of its length
+ * plus one for the '\0'. The string is left empty.
  *
  * @param s     The string struct to release ownership from.
  *
- * @return      A pointer to the transferred memory.
+ * @return      A pointer to the transferred memory or NULL on failure.
  */
 char*
 cgs_string_xfer(struct cgs_string* s);
 
+/**
+ * cgs_string_set_allocator
+ *
+ * Attach an allocator to a string that has not allocated yet.
+ *
+ * @param s     The string.
+ * @param a     The allocator or NULL for the C library.
+ *
+ * @return      A pointer to the string on success, NULL if the string
+ *              already owns memory.
+ */
+void*
+cgs_string_set_allocator(struct cgs_string* s, const struct cgs_allocator* a);
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * String Inline Getters
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
@@ -170,7 +223,7 @@ cgs_string_xfer(struct cgs_string* s);
 inline const char*
 cgs_string_data(const struct cgs_string* s)
 {
-        return s->data;
+        return s->data ? s->data : s->local;
 }
 
 /**
@@ -185,7 +238,7 @@ cgs_string_data(const struct cgs_string* s)
 inline char*
 cgs_string_data_mut(struct cgs_string* s)
 {
-        return s->data;
+        return s->data ? s->data : s->local;
 }
 
 /**
@@ -216,7 +269,7 @@ cgs_string_length(const struct cgs_string* s)
 inline const char*
 cgs_string_get(const struct cgs_string* s, size_t i)
 {
-        return &s->data[i];
+        return &cgs_string_data(s)[i];
 }
 
 /**
@@ -232,7 +285,7 @@ cgs_string_get(const struct cgs_string* s, size_t i)
 inline char*
 cgs_string_get_mut(struct cgs_string* s, size_t i)
 {
-        return &s->data[i];
+        return &cgs_string_data_mut(s)[i];
 }
 
 /**
@@ -248,7 +301,7 @@ cgs_string_get_mut(struct cgs_string* s, size_t i)
 inline char
 cgs_string_char(const struct cgs_string* s, size_t i)
 {
-        return s->data[i];
+        return cgs_string_data(s)[i];
 }
 
 /**
@@ -265,7 +318,7 @@ cgs_string_char(const struct cgs_string* s, size_t i)
 inline const char*
 cgs_string_end(const struct cgs_string* s)
 {
-        return &s->data[s->length];
+        return &cgs_string_data(s)[s->length];
 }
 
 /**
@@ -282,7 +335,7 @@ cgs_string_end(const struct cgs_string* s)
 inline char*
 cgs_string_end_mut(struct cgs_string* s)
 {
-        return &s->data[s->length];
+        return &cgs_string_data_mut(s)[s->length];
 }
 
 /**
@@ -298,7 +351,7 @@ cgs_string_end_mut(struct cgs_string* s)
 inline const char*
 cgs_string_begin(const struct cgs_string* s)
 {
-        return s->data;
+        return cgs_string_data(s);
 }
 
 /**
@@ -314,7 +367,7 @@ cgs_string_begin(const struct cgs_string* s)
 inline char*
 cgs_string_begin_mut(struct cgs_string* s)
 {
-        return s->data;
+        return cgs_string_data_mut(s);
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
@@ -409,13 +462,36 @@ cgs_string_erase(struct cgs_string* s);
 /**
  * cgs_string_sort
  *
- * Sorts the characters of the string in-place.
+ * Sorts the characters of the string in-place, in the order of `char`
+ * comparison. Runs in linear time with a counting sort over the string's
+ * byte histogram.
  *
  * @param s	The string to sort.
  */
 void
 cgs_string_sort(struct cgs_string* s);
 
+/**
+ * cgs_string_tolower
+ *
+ * Convert the ASCII letters of a string to lower case in-place. Bytes above
+ * 0x7F are left unchanged.
+ *
+ * @param s	The string to convert.
+ */
+void
+cgs_string_tolower(struct cgs_string* s);
+
+/**
+ * cgs_string_toupper
+ *
+ * Convert the ASCII letters of a string to upper case in-place.
+ *
+ * @param s	The string to convert.
+ */
+void
+cgs_string_toupper(struct cgs_string* s);
+
 /**
  * cgs_string_find
  *
@@ -431,6 +507,36 @@ cgs_string_sort(struct cgs_string* s);
 size_t
 cgs_string_find(const struct cgs_string* s, const struct cgs_string* sub);
 
+/**
+ * cgs_string_rfind
+ *
+ * Search a string for the last occurrence of a substring.
+ *
+ * @param s     The string to search.
+ * @param sub   The substring to search for.
+ *
+ * @return      The position of the start of the last occurrence of the
+ *              substring if found, the string's length if not found.
+ */
+size_t
+cgs_string_rfind(const struct cgs_string* s, const struct cgs_string* sub);
+
+/**
+ * cgs_string_find_all
+ *
+ * Collect the positions of all non-overlapping occurrences of a substring,
+ * scanning from the start of the string.
+ *
+ * @param s     The string to search.
+ * @param sub   The substring to search for. Must not be empty.
+ * @param vec   A vector of size_t to push the positions onto.
+ *
+ * @return      A pointer back to the vector on success, NULL on failure.
+ */
+void*
+cgs_string_find_all(const struct cgs_string* s, const struct cgs_string* sub,
+                struct cgs_vector* vec);
+
 /**
  * cgs_string_trunc
  *
@@ -467,6 +573,137 @@ void*
 cgs_string_replace(struct cgs_string* s, size_t pos, size_t count,
                 const struct cgs_string* rep);
 
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * String Formatting
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_string_append_u64
+ *
+ * Append an unsigned integer in decimal. The digits are written straight
+ * into the string by cgs_format_u64.
+ *
+ * @param s     The string to append to.
+ * @param n     The value to append.
+ *
+ * @return      A pointer back to 's' on success, NULL on failure.
+ */
+void*
+cgs_string_append_u64(struct cgs_string* s, uint64_t n);
+
+/**
+ * cgs_string_append_i64
+ *
+ * Append a signed integer in decimal.
+ *
+ * @param s     The string to append to.
+ * @param n     The value to append.
+ *
+ * @return      A pointer back to 's' on success, NULL on failure.
+ */
+void*
+cgs_string_append_i64(struct cgs_string* s, int64_t n);
+
+/**
+ * cgs_string_append_int
+ *
+ * Append an int in decimal.
+ *
+ * @param s     The string to append to.
+ * @param n     The value to append.
+ *
+ * @return      A pointer back to 's' on success, NULL on failure.
+ */
+inline void*
+cgs_string_append_int(struct cgs_string* s, int n)
+{
+        return cgs_string_append_i64(s, n);
+}
+
+/**
+ * cgs_string_append_uint
+ *
+ * Append an unsigned int in decimal.
+ *
+ * @param s     The string to append to.
+ * @param n     The value to append.
+ *
+ * @return      A pointer back to 's' on success, NULL on failure.
+ */
+inline void*
+cgs_string_append_uint(struct cgs_string* s, unsigned n)
+{
+        return cgs_string_append_u64(s, n);
+}
+
+/**
+ * cgs_string_append_long
+ *
+ * Append a long in decimal.
+ *
+ * @param s     The string to append to.
+ * @param n     The value to append.
+ *
+ * @return      A pointer back to 's' on success, NULL on failure.
+ */
+inline void*
+cgs_string_append_long(struct cgs_string* s, long n)
+{
+        return cgs_string_append_i64(s, n);
+}
+
+/**
+ * cgs_string_append_double
+ *
+ * Append the shortest decimal that reads back as the same double, laid out
+ * as by cgs_format_double.
+ *
+ * @param s     The string to append to.
+ * @param d     The value to append.
+ *
+ * @return      A pointer back to 's' on success, NULL on failure.
+ */
+void*
+cgs_string_append_double(struct cgs_string* s, double d);
+
+/**
+ * cgs_string_appendf
+ *
+ * Append printf-style formatted output. The output is written straight
+ * into the string's spare capacity. If it does not fit, the string grows
+ * once to the measured length and the output is written again. Print a
+ * strsub with CGS_STRSUB_FMT and CGS_STRSUB_ARG.
+ *
+ * Arguments must not point into 's' itself, as they would be overwritten
+ * while being read or freed by the grow. Copy such text first or append it
+ * with `cgs_string_cat`.
+ *
+ * @param s     The string to append to.
+ * @param fmt   Printf-style format string.
+ * @param ...   Additional arguments to format string.
+ *
+ * @return      A pointer back to 's' on success, NULL on failure, in which
+ *              case 's' is unchanged.
+ */
+void*
+cgs_string_appendf(struct cgs_string* s, const char* fmt, ...);
+
+/**
+ * cgs_string_vappendf
+ *
+ * The va_list version of cgs_string_appendf. The same restriction on
+ * arguments pointing into 's' applies.
+ *
+ * @param s     The string to append to.
+ * @param fmt   Printf-style format string.
+ * @param args  Additional arguments to format string.
+ *
+ * @return      A pointer back to 's' on success, NULL on failure, in which
+ *              case 's' is unchanged.
+ */
+void*
+cgs_string_vappendf(struct cgs_string* s, const char* fmt, va_list args);
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * Strsub Type
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
@@ -487,6 +724,18 @@ struct cgs_strsub {
         size_t length;
 };
 
+/**
+ * CGS_STRSUB_FMT
+ * CGS_STRSUB_ARG
+ *
+ * Print a strsub with the printf family. The format takes the length as an
+ * int precision, since strsubs are not NUL-terminated:
+ *
+ *      printf("key: " CGS_STRSUB_FMT "\n", CGS_STRSUB_ARG(&ss));
+ */
+#define CGS_STRSUB_FMT          "%.*s"
+#define CGS_STRSUB_ARG(ss)      (int)(ss)->length, (ss)->data
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * Strsub Creation
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
@@ -553,28 +802,165 @@ cgs_strsub_cmp(const void* a, const void* b);
 int
 cgs_strsub_eq_str(const struct cgs_strsub* ss, const char* s);
 
+/**
+ * cgs_strsub_cmp_nocase
+ *
+ * A three-way comparison function for cgs_strsub's that ignores ASCII case.
+ *
+ * @param a     A pointer to the target strsub.
+ * @param b     A pointer to the compare strsub.
+ *
+ * @return      An integer indicating equality(0), lesser(<0) or greater(>0).
+ */
+int
+cgs_strsub_cmp_nocase(const void* a, const void* b);
+
+/**
+ * cgs_strsub_eq_nocase
+ *
+ * An equality test for two strsubs that ignores ASCII case.
+ *
+ * @param a     A strsub.
+ * @param b     Another strsub.
+ *
+ * @return      A boolean integer indicating true(1) or false(0).
+ */
+int
+cgs_strsub_eq_nocase(const struct cgs_strsub* a, const struct cgs_strsub* b);
+
+/**
+ * cgs_strsub_eq_str_nocase
+ *
+ * An equality test for a strsub and a C-string that ignores ASCII case.
+ *
+ * @param ss    A strsub.
+ * @param s     A C-string.
+ *
+ * @return      A boolean integer indicating true(1) or false(0).
+ */
+int
+cgs_strsub_eq_str_nocase(const struct cgs_strsub* ss, const char* s);
+
+/**
+ * cgs_strsub_trim_left
+ *
+ * Drop the leading ASCII whitespace from a strsub's view. Only the view
+ * changes; the bytes are not touched.
+ *
+ * @param ss    The strsub.
+ */
+void
+cgs_strsub_trim_left(struct cgs_strsub* ss);
+
+/**
+ * cgs_strsub_trim_right
+ *
+ * Drop the trailing ASCII whitespace from a strsub's view.
+ *
+ * @param ss    The strsub.
+ */
+void
+cgs_strsub_trim_right(struct cgs_strsub* ss);
+
+/**
+ * cgs_strsub_trim
+ *
+ * Drop the leading and trailing ASCII whitespace from a strsub's view.
+ *
+ * @param ss    The strsub.
+ */
+void
+cgs_strsub_trim(struct cgs_strsub* ss);
+
+/**
+ * cgs_strsub_trim_set
+ *
+ * Drop the leading and trailing bytes found in a set from a strsub's view.
+ *
+ * @param ss    The strsub.
+ * @param set   A C-string of the bytes to trim.
+ */
+void
+cgs_strsub_trim_set(struct cgs_strsub* ss, const char* set);
+
+/**
+ * cgs_strsub_tolower
+ *
+ * Copy a strsub into a buffer with its ASCII letters in lower case. No
+ * '\0' is written.
+ *
+ * @param ss    The strsub.
+ * @param dst   A buffer of at least the strsub's length.
+ */
+void
+cgs_strsub_tolower(const struct cgs_strsub* ss, char* dst);
+
+/**
+ * cgs_strsub_toupper
+ *
+ * Copy a strsub into a buffer with its ASCII letters in upper case. No
+ * '\0' is written.
+ *
+ * @param ss    The strsub.
+ * @param dst   A buffer of at least the strsub's length.
+ */
+void
+cgs_strsub_toupper(const struct cgs_strsub* ss, char* dst);
+
 /**
  * cgs_strsub_to_int
  *
- * Attempt to parse a sub-string as an integer.
+ * Attempt to parse a sub-string as an integer. See cgs_parse_i32 for wider
+ * types, other bases and the end position.
  *
  * @param ss    The sub-string to parse.
  * @param out   A pointer to an integer to store the output in.
  *
- * @return      The 'out' pointer on successful parse, NULL on failure.
+ * @return      The 'out' pointer on successful parse, NULL on failure or if
+ *              the value does not fit.
  */
 void*
 cgs_strsub_to_int(const struct cgs_strsub* ss, int* out);
 
+/**
+ * cgs_strsub_find
+ *
+ * Search a sub-string for the first occurrence of another.
+ *
+ * @param ss    The sub-string to search.
+ * @param sub   The sub-string to search for.
+ *
+ * @return      The position of the match within 'ss' if found, the length
+ *              of 'ss' if not found.
+ */
+size_t
+cgs_strsub_find(const struct cgs_strsub* ss, const struct cgs_strsub* sub);
+
+/**
+ * cgs_strsub_rfind
+ *
+ * Search a sub-string for the last occurrence of another.
+ *
+ * @param ss    The sub-string to search.
+ * @param sub   The sub-string to search for.
+ *
+ * @return      The position of the last match within 'ss' if found, the
+ *              length of 'ss' if not found.
+ */
+size_t
+cgs_strsub_rfind(const struct cgs_strsub* ss, const struct cgs_strsub* sub);
+
 /**
  * cgs_strsub_to_str
  *
- * Allocate a duplicate of the provided sub-string.
+ * Allocate a duplicate of the provided sub-string with the calling thread's
+ * default allocator.
  *
  * @param ss    The sub-string to duplicate.
  *
  * @return      An allocated copy of the sub-string on success, NULL on
- *              failure. Caller is responsible for freeing.
+ *              failure. Caller is responsible for freeing it with the same
+ *              allocator, which is plain `free` unless a default was set.
  */
 char*
 cgs_strsub_to_str(const struct cgs_strsub* ss);
@@ -596,6 +982,17 @@ cgs_strsub_to_string(const struct cgs_strsub* ss, struct cgs_string* dst);
  * String splitting functions
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
+/**
+ * enum cgs_split_flags
+ *
+ * CGS_SPLIT_KEEP_EMPTY keeps the empty fields between adjacent delimiters
+ * and at either end, so that 'n' delimiters always give 'n + 1' fields.
+ * Empty fields are dropped otherwise.
+ */
+enum cgs_split_flags {
+        CGS_SPLIT_KEEP_EMPTY = 1 << 0,
+};
+
 /**
  * cgs_str_split
  *
@@ -645,6 +1042,165 @@ void*
 cgs_strsub_split(const struct cgs_strsub* ss, char delim,
                 struct cgs_vector* vec);
 
+/**
+ * cgs_strsub_split_any
+ *
+ * Split a sub-string on any of a set of delimiter characters. Small sets
+ * are searched for 16 bytes at a time where SSE2 is available. Reserve the
+ * vector up front to keep pushes from reallocating.
+ *
+ * @param ss     The sub-string to split.
+ * @param delims A C-string of the delimiter characters, e.g. " ,\t".
+ * @param flags  A combination of `enum cgs_split_flags`.
+ * @param vec    The vector to store the strsub elements into.
+ *
+ * @return       A pointer back to the vector on success, NULL on failure.
+ */
+void*
+cgs_strsub_split_any(const struct cgs_strsub* ss, const char* delims,
+                int flags, struct cgs_vector* vec);
+
+/**
+ * cgs_strsub_split_str
+ *
+ * Split a sub-string on a multi-character separator. Separators are found
+ * left to right without overlapping.
+ *
+ * @param ss    The sub-string to split.
+ * @param sep   The separator. Must not be empty.
+ * @param flags A combination of `enum cgs_split_flags`.
+ * @param vec   The vector to store the strsub elements into.
+ *
+ * @return      A pointer back to the vector on success, NULL on failure.
+ */
+void*
+cgs_strsub_split_str(const struct cgs_strsub* ss, const struct cgs_strsub* sep,
+                int flags, struct cgs_vector* vec);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Split Iterator
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/**
+ * struct cgs_split_iter
+ *
+ * Yields the fields of a sub-string one at a time without allocating. The
+ * iterator only refers to the source text, which must outlive it.
+ *
+ * @member data         The text being split.
+ * @member length       The length of the text.
+ * @member pos          The start of the next field. Past 'length' once the
+ *                      last field has been yielded.
+ * @member delim        The delimiter byte when the set has exactly one,
+ *                      otherwise -1.
+ * @member flags        A combination of `enum cgs_split_flags`.
+ * @member set          A bitmap of the delimiter bytes.
+ */
+struct cgs_split_iter {
+        const char* data;
+        size_t length;
+        size_t pos;
+        int delim;
+        int flags;
+        uint64_t set[4];
+};
+
+/**
+ * cgs_split_iter_new
+ *
+ * Create an iterator over the fields of a sub-string.
+ *
+ * @param ss     The sub-string to split.
+ * @param delims A C-string of the delimiter characters.
+ * @param flags  A combination of `enum cgs_split_flags`.
+ *
+ * @return       The iterator, positioned before the first field.
+ */
+struct cgs_split_iter
+cgs_split_iter_new(const struct cgs_strsub* ss, const char* delims, int flags);
+
+/**
+ * cgs_str_split_iter
+ *
+ * Create an iterator over the fields of a C-string.
+ *
+ * @param s      The string to split.
+ * @param delims A C-string of the delimiter characters.
+ * @param flags  A combination of `enum cgs_split_flags`.
+ *
+ * @return       The iterator, positioned before the first field.
+ */
+inline struct cgs_split_iter
+cgs_str_split_iter(const char* s, const char* delims, int flags)
+{
+        struct cgs_strsub ss = cgs_strsub_from_str(s);
+        return cgs_split_iter_new(&ss, delims, flags);
+}
+
+/**
+ * cgs_string_split_iter
+ *
+ * Create an iterator over the fields of a `struct cgs_string`.
+ *
+ * @param s      The cgs_string to split.
+ * @param delims A C-string of the delimiter characters.
+ * @param flags  A combination of `enum cgs_split_flags`.
+ *
+ * @return       The iterator, positioned before the first field.
+ */
+inline struct cgs_split_iter
+cgs_string_split_iter(const struct cgs_string* s, const char* delims,
+                int flags)
+{
+        struct cgs_strsub ss = cgs_strsub_new(cgs_string_data(s),
+                        cgs_string_length(s));
+        return cgs_split_iter_new(&ss, delims, flags);
+}
+
+/**
+ * cgs_split_iter_next
+ *
+ * Advance to the next field.
+ *
+ * @param it    The iterator.
+ * @param out   Receives the field.
+ *
+ * @return      A pointer back to the iterator, or NULL when there are no
+ *              fields left, in which case 'out' is untouched.
+ */
+void*
+cgs_split_iter_next(struct cgs_split_iter* it, struct cgs_strsub* out);
+
+/**
+ * cgs_split_iter_skip
+ *
+ * Skip over the next 'n' fields.
+ *
+ * @param it    The iterator.
+ * @param n     The number of fields to skip.
+ *
+ * @return      The number of fields skipped, less than 'n' if the iterator
+ *              ran out.
+ */
+size_t
+cgs_split_iter_skip(struct cgs_split_iter* it, size_t n);
+
+/**
+ * cgs_split_iter_collect
+ *
+ * Store up to 'n' of the following fields in a caller-provided array,
+ * such as one on the stack.
+ *
+ * @param it    The iterator.
+ * @param arr   The array to fill.
+ * @param n     The number of elements in 'arr'.
+ *
+ * @return      The number of fields stored.
+ */
+size_t
+cgs_split_iter_collect(struct cgs_split_iter* it, struct cgs_strsub* arr,
+                size_t n);
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * C-String Utility Functions
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
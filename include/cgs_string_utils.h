@@ -48,7 +48,8 @@ cgs_strdup(const char* s);
 /**
  * cgs_strtoi
  *
- * Attempt to parse a string as an integer.
+ * Attempt to parse a string as a decimal integer. Leading ASCII whitespace
+ * and a sign are accepted; the current locale is not consulted.
  *
  * @param s     The string to parse.
  * @param p     A pointer to a const char* to store the location of the next
@@ -56,7 +57,8 @@ cgs_strdup(const char* s);
  *              'p' should point to the terminating '\0' at the end of 's'.
  *
  * @return      An integer value parsed from the string on success. On failure,
- *              zero is returned and 'p' is set to equal 's'.
+ *              including a value out of range for int, zero is returned and
+ *              'p' is set to equal 's'.
  */
 int
 cgs_strtoi(const char* s, const char** p);
@@ -145,7 +147,8 @@ void cgs_strshiftr(char* s, size_t n, int c);
 /**
  * cgs_strtrim
  *
- * Remove all whitespace from the beginning and end of a string.
+ * Remove all ASCII whitespace from the beginning and end of a string. The
+ * rest of the string is moved to the front with a single memmove.
  *
  * @param s	The string to trim.
  *
@@ -156,7 +159,8 @@ void cgs_strtrim(char* s);
 /**
  * cgs_strtrimch
  *
- * Remove all instances of 'ch' from the beginning and end of a string.
+ * Remove all instances of 'ch' from the beginning and end of a string with
+ * a single memmove.
  *
  * @param s	The string to trim.
  * @param ch	The character to remove.
@@ -164,3 +168,159 @@ void cgs_strtrim(char* s);
  * @return	Void.
  */
 void cgs_strtrimch(char* s, char ch);
+
+/**
+ * cgs_memfind
+ *
+ * Find the first occurrence of a byte sequence in a buffer. Single bytes
+ * are found with memchr, short needles by filtering on their first and last
+ * byte 16 positions at a time where SSE2 is available, and long needles with
+ * Boyer-Moore-Horspool.
+ *
+ * @param s	The buffer to search.
+ * @param n	The length of the buffer.
+ * @param sub	The byte sequence to search for.
+ * @param m	The length of the byte sequence.
+ *
+ * @return	The position of the first match or 'n' if there is none. An
+ *		empty sequence matches at 0.
+ */
+size_t cgs_memfind(const char* s, size_t n, const char* sub, size_t m);
+
+/**
+ * cgs_memrfind
+ *
+ * Find the last occurrence of a byte sequence in a buffer.
+ *
+ * @param s	The buffer to search.
+ * @param n	The length of the buffer.
+ * @param sub	The byte sequence to search for.
+ * @param m	The length of the byte sequence.
+ *
+ * @return	The position of the last match or 'n' if there is none. An
+ *		empty sequence matches at 'n'.
+ */
+size_t cgs_memrfind(const char* s, size_t n, const char* sub, size_t m);
+
+/**
+ * cgs_str_byte_histogram
+ *
+ * Count the occurrences of each byte value in a buffer. The counts are added
+ * to 'counts' so one histogram can span several buffers; zero it first to
+ * count a single buffer. Long buffers are counted into four interleaved
+ * tables so consecutive equal bytes do not wait on each other's increment.
+ *
+ * @param s	The buffer to count.
+ * @param n	The length of the buffer.
+ * @param counts	The histogram, indexed by unsigned byte value.
+ */
+void cgs_str_byte_histogram(const char* s, size_t n, size_t counts[256]);
+
+/**
+ * cgs_str_is_anagram
+ *
+ * Check whether two buffers hold the same bytes in any order.
+ *
+ * @param a	The first buffer.
+ * @param n	The length of the first buffer.
+ * @param b	The second buffer.
+ * @param m	The length of the second buffer.
+ *
+ * @return	A boolean integer indicating true(1) or false(0).
+ */
+int cgs_str_is_anagram(const char* a, size_t n, const char* b, size_t m);
+
+/**
+ * cgs_ascii_tolower
+ * cgs_ascii_toupper
+ *
+ * Convert the case of an ASCII letter without consulting the locale. Other
+ * values are returned unchanged.
+ *
+ * @param c	The character as an unsigned char or EOF.
+ *
+ * @return	The converted character.
+ */
+inline int cgs_ascii_tolower(int c)
+{
+	return (unsigned)c - 'A' < 26 ? c | 0x20 : c;
+}
+
+inline int cgs_ascii_toupper(int c)
+{
+	return (unsigned)c - 'a' < 26 ? c & ~0x20 : c;
+}
+
+/**
+ * cgs_memlower
+ *
+ * Copy a buffer converting ASCII letters to lower case, 16 bytes at a time
+ * where SSE2 is available. Bytes above 0x7F are copied unchanged.
+ *
+ * @param dst	The destination. May be the same as 'src' but must not
+ *		otherwise overlap it.
+ * @param src	The buffer to convert.
+ * @param n	The length of the buffer.
+ */
+void cgs_memlower(char* dst, const char* src, size_t n);
+
+/**
+ * cgs_memupper
+ *
+ * Copy a buffer converting ASCII letters to upper case. See `cgs_memlower`.
+ */
+void cgs_memupper(char* dst, const char* src, size_t n);
+
+/**
+ * cgs_memcasecmp
+ *
+ * Compare two buffers ignoring ASCII case, 16 bytes at a time where SSE2 is
+ * available.
+ *
+ * @param a	The first buffer.
+ * @param b	The second buffer.
+ * @param n	The number of bytes to compare.
+ *
+ * @return	The difference of the lower case values of the first
+ *		differing pair of bytes as unsigned chars, or 0 if none differ.
+ */
+int cgs_memcasecmp(const char* a, const char* b, size_t n);
+
+/**
+ * cgs_strcasecmp
+ *
+ * Compare two strings ignoring ASCII case. A string that is a prefix of the
+ * other is the lesser.
+ *
+ * @param a	The first string.
+ * @param b	The second string.
+ *
+ * @return	An integer indicating the result of the comparison.
+ */
+int cgs_strcasecmp(const char* a, const char* b);
+
+/**
+ * cgs_memspn_space
+ *
+ * Find the length of the run of ASCII whitespace (' ', '\t', '\n', '\v',
+ * '\f', '\r') at the start of a buffer. Runs longer than one byte are
+ * scanned 16 bytes at a time where SSE2 is available.
+ *
+ * @param s	The buffer.
+ * @param n	The length of the buffer.
+ *
+ * @return	The number of leading whitespace bytes.
+ */
+size_t cgs_memspn_space(const char* s, size_t n);
+
+/**
+ * cgs_memrspn_space
+ *
+ * Find the length of the run of ASCII whitespace at the end of a buffer.
+ *
+ * @param s	The buffer.
+ * @param n	The length of the buffer.
+ *
+ * @return	The number of trailing whitespace bytes.
+ */
+size_t cgs_memrspn_space(const char* s, size_t n);
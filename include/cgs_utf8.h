@@ -0,0 +1,255 @@
+/* cgs_utf8.h
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_utf8.h
+ *
+ * This file contains the public API for the libcgs UTF-8 functions.
+ *
+ * UTF-8
+ *
+ * Validation, code point counting and code point iteration over byte
+ * strings. Strings and strsubs stay byte-indexed; these functions read them
+ * as UTF-8 without changing how they are stored.
+ *
+ * Validation follows the Unicode definition of well-formed UTF-8: no
+ * overlong forms, no surrogates and nothing above U+10FFFF. Runs of ASCII
+ * are skipped 16 bytes at a time. Where SSSE3 is available the rest is
+ * checked 16 bytes at a time as well, by table lookups on byte nibbles.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cgs_string.h"
+
+enum cgs_utf8_constants {
+        CGS_UTF8_REPLACEMENT = 0xFFFD,          // U+FFFD REPLACEMENT CHARACTER
+        CGS_UTF8_MAX_SEQUENCE = 4,
+};
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * UTF-8 Validation and Counting
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_utf8_ascii_prefix
+ *
+ * Find the length of the run of ASCII bytes at the start of a buffer.
+ *
+ * @param s     The buffer.
+ * @param n     The length of the buffer.
+ *
+ * @return      The position of the first byte above 0x7F or 'n' if there
+ *              is none.
+ */
+size_t
+cgs_utf8_ascii_prefix(const char* s, size_t n);
+
+/**
+ * cgs_utf8_validate
+ *
+ * Find the longest prefix of a buffer that is well-formed UTF-8.
+ *
+ * @param s     The buffer.
+ * @param n     The length of the buffer.
+ *
+ * @return      The position of the first byte of the first ill-formed or
+ *              truncated sequence, or 'n' if the whole buffer is valid.
+ */
+size_t
+cgs_utf8_validate(const char* s, size_t n);
+
+/**
+ * cgs_utf8_valid
+ *
+ * Check whether a buffer is well-formed UTF-8.
+ *
+ * @param s     The buffer.
+ * @param n     The length of the buffer.
+ *
+ * @return      A boolean integer indicating true(1) or false(0).
+ */
+inline int
+cgs_utf8_valid(const char* s, size_t n)
+{
+        return cgs_utf8_validate(s, n) == n;
+}
+
+/**
+ * cgs_utf8_count
+ *
+ * Count the code points in a buffer of valid UTF-8 by counting the bytes
+ * that are not continuation bytes. The result for invalid input is the
+ * number of bytes below 0x80 or above 0xBF.
+ *
+ * @param s     The buffer.
+ * @param n     The length of the buffer.
+ *
+ * @return      The number of code points.
+ */
+size_t
+cgs_utf8_count(const char* s, size_t n);
+
+/**
+ * cgs_utf8_decode
+ *
+ * Decode the code point at the start of a buffer.
+ *
+ * @param s     The buffer.
+ * @param n     The length of the buffer. Must not be 0.
+ * @param cp    A pointer to store the code point in.
+ *
+ * @return      The length of the sequence in bytes, or 0 if the buffer does
+ *              not start with a well-formed sequence.
+ */
+size_t
+cgs_utf8_decode(const char* s, size_t n, uint32_t* cp);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * UTF-8 String and Strsub Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_strsub_utf8_valid
+ *
+ * Same as `cgs_utf8_valid` for a strsub.
+ */
+inline int
+cgs_strsub_utf8_valid(const struct cgs_strsub* ss)
+{
+        return cgs_utf8_valid(ss->data, ss->length);
+}
+
+/**
+ * cgs_string_utf8_valid
+ *
+ * Same as `cgs_utf8_valid` for a whole string.
+ */
+inline int
+cgs_string_utf8_valid(const struct cgs_string* s)
+{
+        return cgs_utf8_valid(cgs_string_data(s), s->length);
+}
+
+/**
+ * cgs_strsub_utf8_count
+ *
+ * Same as `cgs_utf8_count` for a strsub.
+ */
+inline size_t
+cgs_strsub_utf8_count(const struct cgs_strsub* ss)
+{
+        return cgs_utf8_count(ss->data, ss->length);
+}
+
+/**
+ * cgs_string_utf8_count
+ *
+ * Same as `cgs_utf8_count` for a whole string.
+ */
+inline size_t
+cgs_string_utf8_count(const struct cgs_string* s)
+{
+        return cgs_utf8_count(cgs_string_data(s), s->length);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * UTF-8 Iterator
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * struct cgs_utf8_iter
+ *
+ * A cursor over the code points of a buffer.
+ *
+ * @member data         The buffer.
+ * @member length       The length of the buffer.
+ * @member pos          The position of the next code point.
+ */
+struct cgs_utf8_iter {
+        const char* data;
+        size_t length;
+        size_t pos;
+};
+
+/**
+ * cgs_utf8_iter_new
+ *
+ * Create an iterator over the code points of a strsub.
+ *
+ * @param ss    The strsub. Its data must outlive the iterator.
+ *
+ * @return      An iterator positioned at the first code point.
+ */
+inline struct cgs_utf8_iter
+cgs_utf8_iter_new(const struct cgs_strsub* ss)
+{
+        return (struct cgs_utf8_iter){
+                .data = ss->data,
+                .length = ss->length,
+                .pos = 0,
+        };
+}
+
+/**
+ * cgs_utf8_iter_next
+ *
+ * Read the next code point. An ill-formed byte is read as
+ * CGS_UTF8_REPLACEMENT and skipped on its own, so iteration always moves
+ * forward. ASCII is handled without a call.
+ *
+ * @param it    The iterator.
+ * @param cp    A pointer to store the code point in.
+ *
+ * @return      A pointer back to the iterator, or NULL if there are no more
+ *              code points.
+ */
+inline void*
+cgs_utf8_iter_next(struct cgs_utf8_iter* it, uint32_t* cp)
+{
+        if (it->pos >= it->length)
+                return NULL;
+
+        unsigned char c = it->data[it->pos];
+        if (c < 0x80) {
+                *cp = c;
+                ++it->pos;
+                return it;
+        }
+
+        size_t len = cgs_utf8_decode(&it->data[it->pos],
+                        it->length - it->pos, cp);
+        if (len == 0) {
+                *cp = CGS_UTF8_REPLACEMENT;
+                len = 1;
+        }
+        it->pos += len;
+        return it;
+}
@@ -26,27 +26,63 @@
 
 #include <stddef.h>
 #include "cgs_defs.h"
+#include "cgs_alloc.h"
+
+struct cgs_parallel_opts;
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * Vector Types
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
 
+/**
+ * Vector Inline Storage
+ *
+ * The number of bytes a vector created with `cgs_vector_new_small` can hold
+ * inside the struct itself before spilling to the heap.
+ */
+enum cgs_vector_inline { CGS_VECTOR_INLINE_SIZE = 32 };
+
+/**
+ * union cgs_vector_local
+ *
+ * The inline storage of a vector. The extra members only serve to align the
+ * bytes for any element type.
+ */
+union cgs_vector_local {
+        char bytes[CGS_VECTOR_INLINE_SIZE];
+        void* p;
+        long long ll;
+        double d;
+};
+
 /**
  * struct cgs_vector
  *
  * A generic, dynamic array
  *
+ * The elements of a vector live in 'data' once it has been allocated. Small
+ * vectors keep their elements in 'local' until they outgrow it, which is
+ * indicated by a NULL 'data' with a non-zero 'capacity'. Always access the
+ * elements through the getters below rather than the 'data' member.
+ *
  * @member length       The number of elements in the vector.
  * @member capacity     The current number of elements that the vector has
  *                      room for.
  * @member element_size The size of the elements in the vector in bytes.
  * @member data         A pointer to the allocated memory.
+ * @member growth       An optional growth policy or NULL to use the default
+ *                      doubling strategy.
+ * @member alloc        The allocator of 'data' or NULL for the C library.
+ * @member local        Inline storage for small vectors.
  */
 struct cgs_vector {
 	size_t length;
 	size_t capacity;
 	size_t element_size;
 	char* data;
+	CgsGrowthFunc growth;
+	const struct cgs_allocator* alloc;
+	union cgs_vector_local local;
 };
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
@@ -56,6 +92,8 @@ struct cgs_vector {
 /**
  * cgs_vector_new
  *
+ * The vector uses the calling thread's default allocator.
+ *
  * @param size  The size of the elements to be contained in the vector.
  *
  * @return      An empty vector object initialized for elements of the
@@ -64,11 +102,47 @@ struct cgs_vector {
 struct cgs_vector
 cgs_vector_new(size_t size);
 
+/**
+ * cgs_vector_new_small
+ *
+ * Create a vector that stores its first elements inline, only allocating
+ * once more than CGS_VECTOR_INLINE_SIZE bytes are needed. If a single
+ * element does not fit inline this is the same as `cgs_vector_new`.
+ *
+ * Small vectors may be moved with memcpy or by assignment like any other
+ * vector, but pointers to their elements are only stable until the vector
+ * itself is moved.
+ *
+ * @param size  The size of the elements to be contained in the vector.
+ *
+ * @return      An empty vector object initialized for elements of the
+ *              given size.
+ */
+struct cgs_vector
+cgs_vector_new_small(size_t size);
+
+/**
+ * cgs_vector_new_with
+ *
+ * Create a vector that uses the given allocator, for example
+ * `cgs_allocator_aligned()` for SIMD kernels or `cgs_allocator_huge()` for
+ * vectors of many megabytes.
+ *
+ * @param size  The size of the elements to be contained in the vector.
+ * @param a     The allocator or NULL for the C library.
+ *
+ * @return      An empty vector object initialized for elements of the
+ *              given size.
+ */
+struct cgs_vector
+cgs_vector_new_with(size_t size, const struct cgs_allocator* a);
+
 /**
  * cgs_vector_copy
  *
  * Copy an existing vector into a new one. The 'dst' vector should not own any
  * allocated memory, ideally being created by the call `cgs_vector_new(0)`.
+ * The copy uses the allocator of 'src'.
  *
  * @param src   The source cgs_vector to copy from.
  * @param dst   The destination cgs_vector to copy to.
@@ -97,7 +171,8 @@ cgs_vector_copy_with(const struct cgs_vector* src, struct cgs_vector* dst,
 /**
  * cgs_vector_from_array
  *
- * Allocates a new vector and fills it with the elements in src.
+ * Allocates a new vector and fills it with the elements in src using the
+ * calling thread's default allocator.
  *
  * @param arr	A read-only pointer to the source array.
  * @param len	The length of the source array.
@@ -149,17 +224,88 @@ cgs_vector_free_all_with(struct cgs_vector* v, CgsFreeFunc ff);
 /**
  * cgs_vector_xfer
  *
- * Releases ownership of vector memory.
+ * Releases ownership of vector memory. The memory is first shrunk to the
+ * length of the vector, or copied into a new allocation if the vector is
+ * still using inline storage, so it must be released with the vector's
+ * allocator and a size of the returned length times the element size. The
+ * vector is left empty.
  *
  * @param v	The vector to transfer ownership from.
  * @param len	Optional pointer to a size_t variable to store the length of
  *              the vector in or NULL.
  *
- * @return	A pointer to the transferred memory.
+ * @return	A pointer to the transferred memory or NULL if the vector is
+ *              empty or an allocation failed.
  */
 void*
 cgs_vector_xfer(struct cgs_vector* v, size_t* len);
 
+/**
+ * cgs_vector_reserve
+ *
+ * Ensure the vector has room for at least 'n' elements without further
+ * allocations. Does nothing if the capacity is already 'n' or greater.
+ *
+ * @param v     The vector.
+ * @param n     The minimum number of elements to make room for.
+ *
+ * @return      A pointer to the vector on success, NULL on failure.
+ */
+void*
+cgs_vector_reserve(struct cgs_vector* v, size_t n);
+
+/**
+ * cgs_vector_resize
+ *
+ * Change the length of the vector to 'n'. New elements are zero-filled.
+ * Shrinking the length does not release any memory.
+ *
+ * @param v     The vector.
+ * @param n     The new length of the vector.
+ *
+ * @return      A pointer to the vector on success, NULL on failure.
+ */
+void*
+cgs_vector_resize(struct cgs_vector* v, size_t n);
+
+/**
+ * cgs_vector_shrink
+ *
+ * Shrinks the allocation of a vector to the smallest necessary size.
+ *
+ * @param v     The vector.
+ *
+ * @return      A pointer to the vector on success, NULL on failure.
+ */
+void*
+cgs_vector_shrink(struct cgs_vector* v);
+
+/**
+ * cgs_vector_set_growth
+ *
+ * Set the growth policy of the vector. The policy is consulted whenever a
+ * push or insert runs out of room.
+ *
+ * @param v     The vector.
+ * @param f     The growth function or NULL to restore the default.
+ */
+void
+cgs_vector_set_growth(struct cgs_vector* v, CgsGrowthFunc f);
+
+/**
+ * cgs_vector_set_allocator
+ *
+ * Attach an allocator to a vector that has not allocated yet.
+ *
+ * @param v     The vector.
+ * @param a     The allocator or NULL for the C library.
+ *
+ * @return      A pointer to the vector on success, NULL if the vector
+ *              already owns heap memory.
+ */
+void*
+cgs_vector_set_allocator(struct cgs_vector* v, const struct cgs_allocator* a);
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * Array Inline Getters
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
@@ -194,6 +340,8 @@ cgs_vector_length(const struct cgs_vector* v)
 inline const void*
 cgs_vector_data(const struct cgs_vector* v)
 {
+        if (!v->data && v->capacity > 0)
+                return (const void*)v->local.bytes;
         return (const void*)v->data;
 }
 
@@ -212,6 +360,8 @@ cgs_vector_data(const struct cgs_vector* v)
 inline void*
 cgs_vector_data_mut(struct cgs_vector* v)
 {
+        if (!v->data && v->capacity > 0)
+                return (void*)v->local.bytes;
         return (void*)v->data;
 }
 
@@ -228,7 +378,7 @@ cgs_vector_data_mut(struct cgs_vector* v)
 inline const void*
 cgs_vector_get(const struct cgs_vector* v, size_t index)
 {
-	return &v->data[v->element_size * index];
+	return (const char*)cgs_vector_data(v) + v->element_size * index;
 }
 
 /**
@@ -244,19 +394,19 @@ cgs_vector_get(const struct cgs_vector* v, size_t index)
 inline void*
 cgs_vector_get_mut(struct cgs_vector* v, size_t index)
 {
-	return &v->data[v->element_size * index];
+	return (char*)cgs_vector_data_mut(v) + v->element_size * index;
 }
 
 inline const void*
 cgs_vector_first(const struct cgs_vector* v)
 {
-        return v->data;
+        return cgs_vector_data(v);
 }
 
 inline const void*
 cgs_vector_last(const struct cgs_vector* v)
 {
-        return &v->data[v->element_size * (v->length - 1)];
+        return cgs_vector_get(v, v->length - 1);
 }
 
 /**
@@ -271,7 +421,7 @@ cgs_vector_last(const struct cgs_vector* v)
 inline const void*
 cgs_vector_begin(const struct cgs_vector* v)
 {
-	return v->data;
+	return cgs_vector_data(v);
 }
 
 /**
@@ -286,7 +436,7 @@ cgs_vector_begin(const struct cgs_vector* v)
 inline const void*
 cgs_vector_end(const struct cgs_vector* v)
 {
-	return v->data + v->length * v->element_size;
+	return cgs_vector_get(v, v->length);
 }
 
 /**
@@ -380,6 +530,92 @@ cgs_vector_remove(struct cgs_vector* v, size_t i);
 void
 cgs_vector_remove_fast(struct cgs_vector* v, size_t i);
 
+/**
+ * cgs_vector_extend
+ *
+ * Append the contents of an array to the end of the vector with a single
+ * copy. May invalidate existing pointers to elements.
+ *
+ * @param v     The vector.
+ * @param arr   A read-only pointer to the source array. Elements must be the
+ *              same size as those of the vector.
+ * @param len   The number of elements in the source array.
+ *
+ * @return      A pointer to the vector on success, NULL on failure.
+ */
+void*
+cgs_vector_extend(struct cgs_vector* v, const void* arr, size_t len);
+
+/**
+ * cgs_vector_extend_vec
+ *
+ * Append the contents of one vector to the end of another. May invalidate
+ * existing pointers to elements of 'dst'.
+ *
+ * @param dst   The vector to append to.
+ * @param src   The vector to append. Must not be 'dst'.
+ *
+ * @return      A pointer to 'dst' on success, NULL on failure or if the
+ *              element sizes differ.
+ */
+void*
+cgs_vector_extend_vec(struct cgs_vector* dst, const struct cgs_vector* src);
+
+/**
+ * cgs_vector_insert_range
+ *
+ * Insert the contents of an array at the given index of the vector. The
+ * elements at and after the index are moved once to make room. May
+ * invalidate existing pointers to elements.
+ *
+ * @param v     The vector.
+ * @param i     The index to insert at. Must not be greater than the length.
+ * @param arr   A read-only pointer to the source array. Must not point into
+ *              the vector itself.
+ * @param len   The number of elements to insert.
+ *
+ * @return      A pointer to the vector on success, NULL on failure.
+ */
+void*
+cgs_vector_insert_range(struct cgs_vector* v, size_t i, const void* arr,
+                size_t len);
+
+/**
+ * cgs_vector_remove_if
+ *
+ * Remove every element that satisfies the predicate. Preserves the order of
+ * the remaining elements and compacts them in a single pass. Removed
+ * elements are overwritten, not freed.
+ *
+ * @param v     The vector.
+ * @param pred  A predicate that will be passed an element and the optional
+ *              userdata parameter.
+ * @param data  A pointer to userdata that will be passed as the second
+ *              argument to the predicate.
+ *
+ * @return      The number of elements removed.
+ */
+size_t
+cgs_vector_remove_if(struct cgs_vector* v, CgsPredicate pred,
+                const void* data);
+
+/**
+ * cgs_vector_retain
+ *
+ * Keep only the elements that satisfy the predicate. The inverse of
+ * `cgs_vector_remove_if`.
+ *
+ * @param v     The vector.
+ * @param pred  A predicate that will be passed an element and the optional
+ *              userdata parameter.
+ * @param data  A pointer to userdata that will be passed as the second
+ *              argument to the predicate.
+ *
+ * @return      The number of elements removed.
+ */
+size_t
+cgs_vector_retain(struct cgs_vector* v, CgsPredicate pred, const void* data);
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * Array Standard Algorithms
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
@@ -439,6 +675,64 @@ cgs_vector_foreach(const struct cgs_vector* v, CgsUnaryOp f, void* data);
 void
 cgs_vector_transform(struct cgs_vector* v, CgsUnaryOpMut f, void* data);
 
+/**
+ * cgs_vector_foreach_parallel
+ *
+ * Like `cgs_vector_foreach` but the elements are split into chunks that are
+ * processed by several threads. The order of the calls is unspecified.
+ *
+ * @param v     A read-only pointer to the vector.
+ * @param f     A function to perform taking an element, the current index,
+ *              and a pointer to userdata. Must be safe to call concurrently.
+ * @param data  The userdata, shared by all threads.
+ * @param opts  The thread count and chunk size or NULL for defaults.
+ */
+void
+cgs_vector_foreach_parallel(const struct cgs_vector* v, CgsUnaryOp f,
+                void* data, const struct cgs_parallel_opts* opts);
+
+/**
+ * cgs_vector_transform_parallel
+ *
+ * Like `cgs_vector_transform` but the elements are split into chunks that
+ * are processed by several threads. Each element is visited exactly once.
+ *
+ * @param v     A pointer to the vector.
+ * @param f     A function to perform taking an element, the current index,
+ *              and a pointer to userdata. Must be safe to call concurrently.
+ * @param data  The userdata, shared by all threads.
+ * @param opts  The thread count and chunk size or NULL for defaults.
+ */
+void
+cgs_vector_transform_parallel(struct cgs_vector* v, CgsUnaryOpMut f,
+                void* data, const struct cgs_parallel_opts* opts);
+
+/**
+ * cgs_vector_reduce_parallel
+ *
+ * Reduce the elements of a vector using several threads. Each thread folds
+ * its elements into a private copy of 'acc' with 'f', then the partial
+ * results are merged into 'acc' with 'combine'.
+ *
+ * Set 'ordered' in the options to get one partial result per chunk that is
+ * combined in index order, making the result reproducible.
+ *
+ * @param v             A read-only pointer to the vector.
+ * @param acc           The accumulator. Must hold the identity value of the
+ *                      reduction (e.g. 0 for a sum) and receives the result.
+ * @param acc_size      The size of the accumulator in bytes.
+ * @param f             Folds an element into an accumulator.
+ * @param combine       Merges a partial result into an accumulator.
+ * @param opts          The thread count, chunk size and ordering or NULL
+ *                      for defaults.
+ *
+ * @return      A pointer to 'acc' on success, NULL on allocation failure.
+ */
+void*
+cgs_vector_reduce_parallel(const struct cgs_vector* v, void* acc,
+                size_t acc_size, CgsReduceOp f, CgsCombineOp combine,
+                const struct cgs_parallel_opts* opts);
+
 /**
  * cgs_vector_min
  *
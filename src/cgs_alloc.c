@@ -0,0 +1,211 @@
+/* cgs_alloc.c
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_alloc.c
+ *
+ * This file contains the source code of the libcgs allocator interface.
+ *
+ * Huge mappings are over-allocated by one huge page and trimmed so that
+ * their start is huge-page aligned, which transparent huge pages need to
+ * back the whole range.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#include "cgs_alloc.h"
+
+#include <stdint.h>
+#include <sys/mman.h>
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define CGS_THREAD_LOCAL _Thread_local
+#else
+#define CGS_THREAD_LOCAL __thread
+#endif
+
+static CGS_THREAD_LOCAL const struct cgs_allocator* cgs_default_allocator;
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Default Allocator Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+const struct cgs_allocator*
+cgs_allocator_default(void)
+{
+        return cgs_default_allocator;
+}
+
+const struct cgs_allocator*
+cgs_allocator_set_default(const struct cgs_allocator* a)
+{
+        const struct cgs_allocator* prev = cgs_default_allocator;
+        cgs_default_allocator = a;
+        return prev;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Private Large Buffer Allocator Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+static void*
+cgs_aligned_alloc(void* ctx, size_t size)
+{
+        (void)ctx;
+        void* p = NULL;
+        if (posix_memalign(&p, CGS_ALLOC_ALIGN, size > 0 ? size : 1) != 0)
+                return NULL;
+        return p;
+}
+
+static void
+cgs_aligned_free(void* ctx, void* p, size_t size)
+{
+        (void)ctx;
+        (void)size;
+        free(p);
+}
+
+static size_t
+cgs_huge_round(size_t size)
+{
+        return (size + CGS_ALLOC_HUGE_PAGE - 1)
+                & ~(size_t)(CGS_ALLOC_HUGE_PAGE - 1);
+}
+
+/**
+ * cgs_huge_map
+ *
+ * Map whole huge pages, explicit ones if possible.
+ *
+ * @param size  The number of bytes needed.
+ *
+ * @return      A huge-page-aligned mapping or NULL on failure.
+ */
+static void*
+cgs_huge_map(size_t size)
+{
+        const size_t len = cgs_huge_round(size);
+        const int prot = PROT_READ | PROT_WRITE;
+        const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+#ifdef MAP_HUGETLB
+        void* p = mmap(NULL, len, prot, flags | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED)
+                return p;
+#endif
+
+        char* raw = mmap(NULL, len + CGS_ALLOC_HUGE_PAGE, prot, flags, -1, 0);
+        if (raw == MAP_FAILED)
+                return NULL;
+
+        uintptr_t addr = (uintptr_t)raw;
+        char* start = raw + (cgs_huge_round(addr) - addr);
+        size_t head = start - raw;
+        if (head > 0)
+                munmap(raw, head);
+        if (head < CGS_ALLOC_HUGE_PAGE)
+                munmap(start + len, CGS_ALLOC_HUGE_PAGE - head);
+
+#ifdef MADV_HUGEPAGE
+        madvise(start, len, MADV_HUGEPAGE);     // advisory, ignore failure
+#endif
+        return start;
+}
+
+static void*
+cgs_huge_alloc(void* ctx, size_t size)
+{
+        if (size < CGS_ALLOC_HUGE_PAGE)
+                return cgs_aligned_alloc(ctx, size);
+        return cgs_huge_map(size);
+}
+
+static void
+cgs_huge_free(void* ctx, void* p, size_t size)
+{
+        if (size < CGS_ALLOC_HUGE_PAGE)
+                cgs_aligned_free(ctx, p, size);
+        else if (p)
+                munmap(p, cgs_huge_round(size));
+}
+
+static void*
+cgs_huge_realloc(void* ctx, void* p, size_t old, size_t size)
+{
+        if (p && old >= CGS_ALLOC_HUGE_PAGE && size >= CGS_ALLOC_HUGE_PAGE
+                        && cgs_huge_round(old) == cgs_huge_round(size))
+                return p;
+
+        void* q = cgs_huge_alloc(ctx, size);
+        if (q && p) {
+                memcpy(q, p, old < size ? old : size);
+                cgs_huge_free(ctx, p, old);
+        }
+        return q;
+}
+
+static const struct cgs_allocator cgs_aligned_allocator = {
+        .alloc = cgs_aligned_alloc,
+        .realloc = NULL,
+        .free = cgs_aligned_free,
+        .ctx = NULL,
+};
+
+static const struct cgs_allocator cgs_huge_allocator = {
+        .alloc = cgs_huge_alloc,
+        .realloc = cgs_huge_realloc,
+        .free = cgs_huge_free,
+        .ctx = NULL,
+};
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Large Buffer Allocator Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+const struct cgs_allocator*
+cgs_allocator_aligned(void)
+{
+        return &cgs_aligned_allocator;
+}
+
+const struct cgs_allocator*
+cgs_allocator_huge(void)
+{
+        return &cgs_huge_allocator;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Allocation Inline Symbols
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+void*
+cgs_alloc(const struct cgs_allocator* a, size_t size);
+
+void*
+cgs_realloc(const struct cgs_allocator* a, void* p, size_t old, size_t size);
+
+void
+cgs_free(const struct cgs_allocator* a, void* p, size_t size);
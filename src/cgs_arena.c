@@ -0,0 +1,367 @@
+/* cgs_arena.c
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_arena.c
+ *
+ * This file contains the source code of the libcgs implementation of an
+ * arena allocator.
+ *
+ * The chunks form a singly-linked list. Everything up to 'current' is in
+ * use and everything after it is spare, so reset and rewind only have to
+ * move 'current' back and restore its offset.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#include "cgs_arena.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef CGS_ARENA_GUARD
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Private Arena Types and Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * struct cgs_arena_chunk
+ *
+ * The header of a chunk. The usable bytes follow at CGS_ARENA_HEADER.
+ *
+ * @member next         The next chunk.
+ * @member size         The number of usable bytes.
+ * @member used         The offset of the first free byte.
+ * @member mapped       The size of the mapping including the guard page, or
+ *                      zero if the chunk came from malloc.
+ */
+struct cgs_arena_chunk {
+        struct cgs_arena_chunk* next;
+        size_t size;
+        size_t used;
+        size_t mapped;
+};
+
+enum {
+        CGS_ARENA_HEADER = (sizeof(struct cgs_arena_chunk)
+                        + CGS_ARENA_ALIGN - 1) / CGS_ARENA_ALIGN
+                * CGS_ARENA_ALIGN,
+};
+
+static inline char*
+cgs_arena_chunk_data(struct cgs_arena_chunk* c)
+{
+        return (char*)c + CGS_ARENA_HEADER;
+}
+
+/**
+ * cgs_arena_chunk_new
+ *
+ * Allocate a chunk with at least 'size' usable bytes. Guarded chunks are
+ * rounded up to whole pages so that the guard page directly follows the
+ * last usable byte.
+ *
+ * @param size  The minimum number of usable bytes.
+ *
+ * @return      A pointer to the chunk or NULL on failure.
+ */
+static struct cgs_arena_chunk*
+cgs_arena_chunk_new(size_t size)
+{
+        struct cgs_arena_chunk* c = NULL;
+#ifdef CGS_ARENA_GUARD
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t total = (CGS_ARENA_HEADER + size + page - 1) / page * page;
+        char* p = mmap(NULL, total + page, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+                return NULL;
+        if (mprotect(p + total, page, PROT_NONE) != 0) {
+                munmap(p, total + page);
+                return NULL;
+        }
+
+        c = (struct cgs_arena_chunk*)p;
+        c->size = total - CGS_ARENA_HEADER;
+        c->mapped = total + page;
+#else
+        c = malloc(CGS_ARENA_HEADER + size);
+        if (!c)
+                return NULL;
+
+        c->size = size;
+        c->mapped = 0;
+#endif
+        c->next = NULL;
+        c->used = 0;
+        return c;
+}
+
+static void
+cgs_arena_chunk_free(struct cgs_arena_chunk* c)
+{
+#ifdef CGS_ARENA_GUARD
+        munmap(c, c->mapped);
+#else
+        free(c);
+#endif
+}
+
+/**
+ * cgs_arena_fit
+ *
+ * Find the offset an allocation would get in a chunk.
+ *
+ * @param c     The chunk.
+ * @param size  The size of the allocation.
+ * @param align The alignment of the allocation.
+ * @param off   A pointer to store the offset in.
+ *
+ * @return      Non-zero if the allocation fits.
+ */
+static int
+cgs_arena_fit(struct cgs_arena_chunk* c, size_t size, size_t align,
+                size_t* off)
+{
+        uintptr_t base = (uintptr_t)cgs_arena_chunk_data(c);
+        uintptr_t p = (base + c->used + align - 1) & ~(uintptr_t)(align - 1);
+        *off = (size_t)(p - base);
+        return *off <= c->size && size <= c->size - *off;
+}
+
+/**
+ * cgs_arena_advance
+ *
+ * Make the next spare chunk current, or insert a new chunk after the
+ * current one if there is no spare chunk big enough.
+ *
+ * @param a     The arena.
+ * @param size  The size of the allocation that did not fit.
+ * @param align The alignment of the allocation.
+ *
+ * @return      A pointer to the arena on success, NULL on failure.
+ */
+static void*
+cgs_arena_advance(struct cgs_arena* a, size_t size, size_t align)
+{
+        size_t need = size + align - 1;
+        struct cgs_arena_chunk* next = a->current ? a->current->next : NULL;
+
+        if (next && next->size >= need) {
+                next->used = 0;
+                a->current = next;
+                return a;
+        }
+
+        struct cgs_arena_chunk* c = cgs_arena_chunk_new(
+                        need > a->chunk_size ? need : a->chunk_size);
+        if (!c)
+                return NULL;
+
+        c->next = next;
+        if (a->current)
+                a->current->next = c;
+        else
+                a->first = c;
+        a->current = c;
+        return a;
+}
+
+static void*
+cgs_arena_hook_alloc(void* ctx, size_t size)
+{
+        return cgs_arena_alloc(ctx, size);
+}
+
+static void*
+cgs_arena_hook_realloc(void* ctx, void* p, size_t old, size_t size)
+{
+        return cgs_arena_realloc(ctx, p, old, size);
+}
+
+static void
+cgs_arena_hook_free(void* ctx, void* p, size_t size)
+{
+        (void)size;
+        struct cgs_arena* a = ctx;
+        if (p && p == a->last) {        // give back the latest allocation
+                a->current->used = (size_t)((char*)p
+                                - cgs_arena_chunk_data(a->current));
+                a->last = NULL;
+        }
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Arena Management Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+struct cgs_arena
+cgs_arena_new(size_t chunk_size)
+{
+        return (struct cgs_arena){
+                .first = NULL,
+                .current = NULL,
+                .chunk_size = chunk_size > 0
+                        ? chunk_size
+                        : CGS_ARENA_CHUNK_SIZE,
+                .last = NULL,
+                .allocator = {
+                        .alloc = cgs_arena_hook_alloc,
+                        .realloc = cgs_arena_hook_realloc,
+                        .free = cgs_arena_hook_free,
+                        .ctx = NULL,
+                },
+        };
+}
+
+void
+cgs_arena_free(struct cgs_arena* a)
+{
+        struct cgs_arena_chunk* c = a->first;
+        while (c) {
+                struct cgs_arena_chunk* next = c->next;
+                cgs_arena_chunk_free(c);
+                c = next;
+        }
+
+        a->first = NULL;
+        a->current = NULL;
+        a->last = NULL;
+}
+
+void
+cgs_arena_reset(struct cgs_arena* a)
+{
+        a->current = a->first;
+        if (a->current)
+                a->current->used = 0;
+        a->last = NULL;
+}
+
+struct cgs_arena_mark
+cgs_arena_mark(const struct cgs_arena* a)
+{
+        return (struct cgs_arena_mark){
+                .chunk = a->current,
+                .used = a->current ? a->current->used : 0,
+        };
+}
+
+void
+cgs_arena_rewind(struct cgs_arena* a, struct cgs_arena_mark m)
+{
+        if (!m.chunk) {
+                cgs_arena_reset(a);
+                return;
+        }
+
+        a->current = m.chunk;
+        a->current->used = m.used;
+        a->last = NULL;
+}
+
+struct cgs_arena_stats
+cgs_arena_stats(const struct cgs_arena* a)
+{
+        struct cgs_arena_stats st = { 0 };
+        int in_use = a->current != NULL;
+        for (struct cgs_arena_chunk* c = a->first; c; c = c->next) {
+                ++st.chunks;
+                st.reserved += c->size;
+                if (in_use) {
+                        ++st.chunks_used;
+                        st.used += c->used;
+                }
+                if (c == a->current)
+                        in_use = 0;
+        }
+        return st;
+}
+
+const struct cgs_allocator*
+cgs_arena_allocator(struct cgs_arena* a)
+{
+        a->allocator.ctx = a;
+        return &a->allocator;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Arena Allocation Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+void*
+cgs_arena_alloc_aligned(struct cgs_arena* a, size_t size, size_t align)
+{
+        size_t off = 0;
+        if (!a->current || !cgs_arena_fit(a->current, size, align, &off)) {
+                if (!cgs_arena_advance(a, size, align))
+                        return NULL;
+                cgs_arena_fit(a->current, size, align, &off);
+        }
+
+        char* p = cgs_arena_chunk_data(a->current) + off;
+        a->current->used = off + size;
+        a->last = p;
+        return p;
+}
+
+void*
+cgs_arena_alloc(struct cgs_arena* a, size_t size)
+{
+        return cgs_arena_alloc_aligned(a, size, CGS_ARENA_ALIGN);
+}
+
+void*
+cgs_arena_realloc(struct cgs_arena* a, void* p, size_t old, size_t size)
+{
+        if (p && p == a->last) {        // try to resize in place
+                size_t off = (size_t)((char*)p
+                                - cgs_arena_chunk_data(a->current));
+                if (size <= a->current->size - off) {
+                        a->current->used = off + size;
+                        return p;
+                }
+        }
+
+        void* q = cgs_arena_alloc(a, size);
+        if (q && p)
+                memcpy(q, p, old < size ? old : size);
+        return q;
+}
+
+char*
+cgs_arena_strdup(struct cgs_arena* a, const char* s)
+{
+        size_t len = strlen(s) + 1;
+        char* p = cgs_arena_alloc_aligned(a, len, 1);
+        if (p)
+                memcpy(p, s, len);
+        return p;
+}
@@ -26,6 +26,7 @@
 #include <string.h>
 
 #include "cgs_bst.h"
+#include "cgs_pool.h"
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * BST Node Private Types
@@ -53,9 +54,10 @@ struct cgs_bst_node {
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
 
 static struct cgs_bst_node*
-cgs_bst_node_new(const struct cgs_variant* data)
+cgs_bst_node_new(const struct cgs_allocator* a,
+                const struct cgs_variant* data)
 {
-        struct cgs_bst_node* node = malloc(sizeof(struct cgs_bst_node));
+        struct cgs_bst_node* node = cgs_alloc(a, sizeof(struct cgs_bst_node));
         if (!node)
                 return NULL;
 
@@ -68,15 +70,16 @@ cgs_bst_node_new(const struct cgs_variant* data)
 }
 
 static void
-cgs_bst_node_free(struct cgs_bst_node* node, CgsFreeFunc ff)
+cgs_bst_node_free(const struct cgs_allocator* a, struct cgs_bst_node* node,
+                CgsFreeFunc ff)
 {
         if (!node)
                 return;
 
-        cgs_bst_node_free(node->left, ff);
-        cgs_bst_node_free(node->right, ff);
+        cgs_bst_node_free(a, node->left, ff);
+        cgs_bst_node_free(a, node->right, ff);
         cgs_variant_free(&node->data, ff);
-        free(node);
+        cgs_free(a, node, sizeof(struct cgs_bst_node));
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
@@ -91,13 +94,37 @@ cgs_bst_new(CgsCmp3Way cmp, CgsFreeFunc ff)
                 .length = 0,
                 .cmp = cmp,
                 .ff = ff,
+                .alloc = cgs_allocator_default(),
         };
 }
 
 void
 cgs_bst_free(struct cgs_bst* tree)
 {
-        return cgs_bst_node_free(tree->root, tree->ff);
+        return cgs_bst_node_free(tree->alloc, tree->root, tree->ff);
+}
+
+void*
+cgs_bst_set_allocator(struct cgs_bst* tree, const struct cgs_allocator* a)
+{
+        if (tree->root)
+                return NULL;
+        tree->alloc = a;
+        return tree;
+}
+
+size_t
+cgs_bst_node_size(void)
+{
+        return sizeof(struct cgs_bst_node);
+}
+
+void*
+cgs_bst_use_pool(struct cgs_bst* tree, struct cgs_pool* pool)
+{
+        if (pool->block_size < sizeof(struct cgs_bst_node))
+                return NULL;
+        return cgs_bst_set_allocator(tree, cgs_pool_allocator(pool));
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
@@ -124,7 +151,7 @@ cgs_bst_insert(struct cgs_bst* tree, struct cgs_variant* data)
                         return tree;
         }
 
-        struct cgs_bst_node* node = cgs_bst_node_new(data);
+        struct cgs_bst_node* node = cgs_bst_node_new(tree->alloc, data);
         node->parent = parent;
         if (!parent)
                 tree->root = node;
@@ -172,3 +199,25 @@ cgs_bst_max(const struct cgs_bst* tree)
                 node = node->right;
         return node ? cgs_variant_get(&node->data) : NULL;
 }
+
+void
+cgs_bst_foreach(const struct cgs_bst* tree, CgsUnaryOp f, void* data)
+{
+        const struct cgs_bst_node* node = tree->root;
+        while (node && node->left)
+                node = node->left;
+
+        for (size_t i = 0; node; ++i) {
+                f(cgs_variant_get(&node->data), i, data);
+
+                if (node->right) {
+                        node = node->right;
+                        while (node->left)
+                                node = node->left;
+                        continue;
+                }
+                while (node->parent && node == node->parent->right)
+                        node = node->parent;
+                node = node->parent;
+        }
+}
@@ -23,6 +23,7 @@
  * SOFTWARE.
  */
 #include "cgs_compare.h"
+#include "cgs_string_utils.h"
 
 #include <string.h>
 
@@ -60,6 +61,14 @@ int cgs_str_cmp(const void* a, const void* b)
 	return strcmp(s1, s2);
 }
 
+int cgs_str_cmp_nocase(const void* a, const void* b)
+{
+	const char* s1 = *(const char**)a;
+	const char* s2 = *(const char**)b;
+
+	return cgs_strcasecmp(s1, s2);
+}
+
 int cgs_char_cmp(const void* a, const void* b)
 {
 	return *(char*)a - *(char*)b;
@@ -0,0 +1,401 @@
+/* cgs_deque.c
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_deque.c
+ *
+ * This file contains the source code of the libcgs implementation of a
+ * double-ended queue.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#include "cgs_deque.h"
+#include "cgs_vector.h"
+
+#include <string.h>
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Private Deque Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+enum { CGS_DEQUE_INITIAL_CAPACITY = 8 };
+
+/**
+ * cgs_deque_round_capacity
+ *
+ * Round a capacity up to the next power of two.
+ *
+ * @param n     The minimum capacity.
+ *
+ * @return      The smallest power of two not less than 'n', at least
+ *              CGS_DEQUE_INITIAL_CAPACITY.
+ */
+static size_t
+cgs_deque_round_capacity(size_t n)
+{
+        size_t cap = CGS_DEQUE_INITIAL_CAPACITY;
+        while (cap < n)
+                cap <<= 1;
+        return cap;
+}
+
+/**
+ * cgs_deque_offset
+ *
+ * Get the buffer offset of an element index.
+ *
+ * @param dq    The deque.
+ * @param i     The element index relative to the front.
+ *
+ * @return      The offset of the element in 'data', in elements.
+ */
+static inline size_t
+cgs_deque_offset(const struct cgs_deque* dq, size_t i)
+{
+        return (dq->head + i) & (dq->capacity - 1);
+}
+
+/**
+ * cgs_deque_alloc
+ *
+ * Move the deque into a new buffer, unrolling the ring so that the front
+ * element ends up at offset zero.
+ *
+ * @param dq    The deque.
+ * @param cap   The new capacity. Must be a power of two not less than the
+ *              length.
+ *
+ * @return      A pointer to the deque on success, NULL on failure.
+ */
+static void*
+cgs_deque_alloc(struct cgs_deque* dq, size_t cap)
+{
+        char* p = cgs_alloc(dq->alloc, cap * dq->element_size);
+        if (!p)
+                return NULL;
+
+        if (dq->length > 0) {
+                size_t first = CGS_MIN(dq->length, dq->capacity - dq->head);
+                memcpy(p, &dq->data[dq->head * dq->element_size],
+                                first * dq->element_size);
+                memcpy(&p[first * dq->element_size], dq->data,
+                                (dq->length - first) * dq->element_size);
+        }
+
+        cgs_free(dq->alloc, dq->data, dq->capacity * dq->element_size);
+        dq->data = p;
+        dq->capacity = cap;
+        dq->head = 0;
+        return dq;
+}
+
+/**
+ * cgs_deque_make_room
+ *
+ * Ensure there is room for 'n' more elements.
+ *
+ * @param dq    The deque.
+ * @param n     The number of elements about to be added.
+ *
+ * @return      A pointer to the deque on success, NULL on failure.
+ */
+static void*
+cgs_deque_make_room(struct cgs_deque* dq, size_t n)
+{
+        if (dq->length + n <= dq->capacity)
+                return dq;
+        return cgs_deque_alloc(dq, cgs_deque_round_capacity(dq->length + n));
+}
+
+/**
+ * cgs_deque_write
+ *
+ * Copy an array into the ring starting at element index 'i', wrapping
+ * around the end of the buffer.
+ *
+ * @param dq    The deque.
+ * @param i     The element index relative to the front.
+ * @param arr   The source array.
+ * @param n     The number of elements to copy.
+ */
+static void
+cgs_deque_write(struct cgs_deque* dq, size_t i, const void* arr, size_t n)
+{
+        size_t offset = cgs_deque_offset(dq, i);
+        size_t first = CGS_MIN(n, dq->capacity - offset);
+        const char* src = arr;
+
+        memcpy(&dq->data[offset * dq->element_size], src,
+                        first * dq->element_size);
+        memcpy(dq->data, &src[first * dq->element_size],
+                        (n - first) * dq->element_size);
+}
+
+/**
+ * cgs_deque_read
+ *
+ * Copy elements out of the ring starting at element index 'i', wrapping
+ * around the end of the buffer.
+ *
+ * @param dq    The deque.
+ * @param i     The element index relative to the front.
+ * @param arr   The destination array.
+ * @param n     The number of elements to copy.
+ */
+static void
+cgs_deque_read(const struct cgs_deque* dq, size_t i, void* arr, size_t n)
+{
+        size_t offset = cgs_deque_offset(dq, i);
+        size_t first = CGS_MIN(n, dq->capacity - offset);
+        char* dst = arr;
+
+        memcpy(dst, &dq->data[offset * dq->element_size],
+                        first * dq->element_size);
+        memcpy(&dst[first * dq->element_size], dq->data,
+                        (n - first) * dq->element_size);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Deque Management Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+struct cgs_deque
+cgs_deque_new(size_t size)
+{
+        return (struct cgs_deque){
+                .head = 0,
+                .length = 0,
+                .capacity = 0,
+                .element_size = size,
+                .data = NULL,
+                .alloc = cgs_allocator_default(),
+        };
+}
+
+void*
+cgs_deque_from_vector(struct cgs_vector* v, struct cgs_deque* dq)
+{
+        size_t len = cgs_vector_length(v);
+        size_t size = v->element_size;
+        size_t cap = cgs_deque_round_capacity(len);
+
+        char* p = NULL;
+        if (v->data) {                  // reuse the heap allocation
+                p = cgs_realloc(v->alloc, v->data, v->capacity * size,
+                                cap * size);
+                if (!p)
+                        return NULL;
+                v->data = NULL;         // the deque owns the block now
+                v->length = 0;
+                v->capacity = 0;
+        } else {
+                p = cgs_alloc(v->alloc, cap * size);
+                if (!p)
+                        return NULL;
+                memcpy(p, cgs_vector_data(v), len * size);
+                cgs_vector_clear(v);
+        }
+
+        dq->head = 0;
+        dq->length = len;
+        dq->capacity = cap;
+        dq->element_size = size;
+        dq->data = p;
+        dq->alloc = v->alloc;
+        return dq;
+}
+
+void
+cgs_deque_free(struct cgs_deque* dq)
+{
+        cgs_free(dq->alloc, dq->data, dq->capacity * dq->element_size);
+        dq->data = NULL;
+        dq->capacity = 0;
+        cgs_deque_clear(dq);
+}
+
+void*
+cgs_deque_reserve(struct cgs_deque* dq, size_t n)
+{
+        if (n <= dq->capacity)
+                return dq;
+        return cgs_deque_alloc(dq, cgs_deque_round_capacity(n));
+}
+
+void*
+cgs_deque_set_allocator(struct cgs_deque* dq, const struct cgs_allocator* a)
+{
+        if (dq->data)
+                return NULL;
+        dq->alloc = a;
+        return dq;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Deque Inline Symbols
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+size_t
+cgs_deque_length(const struct cgs_deque* dq);
+
+const void*
+cgs_deque_get(const struct cgs_deque* dq, size_t i);
+
+void*
+cgs_deque_get_mut(struct cgs_deque* dq, size_t i);
+
+const void*
+cgs_deque_front(const struct cgs_deque* dq);
+
+const void*
+cgs_deque_back(const struct cgs_deque* dq);
+
+void
+cgs_deque_clear(struct cgs_deque* dq);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Deque Standard Operations
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+void*
+cgs_deque_push_back(struct cgs_deque* dq, const void* src)
+{
+        if (!cgs_deque_make_room(dq, 1))
+                return NULL;
+
+        void* p = cgs_deque_get_mut(dq, dq->length++);
+        memcpy(p, src, dq->element_size);
+        return p;
+}
+
+void*
+cgs_deque_push_front(struct cgs_deque* dq, const void* src)
+{
+        if (!cgs_deque_make_room(dq, 1))
+                return NULL;
+
+        dq->head = (dq->head - 1) & (dq->capacity - 1);
+        ++dq->length;
+
+        void* p = cgs_deque_get_mut(dq, 0);
+        memcpy(p, src, dq->element_size);
+        return p;
+}
+
+void*
+cgs_deque_pop_back(struct cgs_deque* dq, void* p)
+{
+        if (dq->length == 0)
+                return NULL;
+
+        --dq->length;
+        if (p)
+                memcpy(p, cgs_deque_get(dq, dq->length), dq->element_size);
+        return dq;
+}
+
+void*
+cgs_deque_pop_front(struct cgs_deque* dq, void* p)
+{
+        if (dq->length == 0)
+                return NULL;
+
+        if (p)
+                memcpy(p, cgs_deque_get(dq, 0), dq->element_size);
+        dq->head = (dq->head + 1) & (dq->capacity - 1);
+        --dq->length;
+        return dq;
+}
+
+void*
+cgs_deque_push_back_n(struct cgs_deque* dq, const void* arr, size_t n)
+{
+        if (n == 0)
+                return dq;
+        if (!cgs_deque_make_room(dq, n))
+                return NULL;
+
+        cgs_deque_write(dq, dq->length, arr, n);
+        dq->length += n;
+        return dq;
+}
+
+void*
+cgs_deque_push_front_n(struct cgs_deque* dq, const void* arr, size_t n)
+{
+        if (n == 0)
+                return dq;
+        if (!cgs_deque_make_room(dq, n))
+                return NULL;
+
+        dq->head = (dq->head - n) & (dq->capacity - 1);
+        dq->length += n;
+        cgs_deque_write(dq, 0, arr, n);
+        return dq;
+}
+
+void*
+cgs_deque_pop_back_n(struct cgs_deque* dq, void* arr, size_t n)
+{
+        if (n > dq->length)
+                return NULL;
+
+        dq->length -= n;
+        if (arr && n > 0)
+                cgs_deque_read(dq, dq->length, arr, n);
+        return dq;
+}
+
+void*
+cgs_deque_pop_front_n(struct cgs_deque* dq, void* arr, size_t n)
+{
+        if (n > dq->length)
+                return NULL;
+        if (n == 0)
+                return dq;
+
+        if (arr)
+                cgs_deque_read(dq, 0, arr, n);
+        dq->head = cgs_deque_offset(dq, n);
+        dq->length -= n;
+        return dq;
+}
+
+void
+cgs_deque_foreach(const struct cgs_deque* dq, CgsUnaryOp f, void* data)
+{
+        if (dq->length == 0)
+                return;
+
+        size_t first = CGS_MIN(dq->length, dq->capacity - dq->head);
+        const char* p = &dq->data[dq->head * dq->element_size];
+        for (size_t i = 0; i < first; ++i, p += dq->element_size)
+                f(p, i, data);
+
+        p = dq->data;
+        for (size_t i = first; i < dq->length; ++i, p += dq->element_size)
+                f(p, i, data);
+}
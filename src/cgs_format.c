@@ -0,0 +1,526 @@
+/* cgs_format.c
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_format.c
+ *
+ * This file contains the source code of the libcgs number formatters.
+ *
+ * Doubles are converted with Florian Loitsch's Grisu3. The value and the
+ * two halfway points to its neighbours are scaled by a cached power of ten
+ * so that the digits fall out of the integer and fraction parts of a 64-bit
+ * fixed point number. Digits are generated until the remainder fits inside
+ * the rounding interval, and the last digit is then nudged towards the
+ * exact value. Because the scaled values are only approximations, Grisu3
+ * can tell when it cannot prove the result is the shortest and closest;
+ * those values take the slow path.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#include "cgs_format.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cgs_parse.h"
+
+enum cgs_format_constants {
+        CGS_FORMAT_MIN_TARGET_EXP = -60,  // scaled exponent range Grisu
+        CGS_FORMAT_MAX_TARGET_EXP = -32,  // needs for the digit loop
+        CGS_FORMAT_POWERS_OFFSET = 348,   // -(first cached power)
+        CGS_FORMAT_POWERS_STEP = 8,       // decimal exponents between them
+        CGS_FORMAT_MAX_DIGITS = 17,       // any double survives 17 digits
+        CGS_FORMAT_MIN_DIGITS = 15,       // any 15 digits survive a double
+        CGS_FORMAT_SCI_EXP = 17,          // "%.17g" goes scientific here
+};
+
+static const char cgs_format_digit_pairs[] =
+        "00010203040506070809101112131415161718192021222324252627282930"
+        "31323334353637383940414243444546474849505152535455565758596061"
+        "62636465666768697071727374757677787980818283848586878889909192"
+        "93949596979899";
+
+/**
+ * struct cgs_diy_fp
+ *
+ * An unsigned floating-point number with a 64-bit significand, f * 2^e.
+ */
+struct cgs_diy_fp {
+        uint64_t f;
+        int e;
+};
+
+/**
+ * cgs_format_powers
+ *
+ * Normalized, rounded powers of ten 10^k for every eighth k from -348 to
+ * 340, as f * 2^e.
+ */
+static const struct {
+        uint64_t f;
+        int16_t e;
+        int16_t k;
+} cgs_format_powers[] = {
+        { 0xfa8fd5a0081c0288, -1220, -348 },
+        { 0xbaaee17fa23ebf76, -1193, -340 },
+        { 0x8b16fb203055ac76, -1166, -332 },
+        { 0xcf42894a5dce35ea, -1140, -324 },
+        { 0x9a6bb0aa55653b2d, -1113, -316 },
+        { 0xe61acf033d1a45df, -1087, -308 },
+        { 0xab70fe17c79ac6ca, -1060, -300 },
+        { 0xff77b1fcbebcdc4f, -1034, -292 },
+        { 0xbe5691ef416bd60c, -1007, -284 },
+        { 0x8dd01fad907ffc3c,  -980, -276 },
+        { 0xd3515c2831559a83,  -954, -268 },
+        { 0x9d71ac8fada6c9b5,  -927, -260 },
+        { 0xea9c227723ee8bcb,  -901, -252 },
+        { 0xaecc49914078536d,  -874, -244 },
+        { 0x823c12795db6ce57,  -847, -236 },
+        { 0xc21094364dfb5637,  -821, -228 },
+        { 0x9096ea6f3848984f,  -794, -220 },
+        { 0xd77485cb25823ac7,  -768, -212 },
+        { 0xa086cfcd97bf97f4,  -741, -204 },
+        { 0xef340a98172aace5,  -715, -196 },
+        { 0xb23867fb2a35b28e,  -688, -188 },
+        { 0x84c8d4dfd2c63f3b,  -661, -180 },
+        { 0xc5dd44271ad3cdba,  -635, -172 },
+        { 0x936b9fcebb25c996,  -608, -164 },
+        { 0xdbac6c247d62a584,  -582, -156 },
+        { 0xa3ab66580d5fdaf6,  -555, -148 },
+        { 0xf3e2f893dec3f126,  -529, -140 },
+        { 0xb5b5ada8aaff80b8,  -502, -132 },
+        { 0x87625f056c7c4a8b,  -475, -124 },
+        { 0xc9bcff6034c13053,  -449, -116 },
+        { 0x964e858c91ba2655,  -422, -108 },
+        { 0xdff9772470297ebd,  -396, -100 },
+        { 0xa6dfbd9fb8e5b88f,  -369,  -92 },
+        { 0xf8a95fcf88747d94,  -343,  -84 },
+        { 0xb94470938fa89bcf,  -316,  -76 },
+        { 0x8a08f0f8bf0f156b,  -289,  -68 },
+        { 0xcdb02555653131b6,  -263,  -60 },
+        { 0x993fe2c6d07b7fac,  -236,  -52 },
+        { 0xe45c10c42a2b3b06,  -210,  -44 },
+        { 0xaa242499697392d3,  -183,  -36 },
+        { 0xfd87b5f28300ca0e,  -157,  -28 },
+        { 0xbce5086492111aeb,  -130,  -20 },
+        { 0x8cbccc096f5088cc,  -103,  -12 },
+        { 0xd1b71758e219652c,   -77,   -4 },
+        { 0x9c40000000000000,   -50,    4 },
+        { 0xe8d4a51000000000,   -24,   12 },
+        { 0xad78ebc5ac620000,     3,   20 },
+        { 0x813f3978f8940984,    30,   28 },
+        { 0xc097ce7bc90715b3,    56,   36 },
+        { 0x8f7e32ce7bea5c70,    83,   44 },
+        { 0xd5d238a4abe98068,   109,   52 },
+        { 0x9f4f2726179a2245,   136,   60 },
+        { 0xed63a231d4c4fb27,   162,   68 },
+        { 0xb0de65388cc8ada8,   189,   76 },
+        { 0x83c7088e1aab65db,   216,   84 },
+        { 0xc45d1df942711d9a,   242,   92 },
+        { 0x924d692ca61be758,   269,  100 },
+        { 0xda01ee641a708dea,   295,  108 },
+        { 0xa26da3999aef774a,   322,  116 },
+        { 0xf209787bb47d6b85,   348,  124 },
+        { 0xb454e4a179dd1877,   375,  132 },
+        { 0x865b86925b9bc5c2,   402,  140 },
+        { 0xc83553c5c8965d3d,   428,  148 },
+        { 0x952ab45cfa97a0b3,   455,  156 },
+        { 0xde469fbd99a05fe3,   481,  164 },
+        { 0xa59bc234db398c25,   508,  172 },
+        { 0xf6c69a72a3989f5c,   534,  180 },
+        { 0xb7dcbf5354e9bece,   561,  188 },
+        { 0x88fcf317f22241e2,   588,  196 },
+        { 0xcc20ce9bd35c78a5,   614,  204 },
+        { 0x98165af37b2153df,   641,  212 },
+        { 0xe2a0b5dc971f303a,   667,  220 },
+        { 0xa8d9d1535ce3b396,   694,  228 },
+        { 0xfb9b7cd9a4a7443c,   720,  236 },
+        { 0xbb764c4ca7a44410,   747,  244 },
+        { 0x8bab8eefb6409c1a,   774,  252 },
+        { 0xd01fef10a657842c,   800,  260 },
+        { 0x9b10a4e5e9913129,   827,  268 },
+        { 0xe7109bfba19c0c9d,   853,  276 },
+        { 0xac2820d9623bf429,   880,  284 },
+        { 0x80444b5e7aa7cf85,   907,  292 },
+        { 0xbf21e44003acdd2d,   933,  300 },
+        { 0x8e679c2f5e44ff8f,   960,  308 },
+        { 0xd433179d9c8cb841,   986,  316 },
+        { 0x9e19db92b4e31ba9,  1013,  324 },
+        { 0xeb96bf6ebadf77d9,  1039,  332 },
+        { 0xaf87023b9bf0ee6b,  1066,  340 },
+};
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Integer Formatting
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_format_count_digits
+ *
+ * Count the decimal digits of a value, four orders of magnitude per
+ * division.
+ */
+static size_t
+cgs_format_count_digits(uint64_t n)
+{
+        for (size_t count = 1; ; count += 4, n /= 10000) {
+                if (n < 10)
+                        return count;
+                if (n < 100)
+                        return count + 1;
+                if (n < 1000)
+                        return count + 2;
+                if (n < 10000)
+                        return count + 3;
+        }
+}
+
+size_t
+cgs_format_u64(char* buf, uint64_t n)
+{
+        size_t len = cgs_format_count_digits(n);
+        char* p = buf + len;
+        *p = '\0';
+
+        while (n >= 100) {
+                const char* pair = &cgs_format_digit_pairs[n % 100 * 2];
+                n /= 100;
+                *--p = pair[1];
+                *--p = pair[0];
+        }
+        if (n >= 10) {
+                const char* pair = &cgs_format_digit_pairs[n * 2];
+                *--p = pair[1];
+                *--p = pair[0];
+        } else {
+                *--p = '0' + (char)n;
+        }
+        return len;
+}
+
+size_t
+cgs_format_i64(char* buf, int64_t n)
+{
+        if (n >= 0)
+                return cgs_format_u64(buf, (uint64_t)n);
+
+        // negate in unsigned arithmetic so INT64_MIN does not overflow
+        *buf = '-';
+        return cgs_format_u64(buf + 1, 0 - (uint64_t)n) + 1;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Grisu3
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+static struct cgs_diy_fp
+cgs_diy_fp_normalize(struct cgs_diy_fp x)
+{
+        int shift = __builtin_clzll(x.f);
+        return (struct cgs_diy_fp){ x.f << shift, x.e - shift };
+}
+
+/**
+ * cgs_diy_fp_mul
+ *
+ * Multiply two numbers, keeping the rounded upper 64 bits of the product.
+ */
+static struct cgs_diy_fp
+cgs_diy_fp_mul(struct cgs_diy_fp x, struct cgs_diy_fp y)
+{
+        const uint64_t m32 = 0xffffffff;
+        uint64_t a = x.f >> 32, b = x.f & m32;
+        uint64_t c = y.f >> 32, d = y.f & m32;
+        uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+        uint64_t mid = (bd >> 32) + (ad & m32) + (bc & m32) + ((uint64_t)1 << 31);
+
+        return (struct cgs_diy_fp){
+                ac + (ad >> 32) + (bc >> 32) + (mid >> 32),
+                x.e + y.e + 64,
+        };
+}
+
+/**
+ * cgs_format_round_weed
+ *
+ * Move the last generated digit down towards the exact value while that
+ * stays inside the safe interval, then report whether the result is
+ * provably the closest shortest representation. The distances are in the
+ * scaled units of the digit loop, and 'unit' is their uncertainty.
+ */
+static int
+cgs_format_round_weed(char* digits, int len, uint64_t dist_high_w,
+                uint64_t unsafe, uint64_t rest, uint64_t ten_kappa,
+                uint64_t unit)
+{
+        uint64_t small = dist_high_w - unit;
+        uint64_t big = dist_high_w + unit;
+
+        while (rest < small && unsafe - rest >= ten_kappa &&
+                        (rest + ten_kappa < small ||
+                         small - rest >= rest + ten_kappa - small)) {
+                --digits[len - 1];
+                rest += ten_kappa;
+        }
+
+        // the next digit down might be closer too, so we cannot decide
+        if (rest < big && unsafe - rest >= ten_kappa &&
+                        (rest + ten_kappa < big ||
+                         big - rest > rest + ten_kappa - big))
+                return 0;
+
+        return 2 * unit <= rest && rest <= unsafe - 4 * unit;
+}
+
+/**
+ * cgs_format_digit_gen
+ *
+ * Generate the shortest digits of a scaled value 'w' that lie within the
+ * scaled boundaries 'low' and 'high'.
+ *
+ * @return      1 with the digits, their count and the power of ten of the
+ *              last digit on success, 0 if the result cannot be proven.
+ */
+static int
+cgs_format_digit_gen(struct cgs_diy_fp low, struct cgs_diy_fp w,
+                struct cgs_diy_fp high, char* digits, int* len, int* kappa)
+{
+        uint64_t unit = 1;
+        uint64_t too_low = low.f - unit;
+        uint64_t too_high = high.f + unit;
+        uint64_t unsafe = too_high - too_low;
+
+        const int shift = -w.e;
+        const uint64_t one = (uint64_t)1 << shift;
+        uint32_t integrals = (uint32_t)(too_high >> shift);
+        uint64_t fractionals = too_high & (one - 1);
+
+        uint32_t divisor = 1;
+        *kappa = 0;
+        if (integrals) {
+                for (*kappa = 1; divisor <= integrals / 10; ++*kappa)
+                        divisor *= 10;
+        }
+
+        *len = 0;
+        while (*kappa > 0) {
+                digits[(*len)++] = '0' + (char)(integrals / divisor);
+                integrals %= divisor;
+                --*kappa;
+
+                uint64_t rest = ((uint64_t)integrals << shift) + fractionals;
+                if (rest < unsafe)
+                        return cgs_format_round_weed(digits, *len,
+                                        too_high - w.f, unsafe, rest,
+                                        (uint64_t)divisor << shift, unit);
+                divisor /= 10;
+        }
+
+        for (;;) {
+                fractionals *= 10;
+                unit *= 10;
+                unsafe *= 10;
+                digits[(*len)++] = '0' + (char)(fractionals >> shift);
+                fractionals &= one - 1;
+                --*kappa;
+
+                if (fractionals < unsafe)
+                        return cgs_format_round_weed(digits, *len,
+                                        (too_high - w.f) * unit, unsafe,
+                                        fractionals, one, unit);
+        }
+}
+
+/**
+ * cgs_format_grisu3
+ *
+ * Find the shortest digits of a positive, finite double.
+ *
+ * @param d             The value.
+ * @param digits        Receives up to CGS_FORMAT_MAX_DIGITS digits.
+ * @param len           Receives the number of digits.
+ * @param exp           Receives the power of ten of the last digit.
+ *
+ * @return              1 on success, 0 if the slow path must be taken.
+ */
+static int
+cgs_format_grisu3(double d, char* digits, int* len, int* exp)
+{
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+
+        const uint64_t hidden = (uint64_t)1 << 52;
+        uint64_t frac = bits & (hidden - 1);
+        int biased = (int)(bits >> 52);
+        struct cgs_diy_fp v = biased ? (struct cgs_diy_fp){ frac | hidden,
+                                               biased - 1075 }
+                                     : (struct cgs_diy_fp){ frac, -1074 };
+
+        // the halfway points to the neighbouring doubles, where the one
+        // below is closer if 'v' is the smallest of its binade
+        struct cgs_diy_fp plus = cgs_diy_fp_normalize((struct cgs_diy_fp){
+                        (v.f << 1) + 1, v.e - 1 });
+        struct cgs_diy_fp minus = frac == 0 && biased > 1
+                        ? (struct cgs_diy_fp){ (v.f << 2) - 1, v.e - 2 }
+                        : (struct cgs_diy_fp){ (v.f << 1) - 1, v.e - 1 };
+        minus.f <<= minus.e - plus.e;
+        minus.e = plus.e;
+        struct cgs_diy_fp w = cgs_diy_fp_normalize(v);
+
+        // the cached power that brings the exponent into the target range
+        double t = (CGS_FORMAT_MIN_TARGET_EXP - (w.e + 64) + 63) *
+                        0.30102999566398114;
+        int k = (int)t;
+        if (t > k)
+                ++k;
+        int i = (CGS_FORMAT_POWERS_OFFSET + k - 1) / CGS_FORMAT_POWERS_STEP
+                        + 1;
+        struct cgs_diy_fp ten = { cgs_format_powers[i].f,
+                cgs_format_powers[i].e };
+
+        int kappa;
+        if (!cgs_format_digit_gen(cgs_diy_fp_mul(minus, ten),
+                                cgs_diy_fp_mul(w, ten),
+                                cgs_diy_fp_mul(plus, ten),
+                                digits, len, &kappa))
+                return 0;
+
+        *exp = kappa - cgs_format_powers[i].k;
+        return 1;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Double Formatting
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_format_layout
+ *
+ * Lay out a sign, digits with no trailing zeros and a scientific exponent
+ * 'x' the way "%.17g" would.
+ *
+ * @return      The number of characters written.
+ */
+static size_t
+cgs_format_layout(char* buf, int neg, const char* digits, int len, int x)
+{
+        char* p = buf;
+        if (neg)
+                *p++ = '-';
+
+        if (x < -4 || x >= CGS_FORMAT_SCI_EXP) {
+                *p++ = digits[0];
+                if (len > 1) {
+                        *p++ = '.';
+                        memcpy(p, &digits[1], len - 1);
+                        p += len - 1;
+                }
+                *p++ = 'e';
+                *p++ = x < 0 ? '-' : '+';
+                int ax = x < 0 ? -x : x;
+                if (ax < 10)
+                        *p++ = '0';
+                p += cgs_format_u64(p, (uint64_t)ax);
+        } else if (x < 0) {
+                *p++ = '0';
+                *p++ = '.';
+                memset(p, '0', -x - 1);
+                p += -x - 1;
+                memcpy(p, digits, len);
+                p += len;
+        } else if (len <= x + 1) {
+                memcpy(p, digits, len);
+                p += len;
+                memset(p, '0', x + 1 - len);
+                p += x + 1 - len;
+        } else {
+                memcpy(p, digits, x + 1);
+                p += x + 1;
+                *p++ = '.';
+                memcpy(p, &digits[x + 1], len - x - 1);
+                p += len - x - 1;
+        }
+
+        *p = '\0';
+        return p - buf;
+}
+
+/**
+ * cgs_format_slow
+ *
+ * Try 15, 16 and 17 significant digits, correctly rounded by snprintf, and
+ * lay out the first that reads back as 'd'.
+ */
+static size_t
+cgs_format_slow(char* buf, double d)
+{
+        char tmp[CGS_FORMAT_DOUBLE_SIZE + 8];
+        size_t n = 0;
+        for (int prec = CGS_FORMAT_MIN_DIGITS;
+                        prec <= CGS_FORMAT_MAX_DIGITS; ++prec) {
+                snprintf(tmp, sizeof(tmp), "%.*e", prec - 1, d);
+
+                // "[-]d.ddde[+-]xx" with whatever decimal point the locale
+                // uses, so only the digits and the exponent are taken
+                char digits[CGS_FORMAT_MAX_DIGITS];
+                const char* p = tmp + (*tmp == '-');
+                int len = 0;
+                for ( ; *p != 'e'; ++p)
+                        if ((unsigned char)(*p - '0') < 10)
+                                digits[len++] = *p;
+                int x = atoi(p + 1);
+                while (len > 1 && digits[len - 1] == '0')
+                        --len;
+
+                n = cgs_format_layout(buf, d < 0, digits, len, x);
+                double back;
+                if (cgs_parse_double(buf, n, &back) && back == d)
+                        break;
+        }
+        return n;
+}
+
+size_t
+cgs_format_double(char* buf, double d)
+{
+        if (isnan(d) || isinf(d))
+                return snprintf(buf, CGS_FORMAT_DOUBLE_SIZE, "%g", d);
+
+        int neg = signbit(d) != 0;
+        if (d == 0.0)
+                return cgs_format_layout(buf, neg, "0", 1, 0);
+
+        char digits[CGS_FORMAT_MAX_DIGITS + 1];
+        int len, exp;
+        if (!cgs_format_grisu3(neg ? -d : d, digits, &len, &exp))
+                return cgs_format_slow(buf, d);
+        for ( ; len > 1 && digits[len - 1] == '0'; --len)
+                ++exp;
+
+        return cgs_format_layout(buf, neg, digits, len, exp + len - 1);
+}
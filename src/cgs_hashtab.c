@@ -27,7 +27,6 @@
 #include "cgs_string_utils.h"
 #include "cgs_numeric.h"
 
-#include <stdlib.h>
 #include <string.h>
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
@@ -70,22 +69,26 @@ struct cgs_htab_bucket {
  *
  * Allocates a new bucket and key-string.
  * 
+ * @param a     The allocator of the table.
  * @param key   The string to use as a key.
  *
  * @return      A pointer to the newly allocated bucket on success or NULL
  *              on failure.
  */
 static struct cgs_htab_bucket*
-cgs_htab_bucket_new(const char* key)
+cgs_htab_bucket_new(const struct cgs_allocator* a, const char* key)
 {
-        struct cgs_htab_bucket* b = malloc(sizeof(struct cgs_htab_bucket));
+        struct cgs_htab_bucket* b = cgs_alloc(a, sizeof(*b));
         if (!b)
                 return NULL;
-        char* p = cgs_strdup(key);
+
+        size_t size = strlen(key) + 1;
+        char* p = cgs_alloc(a, size);
         if (!p) {
-                free(b);
+                cgs_free(a, b, sizeof(*b));
                 return NULL;
         }
+        memcpy(p, key, size);
         b->key = p;
         return b;
 }
@@ -96,20 +99,22 @@ cgs_htab_bucket_new(const char* key)
  * Frees the memory allocated to a bucket, its key and any memory allocated
  * to the variant value.
  *
+ * @param a     The allocator of the table.
  * @param b     The bucket to free.
+ * @param ff    The function to free the value with.
  */
 static void
-cgs_htab_bucket_free(void* p, CgsFreeFunc ff)
+cgs_htab_bucket_free(const struct cgs_allocator* a, void* p, CgsFreeFunc ff)
 {
         if (!p)
                 return;
 
         struct cgs_htab_bucket* b = p;
 
-        cgs_htab_bucket_free(b->next, ff);
+        cgs_htab_bucket_free(a, b->next, ff);
         cgs_variant_free(&b->value, ff);
-        free(b->key);
-        free(b);
+        cgs_free(a, b->key, strlen(b->key) + 1);
+        cgs_free(a, b, sizeof(*b));
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
@@ -143,7 +148,8 @@ init_null_buckets(struct cgs_htab_bucket** ppb, size_t size)
 static void*
 hashtab_build(struct cgs_hashtab* ht)
 {
-        struct cgs_htab_bucket** ppb = malloc(HTAB_INITIAL_ALLOC);
+        struct cgs_htab_bucket** ppb = cgs_alloc(ht->alloc,
+                        HTAB_INITIAL_ALLOC);
         if (!ppb)
                 return NULL;
 
@@ -180,7 +186,7 @@ hashtab_rehash(struct cgs_hashtab* ht, struct cgs_htab_bucket** new_htab,
                 }
         }
 
-        free(ht->table);
+        cgs_free(ht->alloc, ht->table, ht->size * HTAB_BUCKET_PSIZE);
         ht->table = new_htab;
         ht->size = new_size;
 }
@@ -209,7 +215,8 @@ hashtab_grow(struct cgs_hashtab* ht, size_t size)
                 return NULL;
 
         // Allocate new table
-        struct cgs_htab_bucket** ppb = malloc(new_size * HTAB_BUCKET_PSIZE);
+        struct cgs_htab_bucket** ppb = cgs_alloc(ht->alloc,
+                        new_size * HTAB_BUCKET_PSIZE);
         if (!ppb)
                 return NULL;
 
@@ -267,7 +274,7 @@ hashtab_add_bucket(struct cgs_hashtab* ht, const char* key, size_t hashval,
         if (size != ht->size)
                 hashval = ht->hash(key, ht->size);
 
-        struct cgs_htab_bucket* b = cgs_htab_bucket_new(key);
+        struct cgs_htab_bucket* b = cgs_htab_bucket_new(ht->alloc, key);
         if (!b)
                 return NULL;
         b->next = ht->table[hashval];
@@ -295,6 +302,7 @@ cgs_hashtab_new(CgsFreeFunc ff)
                 .cmp = cgs_str_cmp,
                 .size = 0,
                 .max_load = HTAB_DEFAULT_LOAD_FACTOR,
+                .alloc = cgs_allocator_default(),
         };
 }
 
@@ -304,9 +312,9 @@ cgs_hashtab_free(void* p)
         struct cgs_hashtab* ht = p;
 
         for (size_t i = 0; i < ht->size; ++i)
-                cgs_htab_bucket_free(ht->table[i], ht->ff);
+                cgs_htab_bucket_free(ht->alloc, ht->table[i], ht->ff);
 
-        free(ht->table);
+        cgs_free(ht->alloc, ht->table, ht->size * HTAB_BUCKET_PSIZE);
 }
 
 void*
@@ -315,6 +323,30 @@ cgs_hashtab_reserve(struct cgs_hashtab* ht, size_t size)
         return hashtab_grow(ht, size);
 }
 
+void*
+cgs_hashtab_set_allocator(struct cgs_hashtab* ht,
+                const struct cgs_allocator* a)
+{
+        if (ht->table)
+                return NULL;
+        ht->alloc = a;
+        return ht;
+}
+
+size_t
+cgs_hashtab_bucket_size(void)
+{
+        return sizeof(struct cgs_htab_bucket);
+}
+
+void*
+cgs_hashtab_use_pool(struct cgs_hashtab* ht, struct cgs_pool* pool)
+{
+        if (pool->block_size < sizeof(struct cgs_htab_bucket))
+                return NULL;
+        return cgs_hashtab_set_allocator(ht, cgs_pool_allocator(pool));
+}
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * Hash Table Inline Function Symbols
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
@@ -415,6 +447,8 @@ cgs_hashtab_remove(struct cgs_hashtab* h, const char* key)
                 parent = b;
                 b = b->next;
         }
+        if (!b)
+                return;
 
         if (parent)
                 parent->next = b->next;
@@ -422,7 +456,8 @@ cgs_hashtab_remove(struct cgs_hashtab* h, const char* key)
                 h->table[hashval] = b->next;
 
         --h->length;
-        cgs_htab_bucket_free(b, h->ff);
+        b->next = NULL;                 // free this bucket only
+        cgs_htab_bucket_free(h->alloc, b, h->ff);
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
@@ -487,3 +522,13 @@ cgs_hash_str(const void* key, size_t size)
                 h = STRING_HASH_MULTIPLIER * h + *s;
         return h % size;
 }
+
+size_t
+cgs_hash_str_nocase(const void* key, size_t size)
+{
+        size_t h = 0;
+        for (const char* s = key; *s; ++s)
+                h = STRING_HASH_MULTIPLIER * h +
+                        (char)cgs_ascii_tolower((unsigned char)*s);
+        return h % size;
+}
@@ -26,7 +26,6 @@
 #include "cgs_heap.h"
 #include "cgs_heap_private.h"
 
-#include <stdlib.h>     // malloc, free
 #include <string.h>     // memset, memcpy
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
@@ -118,14 +117,16 @@ void*
 cgs_heap_grow(struct cgs_heap* h)
 {
         size_t new_capacity = cgs_heap_new_capacity(h->capacity);
-        char* p = malloc((new_capacity + CGS_HEAP_SWAP) * h->size);
+        char* p = cgs_alloc(h->alloc,
+                        (new_capacity + CGS_HEAP_SWAP) * h->size);
         if (!p)
                 return NULL;
 
         if (h->data) {
                 h->data -= h->size;     // backup to catch old pocket
                 memcpy(p, h->data, h->size * (h->length + CGS_HEAP_SWAP));
-                free(h->data);
+                cgs_free(h->alloc, h->data,
+                                (h->capacity + CGS_HEAP_SWAP) * h->size);
         }
 
         p += h->size;                   // stash new swap pocket
@@ -147,6 +148,7 @@ cgs_heap_new(size_t size, CgsCmp3Way cmp)
                 .size = size,
                 .data = NULL,
                 .cmp = cmp,
+                .alloc = cgs_allocator_default(),
         };
 }
 
@@ -157,8 +159,20 @@ cgs_heap_free(void* ph)
         if (!heap || !heap->data)
                 return;
 
-        free(heap->data - heap->size);  // free -1 as well
+        cgs_free(heap->alloc, heap->data - heap->size,  // free -1 as well
+                        (heap->capacity + CGS_HEAP_SWAP) * heap->size);
+        const struct cgs_allocator* a = heap->alloc;
         memset(heap, 0, sizeof(struct cgs_heap));
+        heap->alloc = a;
+}
+
+void*
+cgs_heap_set_allocator(struct cgs_heap* h, const struct cgs_allocator* a)
+{
+        if (h->data)
+                return NULL;
+        h->alloc = a;
+        return h;
 }
 
 void*
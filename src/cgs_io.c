@@ -24,17 +24,33 @@
  */
 #include "cgs_io.h"
 #include "cgs_string_utils.h"
+#include "cgs_string_private.h"
 
+#include <errno.h>
+#include <fcntl.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+enum cgs_io_defaults {
+        CGS_IO_READ_CHUNK = 64 * 1024,
+};
 
 int
 cgs_io_getline(FILE* file, struct cgs_string* buff)
 {
 	int count = 0;
 
-	for (int c; (c = fgetc(file)) != EOF && c != '\n'; ++count)
-                if (!cgs_string_push(buff, c))
-                        return -1;
+        // one lock for the line rather than one per character
+        flockfile(file);
+	for (int c; (c = getc_unlocked(file)) != EOF && c != '\n'; ++count)
+                if (!cgs_string_push(buff, c)) {
+                        count = -1;
+                        break;
+                }
+        funlockfile(file);
 
 	return count;
 }
@@ -74,21 +90,262 @@ error_cleanup:
         return NULL;
 }
 
+/**
+ * cgs_io_read_into
+ *
+ * Read up to 'n' bytes from a file descriptor to the end of a string that
+ * has room for them, retrying short and interrupted reads.
+ *
+ * @return      The number of bytes read, fewer than 'n' only at the end of
+ *              the file, or -1 on failure.
+ */
+static ssize_t
+cgs_io_read_into(int fd, struct cgs_string* s, size_t n)
+{
+        char* p = cgs_string_data_mut(s) + s->length;
+        size_t total = 0;
+        while (total < n) {
+                ssize_t r = read(fd, p + total, n - total);
+                if (r < 0 && errno == EINTR)
+                        continue;
+                if (r < 0)
+                        return -1;
+                if (r == 0)
+                        break;
+                total += r;
+        }
+        s->length += total;
+        return total;
+}
+
 void*
 cgs_io_readfile(const char* fname, struct cgs_string* buff)
 {
-        FILE* file = fopen(fname, "r");
-        if (!file)
+        int fd = open(fname, O_RDONLY);
+        if (fd < 0)
                 return NULL;
 
-        for (int c; (c = fgetc(file)) != EOF; )
-                if (!cgs_string_push(buff, c))
-                        goto error_cleanup;
+        void* ret = buff;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+                // exact size, one read (Linux caps a read just short of
+                // 2 GiB so bigger files take a few)
+                size_t size = st.st_size;
+                size_t cap = buff->length + size + 1;
+                if (buff->capacity < cap && !cgs_string_alloc(buff, cap))
+                        ret = NULL;
+                else if (cgs_io_read_into(fd, buff, size) < 0)
+                        ret = NULL;
+        } else {
+                // pipes and files that report no size such as those in /proc
+                ssize_t n;
+                size_t room;
+                do {
+                        size_t want = buff->length + CGS_IO_READ_CHUNK;
+                        if (buff->capacity <= want &&
+                                        !cgs_string_grow_len(buff, want)) {
+                                ret = NULL;
+                                break;
+                        }
+                        room = buff->capacity - buff->length - 1;
+                        n = cgs_io_read_into(fd, buff, room);
+                        if (n < 0)
+                                ret = NULL;
+                } while (n > 0 && (size_t)n == room);
+        }
+
+        cgs_string_data_mut(buff)[buff->length] = '\0';
+        close(fd);
+        return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * File Mapping
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+// Inline symbol
+struct cgs_strsub
+cgs_io_mapping_strsub(const struct cgs_io_mapping* map);
+
+void*
+cgs_io_map(const char* fname, struct cgs_io_mapping* map)
+{
+        int fd = open(fname, O_RDONLY);
+        if (fd < 0)
+                return NULL;
+
+        struct stat st;
+        if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode))
+                goto error_cleanup;
+
+        if (st.st_size == 0) {                  // mmap rejects a length of 0
+                *map = (struct cgs_io_mapping){ .data = "", .length = 0 };
+                close(fd);
+                return map;
+        }
 
-        fclose(file);
-        return buff;
+        void* p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+                goto error_cleanup;
+        // only a hint, a failure still leaves a usable mapping
+        (void)madvise(p, st.st_size, MADV_SEQUENTIAL);
+
+        // the mapping holds its own reference to the file
+        close(fd);
+        *map = (struct cgs_io_mapping){ .data = p, .length = st.st_size };
+        return map;
 
 error_cleanup:
-        fclose(file);
+        close(fd);
         return NULL;
 }
+
+void
+cgs_io_unmap(struct cgs_io_mapping* map)
+{
+        if (map->length > 0)
+                munmap((void*)map->data, map->length);
+        map->data = NULL;
+        map->length = 0;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Buffered Reader
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+// Inline symbols
+void*
+cgs_reader_getline(struct cgs_reader* r, struct cgs_strsub* line);
+
+int
+cgs_reader_error(const struct cgs_reader* r);
+
+struct cgs_reader
+cgs_reader_new_fd(int fd)
+{
+        return (struct cgs_reader){
+                .buf = NULL,
+                .cap = 0,
+                .pos = 0,
+                .end = 0,
+                .fd = fd,
+                .file = NULL,
+                .eof = 0,
+                .err = 0,
+                .alloc = cgs_allocator_default(),
+        };
+}
+
+struct cgs_reader
+cgs_reader_new_file(FILE* file)
+{
+        struct cgs_reader r = cgs_reader_new_fd(-1);
+        r.file = file;
+        return r;
+}
+
+void
+cgs_reader_free(struct cgs_reader* r)
+{
+        cgs_free(r->alloc, r->buf, r->cap);
+        r->buf = NULL;
+        r->cap = 0;
+        r->pos = 0;
+        r->end = 0;
+}
+
+void*
+cgs_reader_set_allocator(struct cgs_reader* r, const struct cgs_allocator* a)
+{
+        if (r->buf)
+                return NULL;
+
+        r->alloc = a;
+        return r;
+}
+
+/**
+ * cgs_reader_fill
+ *
+ * Move the unread data to the front of the buffer, growing it if the unread
+ * data already fills it, and read once into the space after it.
+ *
+ * @return      The number of bytes read, 0 at the end of the input or -1 on
+ *              failure with 'err' set.
+ */
+static ssize_t
+cgs_reader_fill(struct cgs_reader* r)
+{
+        size_t unread = r->end - r->pos;
+        if (r->pos > 0) {
+                memmove(r->buf, &r->buf[r->pos], unread);
+                r->pos = 0;
+                r->end = unread;
+        }
+
+        if (r->end == r->cap) {
+                size_t cap = r->cap ? r->cap * 2 : CGS_READER_BUFFER_SIZE;
+                char* p = cgs_realloc(r->alloc, r->buf, r->cap, cap);
+                if (!p) {
+                        r->err = ENOMEM;
+                        return -1;
+                }
+                r->buf = p;
+                r->cap = cap;
+        }
+
+        ssize_t n;
+        if (r->file) {
+                n = fread(&r->buf[r->end], 1, r->cap - r->end, r->file);
+                if (n == 0 && ferror(r->file)) {
+                        r->err = errno ? errno : EIO;
+                        return -1;
+                }
+        } else {
+                do {
+                        n = read(r->fd, &r->buf[r->end], r->cap - r->end);
+                } while (n < 0 && errno == EINTR);
+                if (n < 0) {
+                        r->err = errno;
+                        return -1;
+                }
+        }
+
+        if (n == 0)
+                r->eof = 1;
+        r->end += n;
+        return n;
+}
+
+void*
+cgs_reader_getdelim(struct cgs_reader* r, int delim, struct cgs_strsub* line)
+{
+        // only the bytes read since the last search need searching
+        size_t scanned = r->pos;
+        while (1) {
+                const char* p = scanned < r->end
+                        ? memchr(&r->buf[scanned], delim, r->end - scanned)
+                        : NULL;
+                if (p) {
+                        size_t at = p - r->buf;
+                        *line = cgs_strsub_new(&r->buf[r->pos], at - r->pos);
+                        r->pos = at + 1;
+                        return r;
+                }
+
+                if (r->eof || r->err)
+                        break;
+
+                size_t offset = r->end - r->pos;
+                if (cgs_reader_fill(r) < 0)
+                        return NULL;
+                scanned = r->pos + offset;
+        }
+
+        if (r->pos == r->end)
+                return NULL;
+
+        *line = cgs_strsub_new(&r->buf[r->pos], r->end - r->pos);
+        r->pos = r->end;
+        return r;
+}
@@ -0,0 +1,398 @@
+/* cgs_multimatch.c
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_multimatch.c
+ *
+ * This file contains the source code of the libcgs multi-pattern matcher.
+ *
+ * Compilation builds the trie of the patterns in the transition table, then
+ * walks it breadth first to set each state's failure link and to replace
+ * every missing transition with the one its failure state takes. Scanning
+ * is then one table lookup per byte. Failure links are only needed while
+ * compiling; the dictionary links kept for scanning skip straight to the
+ * next suffix that ends a pattern.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#include "cgs_multimatch.h"
+
+#include <string.h>
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Private Multimatch Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_multimatch_release
+ *
+ * Deallocate the automaton, leaving the patterns.
+ *
+ * @param mm    The pattern set.
+ */
+static void
+cgs_multimatch_release(struct cgs_multimatch* mm)
+{
+        size_t n = cgs_multimatch_count(mm);
+
+        cgs_free(mm->alloc, mm->delta,
+                        mm->rows * mm->classes * sizeof(uint32_t));
+        cgs_free(mm->alloc, mm->out, mm->rows * sizeof(uint32_t));
+        cgs_free(mm->alloc, mm->dict, mm->rows * sizeof(uint32_t));
+        cgs_free(mm->alloc, mm->next, n * sizeof(uint32_t));
+
+        mm->states = 0;
+        mm->rows = 0;
+        mm->classes = 0;
+        mm->delta = NULL;
+        mm->out = NULL;
+        mm->dict = NULL;
+        mm->next = NULL;
+}
+
+/**
+ * cgs_multimatch_alloc
+ *
+ * Allocate zeroed tables for 'rows' states and 'n' patterns.
+ *
+ * @param mm    The pattern set with its columns counted.
+ * @param rows  The number of states to make room for.
+ * @param n     The number of patterns.
+ *
+ * @return      A pointer to the pattern set on success, NULL on failure.
+ */
+static void*
+cgs_multimatch_alloc(struct cgs_multimatch* mm, size_t rows, size_t n)
+{
+        const size_t row = mm->classes * sizeof(uint32_t);
+        mm->rows = rows;
+        mm->delta = cgs_alloc(mm->alloc, rows * row);
+        mm->out = cgs_alloc(mm->alloc, rows * sizeof(uint32_t));
+        mm->dict = cgs_alloc(mm->alloc, rows * sizeof(uint32_t));
+        mm->next = cgs_alloc(mm->alloc, n * sizeof(uint32_t));
+        if (!mm->delta || !mm->out || !mm->dict || (n > 0 && !mm->next)) {
+                cgs_multimatch_release(mm);
+                return NULL;
+        }
+
+        memset(mm->delta, 0, rows * row);
+        memset(mm->out, 0, rows * sizeof(uint32_t));
+        memset(mm->dict, 0, rows * sizeof(uint32_t));
+        return mm;
+}
+
+/**
+ * cgs_multimatch_shrink
+ *
+ * Move the tables into allocations sized for the states actually used. The
+ * worst case allocation is kept if that fails.
+ *
+ * @param mm    The compiled pattern set.
+ */
+static void
+cgs_multimatch_shrink(struct cgs_multimatch* mm)
+{
+        const size_t row = mm->classes * sizeof(uint32_t);
+        const size_t rows = mm->states;
+        if (rows == mm->rows)
+                return;
+
+        uint32_t* delta = cgs_alloc(mm->alloc, rows * row);
+        uint32_t* out = cgs_alloc(mm->alloc, rows * sizeof(uint32_t));
+        uint32_t* dict = cgs_alloc(mm->alloc, rows * sizeof(uint32_t));
+        if (!delta || !out || !dict) {
+                cgs_free(mm->alloc, delta, rows * row);
+                cgs_free(mm->alloc, out, rows * sizeof(uint32_t));
+                cgs_free(mm->alloc, dict, rows * sizeof(uint32_t));
+                return;
+        }
+
+        memcpy(delta, mm->delta, rows * row);
+        memcpy(out, mm->out, rows * sizeof(uint32_t));
+        memcpy(dict, mm->dict, rows * sizeof(uint32_t));
+        cgs_free(mm->alloc, mm->delta, mm->rows * row);
+        cgs_free(mm->alloc, mm->out, mm->rows * sizeof(uint32_t));
+        cgs_free(mm->alloc, mm->dict, mm->rows * sizeof(uint32_t));
+
+        mm->delta = delta;
+        mm->out = out;
+        mm->dict = dict;
+        mm->rows = rows;
+}
+
+/**
+ * cgs_multimatch_classify
+ *
+ * Give each byte that occurs in a pattern its own column, starting at 1.
+ * All other bytes share column 0.
+ *
+ * @param mm    The pattern set.
+ */
+static void
+cgs_multimatch_classify(struct cgs_multimatch* mm)
+{
+        const unsigned char* p = cgs_vector_data(&mm->bytes);
+        const size_t n = cgs_vector_length(&mm->bytes);
+
+        memset(mm->cls, 0, sizeof(mm->cls));
+        mm->classes = 1;
+        for (size_t i = 0; i < n; ++i)
+                if (mm->cls[p[i]] == 0)
+                        mm->cls[p[i]] = mm->classes++;
+}
+
+/**
+ * cgs_multimatch_build_trie
+ *
+ * Insert every pattern into the transition table. A zero entry means no
+ * edge since no edge leads back to the root.
+ *
+ * @param mm    The pattern set with its tables allocated for the worst case
+ *              of one state per pattern byte.
+ */
+static void
+cgs_multimatch_build_trie(struct cgs_multimatch* mm)
+{
+        const unsigned char* p = cgs_vector_data(&mm->bytes);
+        const size_t* len = cgs_vector_data(&mm->lengths);
+        const size_t n = cgs_multimatch_count(mm);
+
+        mm->states = 1;
+        for (size_t id = 0; id < n; ++id) {
+                uint32_t s = 0;
+                for (size_t i = 0; i < len[id]; ++i, ++p) {
+                        uint32_t* t = &mm->delta[s * mm->classes
+                                + mm->cls[*p]];
+                        if (*t == 0)
+                                *t = mm->states++;
+                        s = *t;
+                }
+                mm->next[id] = mm->out[s];
+                mm->out[s] = id + 1;
+        }
+}
+
+/**
+ * cgs_multimatch_link
+ *
+ * Walk the trie breadth first, completing the transition table and setting
+ * the dictionary links. A state's row is completed when it is dequeued, so
+ * the rows of its failure state, which is shallower, are already complete.
+ *
+ * @param mm    The pattern set with its trie built.
+ * @param fail  Scratch space for one failure link per state.
+ * @param queue Scratch space for one entry per state.
+ */
+static void
+cgs_multimatch_link(struct cgs_multimatch* mm, uint32_t* fail,
+                uint32_t* queue)
+{
+        const size_t k = mm->classes;
+        size_t head = 0;
+        size_t tail = 0;
+
+        fail[0] = 0;
+        mm->dict[0] = 0;
+        queue[tail++] = 0;
+
+        while (head < tail) {
+                uint32_t s = queue[head++];
+                uint32_t* row = &mm->delta[s * k];
+                const uint32_t* frow = &mm->delta[fail[s] * k];
+
+                for (size_t c = 0; c < k; ++c) {
+                        uint32_t t = row[c];
+                        if (t == 0) {                   // borrow the edge
+                                row[c] = s == 0 ? 0 : frow[c];
+                                continue;
+                        }
+
+                        uint32_t f = s == 0 ? 0 : frow[c];
+                        fail[t] = f;
+                        mm->dict[t] = mm->out[f] ? f : mm->dict[f];
+                        queue[tail++] = t;
+                }
+        }
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Multimatch Management Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+struct cgs_multimatch
+cgs_multimatch_new(void)
+{
+        return (struct cgs_multimatch){
+                .bytes = cgs_vector_new(sizeof(char)),
+                .lengths = cgs_vector_new(sizeof(size_t)),
+                .states = 0,
+                .rows = 0,
+                .classes = 0,
+                .cls = { 0 },
+                .delta = NULL,
+                .out = NULL,
+                .dict = NULL,
+                .next = NULL,
+                .alloc = cgs_allocator_default(),
+        };
+}
+
+void
+cgs_multimatch_free(struct cgs_multimatch* mm)
+{
+        cgs_multimatch_release(mm);
+        cgs_vector_free(&mm->bytes);
+        cgs_vector_free(&mm->lengths);
+}
+
+void*
+cgs_multimatch_add(struct cgs_multimatch* mm, const struct cgs_strsub* pat)
+{
+        if (pat->length == 0 || pat->length >= UINT32_MAX)
+                return NULL;
+
+        cgs_multimatch_release(mm);
+        size_t len = cgs_vector_length(&mm->bytes);
+        if (!cgs_vector_extend(&mm->bytes, pat->data, pat->length))
+                return NULL;
+        if (!cgs_vector_push(&mm->lengths, &pat->length)) {
+                cgs_vector_resize(&mm->bytes, len);
+                return NULL;
+        }
+        return mm;
+}
+
+void*
+cgs_multimatch_compile(struct cgs_multimatch* mm)
+{
+        cgs_multimatch_release(mm);
+        cgs_multimatch_classify(mm);
+
+        const size_t n = cgs_multimatch_count(mm);
+        const size_t max = cgs_vector_length(&mm->bytes) + 1;
+        if (max > UINT32_MAX || !cgs_multimatch_alloc(mm, max, n))
+                return NULL;
+
+        uint32_t* scratch = cgs_alloc(mm->alloc, 2 * max * sizeof(uint32_t));
+        if (!scratch) {
+                cgs_multimatch_release(mm);
+                return NULL;
+        }
+
+        cgs_multimatch_build_trie(mm);
+        cgs_multimatch_link(mm, scratch, scratch + max);
+        cgs_free(mm->alloc, scratch, 2 * max * sizeof(uint32_t));
+
+        cgs_multimatch_shrink(mm);
+        return mm;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Multimatch Inline Symbols
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+size_t
+cgs_multimatch_count(const struct cgs_multimatch* mm);
+
+size_t
+cgs_multimatch_scan_string(const struct cgs_multimatch* mm,
+                const struct cgs_string* s, CgsUnaryOp f, void* data);
+
+void*
+cgs_multimatch_find_all_string(const struct cgs_multimatch* mm,
+                const struct cgs_string* s, struct cgs_vector* vec);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Multimatch Standard Operations
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+size_t
+cgs_multimatch_scan(const struct cgs_multimatch* mm,
+                const struct cgs_strsub* text, CgsUnaryOp f, void* data)
+{
+        if (mm->states == 0)
+                return 0;
+
+        const unsigned char* p = (const unsigned char*)text->data;
+        const size_t* len = cgs_vector_data(&mm->lengths);
+        const size_t k = mm->classes;
+        size_t count = 0;
+        uint32_t s = 0;
+
+        for (size_t i = 0; i < text->length; ++i) {
+                s = mm->delta[s * k + mm->cls[p[i]]];
+
+                uint32_t d = mm->out[s] ? s : mm->dict[s];
+                for ( ; d != 0; d = mm->dict[d]) {
+                        for (uint32_t id = mm->out[d]; id; ) {
+                                struct cgs_multimatch_hit hit = {
+                                        .id = id - 1,
+                                        .offset = i + 1 - len[id - 1],
+                                };
+                                f(&hit, count++, data);
+                                id = mm->next[id - 1];
+                        }
+                }
+        }
+        return count;
+}
+
+/**
+ * struct cgs_multimatch_collect_ctx
+ *
+ * @member vec          The vector to push hits onto.
+ * @member failed       Set once a push has failed.
+ */
+struct cgs_multimatch_collect_ctx {
+        struct cgs_vector* vec;
+        int failed;
+};
+
+/**
+ * cgs_multimatch_collect
+ *
+ * Scan callback that pushes each hit onto a vector.
+ */
+static void
+cgs_multimatch_collect(const void* hit, size_t i, void* data)
+{
+        (void)i;
+        struct cgs_multimatch_collect_ctx* ctx = data;
+        if (!ctx->failed && !cgs_vector_push(ctx->vec, hit))
+                ctx->failed = 1;
+}
+
+void*
+cgs_multimatch_find_all(const struct cgs_multimatch* mm,
+                const struct cgs_strsub* text, struct cgs_vector* vec)
+{
+        if (vec->element_size != sizeof(struct cgs_multimatch_hit))
+                return NULL;
+
+        struct cgs_multimatch_collect_ctx ctx = { .vec = vec, .failed = 0 };
+        cgs_multimatch_scan(mm, text, cgs_multimatch_collect, &ctx);
+        return ctx.failed ? NULL : vec;
+}
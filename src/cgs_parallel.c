@@ -0,0 +1,168 @@
+/* cgs_parallel.c
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_parallel.c
+ *
+ * This file contains the source code of the libcgs data-parallel helpers.
+ *
+ * Workers are started for each call rather than kept in a global pool so the
+ * library holds no threads between calls. The GCC/Clang '__atomic' builtins
+ * hand out the chunks since the library targets C99.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#include "cgs_parallel.h"
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Private Parallel Types and Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * struct cgs_parallel_job
+ *
+ * The state shared by the workers of a single `cgs_parallel_for` call.
+ *
+ * @member n            The length of the range.
+ * @member chunk        The number of indices per chunk.
+ * @member next         The first index of the next unclaimed chunk.
+ * @member f            The work function.
+ * @member data         The userdata.
+ */
+struct cgs_parallel_job {
+        size_t n;
+        size_t chunk;
+        size_t next;
+        CgsRangeOp f;
+        void* data;
+};
+
+/**
+ * struct cgs_parallel_worker
+ *
+ * @member job          The shared job.
+ * @member id           The index of this worker.
+ * @member thread       The thread running this worker.
+ */
+struct cgs_parallel_worker {
+        struct cgs_parallel_job* job;
+        size_t id;
+        pthread_t thread;
+};
+
+static void
+cgs_parallel_run(struct cgs_parallel_job* job, size_t id)
+{
+        for ( ; ; ) {
+                size_t begin = __atomic_fetch_add(&job->next, job->chunk,
+                                __ATOMIC_RELAXED);
+                if (begin >= job->n)
+                        break;
+                size_t end = job->n - begin < job->chunk
+                        ? job->n
+                        : begin + job->chunk;
+                job->f(begin, end, id, job->data);
+        }
+}
+
+static void*
+cgs_parallel_thread(void* arg)
+{
+        struct cgs_parallel_worker* w = arg;
+        cgs_parallel_run(w->job, w->id);
+        return NULL;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Parallel Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+size_t
+cgs_parallel_threads(const struct cgs_parallel_opts* opts)
+{
+        if (opts && opts->threads > 0)
+                return opts->threads;
+
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        return n > 0 ? (size_t)n : 1;
+}
+
+size_t
+cgs_parallel_chunk(size_t n, size_t size, size_t threads,
+                const struct cgs_parallel_opts* opts)
+{
+        if (opts && opts->chunk > 0)
+                return opts->chunk;
+
+        size_t line = size > 0 && size < CGS_PARALLEL_CACHE_LINE
+                ? CGS_PARALLEL_CACHE_LINE / size
+                : 1;
+        size_t chunk = n / (threads * CGS_PARALLEL_CHUNKS_PER_THREAD);
+        chunk = (chunk + line - 1) / line * line;
+        return CGS_MAX(chunk, line);
+}
+
+void
+cgs_parallel_for(size_t n, size_t chunk, size_t threads, CgsRangeOp f,
+                void* data)
+{
+        struct cgs_parallel_job job = {
+                .n = n,
+                .chunk = chunk > 0 ? chunk : 1,
+                .next = 0,
+                .f = f,
+                .data = data,
+        };
+
+        size_t chunks = (n + job.chunk - 1) / job.chunk;
+        threads = CGS_MIN(threads, chunks);
+
+        struct cgs_parallel_worker* workers = NULL;
+        if (threads > 1)
+                workers = malloc((threads - 1) * sizeof(*workers));
+
+        size_t started = 0;
+        for (size_t i = 0; workers && i < threads - 1; ++i) {
+                workers[i] = (struct cgs_parallel_worker){
+                        .job = &job,
+                        .id = i + 1,
+                };
+                if (pthread_create(&workers[i].thread, NULL,
+                                        cgs_parallel_thread, &workers[i]))
+                        break;
+                ++started;
+        }
+
+        cgs_parallel_run(&job, 0);
+
+        for (size_t i = 0; i < started; ++i)
+                pthread_join(workers[i].thread, NULL);
+        free(workers);
+}
@@ -0,0 +1,440 @@
+/* cgs_parse.c
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_parse.c
+ *
+ * This file contains the source code of the libcgs number parsers.
+ *
+ * Runs of eight decimal digits are validated and converted in a single
+ * 64-bit word: three multiplies combine digit pairs, then pairs of pairs,
+ * then the two halves. Nineteen decimal digits always fit in 64 bits, so
+ * only a twentieth needs an overflow check.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#define _GNU_SOURCE             // strtod_l
+
+#include "cgs_parse.h"
+
+#include <float.h>
+#include <locale.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cgs_alloc.h"
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define CGS_PARSE_SWAR
+#endif
+
+enum cgs_parse_constants {
+        CGS_PARSE_U64_DIGITS = 19,      // decimal digits that always fit
+        CGS_PARSE_HEX_DIGITS = 16,
+        CGS_PARSE_EXACT_POW10 = 22,     // largest power of ten a double holds
+        CGS_PARSE_EXP_LIMIT = 100000,   // past any finite or non-zero double
+        CGS_PARSE_BUFSIZE = 64,
+};
+
+static const double cgs_parse_pow10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10,
+        1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21,
+        1e22,
+};
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Private Parse Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+static inline int
+cgs_parse_isdigit(char c)
+{
+        return (unsigned char)(c - '0') < 10;
+}
+
+static inline int
+cgs_parse_xdigit(char c)
+{
+        unsigned char d = c - '0';
+        if (d < 10)
+                return d;
+        d = (c | 0x20) - 'a';
+        return d < 6 ? d + 10 : -1;
+}
+
+static const char*
+cgs_parse_skip_space(const char* p, const char* end)
+{
+        while (p < end && (*p == ' ' || (unsigned char)(*p - '\t') < 5))
+                ++p;
+        return p;
+}
+
+#ifdef CGS_PARSE_SWAR
+/**
+ * cgs_parse_load8
+ *
+ * Load eight bytes as a little-endian word and report whether they are all
+ * decimal digits. Adding 6 carries a byte past 0x3f exactly when it was
+ * above '9', so both halves of the test are one mask each.
+ */
+static inline int
+cgs_parse_load8(const char* p, uint64_t* word)
+{
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        *word = v;
+        return (((v & 0xf0f0f0f0f0f0f0f0) |
+                (((v + 0x0606060606060606) & 0xf0f0f0f0f0f0f0f0) >> 4)) ==
+                0x3333333333333333);
+}
+
+/**
+ * cgs_parse_eight
+ *
+ * Convert eight digit characters loaded by cgs_parse_load8 to their value.
+ */
+static inline uint32_t
+cgs_parse_eight(uint64_t v)
+{
+        v = (v & 0x0f0f0f0f0f0f0f0f) * 2561 >> 8;
+        v = (v & 0x00ff00ff00ff00ff) * 6553601 >> 16;
+        return (uint32_t)((v & 0x0000ffff0000ffff) * 42949672960001 >> 32);
+}
+#endif
+
+static const char*
+cgs_parse_dec(const char* p, const char* end, uint64_t* out)
+{
+        const char* start = p;
+        while (p < end && *p == '0')
+                ++p;
+
+        const char* sig = p;
+        uint64_t v = 0;
+#ifdef CGS_PARSE_SWAR
+        for (uint64_t w; end - p >= 8 &&
+                        p - sig <= CGS_PARSE_U64_DIGITS - 8 &&
+                        cgs_parse_load8(p, &w); p += 8)
+                v = v * 100000000 + cgs_parse_eight(w);
+#endif
+        for ( ; p < end && cgs_parse_isdigit(*p); ++p) {
+                unsigned d = *p - '0';
+                if (p - sig >= CGS_PARSE_U64_DIGITS &&
+                                v > (UINT64_MAX - d) / 10)
+                        return NULL;
+                v = v * 10 + d;
+        }
+        if (p == start)
+                return NULL;
+
+        *out = v;
+        return p;
+}
+
+static const char*
+cgs_parse_hex(const char* p, const char* end, uint64_t* out)
+{
+        const char* start = p;
+        while (p < end && *p == '0')
+                ++p;
+
+        const char* sig = p;
+        uint64_t v = 0;
+        for (int d; p < end && (d = cgs_parse_xdigit(*p)) >= 0; ++p) {
+                if (p - sig >= CGS_PARSE_HEX_DIGITS)
+                        return NULL;
+                v = v << 4 | (unsigned)d;
+        }
+        if (p == start)
+                return NULL;
+
+        *out = v;
+        return p;
+}
+
+/**
+ * cgs_parse_magnitude
+ *
+ * Parse the optional sign and the digits of an integer.
+ *
+ * @return      A pointer past the number or NULL on failure.
+ */
+static const char*
+cgs_parse_magnitude(const char* s, size_t n, int base, int* neg,
+                uint64_t* out)
+{
+        const char* end = s + n;
+        const char* p = cgs_parse_skip_space(s, end);
+
+        *neg = 0;
+        if (p < end && (*p == '+' || *p == '-'))
+                *neg = *p++ == '-';
+
+        if ((base == 0 || base == 16) && end - p > 2 && p[0] == '0' &&
+                        (p[1] | 0x20) == 'x' && cgs_parse_xdigit(p[2]) >= 0)
+                return cgs_parse_hex(p + 2, end, out);
+        if (base == 16)
+                return cgs_parse_hex(p, end, out);
+        if (base == 0 || base == 10)
+                return cgs_parse_dec(p, end, out);
+        return NULL;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Integer Parsing
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+const char*
+cgs_parse_u64(const char* s, size_t n, int base, uint64_t* out)
+{
+        uint64_t v;
+        int neg;
+        const char* p = cgs_parse_magnitude(s, n, base, &neg, &v);
+        if (!p || (neg && v != 0))
+                return NULL;
+
+        *out = v;
+        return p;
+}
+
+const char*
+cgs_parse_i64(const char* s, size_t n, int base, int64_t* out)
+{
+        uint64_t v;
+        int neg;
+        const char* p = cgs_parse_magnitude(s, n, base, &neg, &v);
+        if (!p || v > (uint64_t)INT64_MAX + neg)
+                return NULL;
+
+        *out = neg && v ? -(int64_t)(v - 1) - 1 : (int64_t)v;
+        return p;
+}
+
+const char*
+cgs_parse_i32(const char* s, size_t n, int base, int32_t* out)
+{
+        uint64_t v;
+        int neg;
+        const char* p = cgs_parse_magnitude(s, n, base, &neg, &v);
+        if (!p || v > (uint64_t)INT32_MAX + neg)
+                return NULL;
+
+        *out = neg ? (int32_t)-(int64_t)v : (int32_t)v;
+        return p;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Floating-Point Parsing
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_parse_fast
+ *
+ * Clinger's fast path. When the significand and the power of ten are both
+ * exact doubles, one correctly rounded operation gives the correctly
+ * rounded result. A power of ten past 1e22 can still be handled if moving
+ * the excess into the significand keeps it exact.
+ *
+ * @return      1 with the value in 'out' on success, 0 if the fast path
+ *              does not apply.
+ */
+static int
+cgs_parse_fast(uint64_t m, long e10, double* out)
+{
+#if FLT_EVAL_METHOD == 0
+        const uint64_t max = (uint64_t)1 << DBL_MANT_DIG;
+        if (m > max)
+                return 0;
+
+        for ( ; e10 > CGS_PARSE_EXACT_POW10; --e10) {
+                if (m > max / 10)
+                        return 0;
+                m *= 10;
+        }
+        if (e10 < -CGS_PARSE_EXACT_POW10)
+                return 0;
+
+        double d = (double)m;
+        *out = e10 < 0 ? d / cgs_parse_pow10[-e10] : d * cgs_parse_pow10[e10];
+        return 1;
+#else
+        // excess precision would round twice
+        (void)m;
+        (void)e10;
+        (void)out;
+        return 0;
+#endif
+}
+
+static locale_t cgs_parse_c_locale;
+static pthread_once_t cgs_parse_c_locale_once = PTHREAD_ONCE_INIT;
+
+static void
+cgs_parse_c_locale_init(void)
+{
+        cgs_parse_c_locale = newlocale(LC_ALL_MASK, "C", (locale_t)0);
+}
+
+/**
+ * cgs_parse_strtod
+ *
+ * strtod in the "C" locale, whatever LC_NUMERIC the program has set. Falls
+ * back to plain strtod only if the locale object could not be created.
+ */
+static double
+cgs_parse_strtod(const char* s)
+{
+        pthread_once(&cgs_parse_c_locale_once, cgs_parse_c_locale_init);
+        if (cgs_parse_c_locale)
+                return strtod_l(s, NULL, cgs_parse_c_locale);
+        return strtod(s, NULL);
+}
+
+/**
+ * cgs_parse_slow
+ *
+ * Hand an already validated number to strtod, which needs it terminated.
+ */
+static double
+cgs_parse_slow(const char* s, size_t len)
+{
+        char buf[CGS_PARSE_BUFSIZE];
+        const struct cgs_allocator* a = cgs_allocator_default();
+        char* p = len < sizeof(buf) ? buf : cgs_alloc(a, len + 1);
+        if (!p)
+                return cgs_parse_strtod(s);
+
+        memcpy(p, s, len);
+        p[len] = '\0';
+        double d = cgs_parse_strtod(p);
+        if (p != buf)
+                cgs_free(a, p, len + 1);
+        return d;
+}
+
+const char*
+cgs_parse_double(const char* s, size_t n, double* out)
+{
+        const char* end = s + n;
+        const char* p = cgs_parse_skip_space(s, end);
+
+        int neg = 0;
+        if (p < end && (*p == '+' || *p == '-'))
+                neg = *p++ == '-';
+
+        // up to 19 significant digits go into 'm', later ones only move
+        // the exponent, and 'inexact' notes if any of them was non-zero
+        uint64_t m = 0;
+        long e10 = 0;
+        int digits = 0;
+        int inexact = 0;
+        const char* first = p;
+
+        while (p < end && *p == '0')
+                ++p;
+#ifdef CGS_PARSE_SWAR
+        for (uint64_t w; end - p >= 8 && digits <= CGS_PARSE_U64_DIGITS - 8
+                        && cgs_parse_load8(p, &w); p += 8, digits += 8)
+                m = m * 100000000 + cgs_parse_eight(w);
+#endif
+        for ( ; p < end && cgs_parse_isdigit(*p); ++p, ++digits) {
+                if (digits < CGS_PARSE_U64_DIGITS) {
+                        m = m * 10 + (unsigned)(*p - '0');
+                } else {
+                        ++e10;
+                        inexact |= *p != '0';
+                }
+        }
+        int whole = p != first;
+
+        int frac = 0;
+        if (p < end && *p == '.') {
+                const char* q = p + 1;
+                if (digits == 0)
+                        for ( ; q < end && *q == '0'; ++q)
+                                --e10;
+#ifdef CGS_PARSE_SWAR
+                for (uint64_t w; end - q >= 8 &&
+                                digits <= CGS_PARSE_U64_DIGITS - 8 &&
+                                cgs_parse_load8(q, &w);
+                                q += 8, digits += 8, e10 -= 8)
+                        m = m * 100000000 + cgs_parse_eight(w);
+#endif
+                for ( ; q < end && cgs_parse_isdigit(*q); ++q, ++digits) {
+                        if (digits < CGS_PARSE_U64_DIGITS) {
+                                m = m * 10 + (unsigned)(*q - '0');
+                                --e10;
+                        } else {
+                                inexact |= *q != '0';
+                        }
+                }
+                frac = q != p + 1;
+                if (whole || frac)
+                        p = q;
+        }
+        if (!whole && !frac)
+                return NULL;
+
+        if (p < end && (*p == 'e' || *p == 'E')) {
+                const char* q = p + 1;
+                int eneg = 0;
+                if (q < end && (*q == '+' || *q == '-'))
+                        eneg = *q++ == '-';
+                if (q < end && cgs_parse_isdigit(*q)) {
+                        long x = 0;
+                        for ( ; q < end && cgs_parse_isdigit(*q); ++q)
+                                if (x < CGS_PARSE_EXP_LIMIT)
+                                        x = x * 10 + (*q - '0');
+                        e10 += eneg ? -x : x;
+                        p = q;
+                }
+        }
+
+        double d = 0.0;
+        if ((m != 0 || inexact) && (inexact || !cgs_parse_fast(m, e10, &d)))
+                d = cgs_parse_slow(first, (size_t)(p - first));
+
+        *out = neg ? -d : d;
+        return p;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Strsub Parsing Inline Symbols
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+const char*
+cgs_strsub_parse_u64(const struct cgs_strsub* ss, int base, uint64_t* out);
+
+const char*
+cgs_strsub_parse_i64(const struct cgs_strsub* ss, int base, int64_t* out);
+
+const char*
+cgs_strsub_parse_i32(const struct cgs_strsub* ss, int base, int32_t* out);
+
+const char*
+cgs_strsub_parse_double(const struct cgs_strsub* ss, double* out);
@@ -0,0 +1,204 @@
+/* cgs_pool.c
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_pool.c
+ *
+ * This file contains the source code of the libcgs implementation of a
+ * fixed-size object pool.
+ *
+ * A slab starts with one cache line holding the link to the previous slab,
+ * followed by its blocks. Free blocks store the free-list link in their
+ * first bytes.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#include "cgs_pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Private Pool Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_pool_add_slab
+ *
+ * Allocate a slab and thread its blocks onto the free list in address
+ * order.
+ *
+ * @param pool  The pool.
+ *
+ * @return      A pointer to the pool on success, NULL on failure.
+ */
+static void*
+cgs_pool_add_slab(struct cgs_pool* pool)
+{
+        void* mem = NULL;
+        size_t bytes = CGS_POOL_SLAB_ALIGN
+                + pool->slab_blocks * pool->block_size;
+        if (posix_memalign(&mem, CGS_POOL_SLAB_ALIGN, bytes) != 0)
+                return NULL;
+
+        char* slab = mem;
+        *(void**)slab = pool->slabs;
+        pool->slabs = slab;
+
+        char* blocks = slab + CGS_POOL_SLAB_ALIGN;
+        void* next = pool->free_list;
+        for (size_t i = pool->slab_blocks; i-- > 0; ) {
+                char* b = &blocks[i * pool->block_size];
+                *(void**)b = next;
+                next = b;
+        }
+        pool->free_list = next;
+        return pool;
+}
+
+static void*
+cgs_pool_hook_alloc(void* ctx, size_t size)
+{
+        struct cgs_pool* pool = ctx;
+        return size <= pool->block_size ? cgs_pool_alloc(pool) : malloc(size);
+}
+
+static void
+cgs_pool_hook_free(void* ctx, void* p, size_t size)
+{
+        struct cgs_pool* pool = ctx;
+        if (size <= pool->block_size)
+                cgs_pool_release(pool, p);
+        else
+                free(p);
+}
+
+static void*
+cgs_pool_hook_realloc(void* ctx, void* p, size_t old, size_t size)
+{
+        struct cgs_pool* pool = ctx;
+        if (old > pool->block_size && size > pool->block_size)
+                return realloc(p, size);
+        if (p && old <= pool->block_size && size <= pool->block_size)
+                return p;
+
+        void* q = cgs_pool_hook_alloc(ctx, size);
+        if (q && p) {
+                memcpy(q, p, old < size ? old : size);
+                cgs_pool_hook_free(ctx, p, old);
+        }
+        return q;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Pool Management Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+struct cgs_pool
+cgs_pool_new(size_t size, size_t slab_blocks)
+{
+        if (size < sizeof(void*))
+                size = sizeof(void*);
+
+        return (struct cgs_pool){
+                .block_size = (size + CGS_POOL_ALIGN - 1)
+                        / CGS_POOL_ALIGN * CGS_POOL_ALIGN,
+                .slab_blocks = slab_blocks > 0
+                        ? slab_blocks
+                        : CGS_POOL_SLAB_BLOCKS,
+                .free_list = NULL,
+                .slabs = NULL,
+                .in_use = 0,
+                .allocator = {
+                        .alloc = cgs_pool_hook_alloc,
+                        .realloc = cgs_pool_hook_realloc,
+                        .free = cgs_pool_hook_free,
+                        .ctx = NULL,
+                },
+        };
+}
+
+void
+cgs_pool_free(struct cgs_pool* pool)
+{
+        void* slab = pool->slabs;
+        while (slab) {
+                void* prev = *(void**)slab;
+                free(slab);
+                slab = prev;
+        }
+
+        pool->slabs = NULL;
+        pool->free_list = NULL;
+        pool->in_use = 0;
+}
+
+void*
+cgs_pool_reserve(struct cgs_pool* pool, size_t n)
+{
+        size_t avail = 0;
+        for (void* b = pool->free_list; b && avail < n; b = *(void**)b)
+                ++avail;
+
+        for ( ; avail < n; avail += pool->slab_blocks)
+                if (!cgs_pool_add_slab(pool))
+                        return NULL;
+        return pool;
+}
+
+const struct cgs_allocator*
+cgs_pool_allocator(struct cgs_pool* pool)
+{
+        pool->allocator.ctx = pool;
+        return &pool->allocator;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Pool Allocation Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+void*
+cgs_pool_alloc(struct cgs_pool* pool)
+{
+        if (!pool->free_list && !cgs_pool_add_slab(pool))
+                return NULL;
+
+        void* p = pool->free_list;
+        pool->free_list = *(void**)p;
+        ++pool->in_use;
+        return p;
+}
+
+void
+cgs_pool_release(struct cgs_pool* pool, void* p)
+{
+        if (!p)
+                return;
+
+        *(void**)p = pool->free_list;
+        pool->free_list = p;
+        --pool->in_use;
+}
@@ -39,15 +39,17 @@
 #include "cgs_rbt_private.h"
 #include "cgs_variant.h"
 #include "cgs_compare.h"
+#include "cgs_pool.h"
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * RBT Node Management Functions
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
 
 struct cgs_rbt_node*
-cgs_rbt_node_new(const struct cgs_variant* data)
+cgs_rbt_node_new(const struct cgs_allocator* a,
+                const struct cgs_variant* data)
 {
-        struct cgs_rbt_node* node = malloc(sizeof(struct cgs_rbt_node));
+        struct cgs_rbt_node* node = cgs_alloc(a, sizeof(struct cgs_rbt_node));
         if (!node)
                 return NULL;
 
@@ -61,13 +63,14 @@ cgs_rbt_node_new(const struct cgs_variant* data)
 }
 
 void
-cgs_rbt_node_free(struct cgs_rbt_node* node, CgsFreeFunc ff)
+cgs_rbt_node_free(const struct cgs_allocator* a, struct cgs_rbt_node* node,
+                CgsFreeFunc ff)
 {
         if (!node)
                 return;
 
-        cgs_rbt_node_free(node->left, ff);
-        cgs_rbt_node_free(node->right, ff);
+        cgs_rbt_node_free(a, node->left, ff);
+        cgs_rbt_node_free(a, node->right, ff);
         cgs_variant_free(&node->data, ff);
         if (node->parent) {
                 if (node == node->parent->left)
@@ -75,7 +78,7 @@ cgs_rbt_node_free(struct cgs_rbt_node* node, CgsFreeFunc ff)
                 else
                         node->parent->right = NULL;
         }
-        free(node);
+        cgs_free(a, node, sizeof(struct cgs_rbt_node));
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
@@ -234,6 +237,7 @@ cgs_rbt_new(CgsCmp3Way cmp, CgsFreeFunc ff)
                 .length = 0,
                 .cmp = cmp,
                 .ff = ff,
+                .alloc = cgs_allocator_default(),
         };
 }
 
@@ -241,7 +245,30 @@ void
 cgs_rbt_free(struct cgs_rbt* tree)
 {
 	if (tree)
-		cgs_rbt_node_free(tree->root, tree->ff);
+		cgs_rbt_node_free(tree->alloc, tree->root, tree->ff);
+}
+
+void*
+cgs_rbt_set_allocator(struct cgs_rbt* tree, const struct cgs_allocator* a)
+{
+        if (tree->root)
+                return NULL;
+        tree->alloc = a;
+        return tree;
+}
+
+size_t
+cgs_rbt_node_size(void)
+{
+        return sizeof(struct cgs_rbt_node);
+}
+
+void*
+cgs_rbt_use_pool(struct cgs_rbt* tree, struct cgs_pool* pool)
+{
+        if (pool->block_size < sizeof(struct cgs_rbt_node))
+                return NULL;
+        return cgs_rbt_set_allocator(tree, cgs_pool_allocator(pool));
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
@@ -258,7 +285,7 @@ cgs_rbt_length(const struct cgs_rbt* tree);
 const void*
 cgs_rbt_insert(struct cgs_rbt* tree, struct cgs_variant* data)
 {
-	struct cgs_rbt_node* node = cgs_rbt_node_new(data);
+	struct cgs_rbt_node* node = cgs_rbt_node_new(tree->alloc, data);
         if (!node)
                 return NULL;
 
@@ -326,6 +353,28 @@ cgs_rbt_max(const struct cgs_rbt* tree)
 	return node ? cgs_variant_get(&node->data) : NULL;
 }
 
+void
+cgs_rbt_foreach(const struct cgs_rbt* tree, CgsUnaryOp f, void* data)
+{
+	const struct cgs_rbt_node* node = tree->root;
+	while (node && node->left)
+		node = node->left;
+
+	for (size_t i = 0; node; ++i) {
+		f(cgs_variant_get(&node->data), i, data);
+
+		if (node->right) {
+			node = node->right;
+			while (node->left)
+				node = node->left;
+			continue;
+		}
+		while (node->parent && node == node->parent->right)
+			node = node->parent;
+		node = node->parent;
+	}
+}
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * RBT Diagnostic Functions
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
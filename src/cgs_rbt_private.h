@@ -69,12 +69,14 @@ struct cgs_rbt_node {
  * Create a new rb-tree node with the given data. Sets color to CGS_RBT_RED
  * and all pointers to NULL.
  *
+ * @param a	The allocator of the tree or NULL for the C library.
  * @param data	A variant with data of the appropriate type.
  *
  * @return	A pointer to a newly allocated node.
  */
 struct cgs_rbt_node*
-cgs_rbt_node_new(const struct cgs_variant* data);
+cgs_rbt_node_new(const struct cgs_allocator* a,
+                const struct cgs_variant* data);
 
 /**
  * cgs_rbt_free
@@ -82,10 +84,13 @@ cgs_rbt_node_new(const struct cgs_variant* data);
  * Frees the memory of a node. Will first free left, then right children and
  * then free the data. Set's parent's pointer to node to NULL.
  *
+ * @param a	The allocator the node was created with.
  * @param node	The node to free.
+ * @param ff	The function to free the data with or NULL.
  */
 void
-cgs_rbt_node_free(struct cgs_rbt_node* node, CgsFreeFunc ff);
+cgs_rbt_node_free(const struct cgs_allocator* a, struct cgs_rbt_node* node,
+                CgsFreeFunc ff);
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * RBT Inspection (Testing)
@@ -0,0 +1,618 @@
+/* cgs_rope.c
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_rope.c
+ *
+ * This file contains the source code of the libcgs rope.
+ *
+ * The chunks form a treap: an in-order walk gives the text, and each node
+ * has a random priority no greater than its parent's, which keeps the
+ * expected depth logarithmic. Each node also records the length of the text
+ * in its subtree, so a position is found by one descent. Edits split the
+ * tree at the edit positions and merge the pieces back together.
+ *
+ * No two neighbouring chunks would fit in one, so chunks are more than half
+ * full on average. Every seam an edit creates or every chunk it shrinks is
+ * checked and the chunks either side are coalesced when they fit.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#include "cgs_rope.h"
+#include "cgs_string_private.h"
+
+#include <string.h>
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Rope Node Private Types
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * struct cgs_rope_node
+ *
+ * A chunk of text and a treap node.
+ *
+ * @member left         The chunks before this one.
+ * @member right        The chunks after this one.
+ * @member size         The number of bytes of text in this subtree.
+ * @member priority     The heap key. No child's is greater.
+ * @member len          The number of bytes used in 'text'.
+ * @member text         The chunk.
+ */
+struct cgs_rope_node {
+        struct cgs_rope_node* left;
+        struct cgs_rope_node* right;
+        size_t size;
+        uint32_t priority;
+        uint32_t len;
+        char text[];
+};
+
+enum cgs_rope_constants {
+        CGS_ROPE_NODE_SIZE = 1024,
+        CGS_ROPE_CHUNK = CGS_ROPE_NODE_SIZE - sizeof(struct cgs_rope_node),
+        CGS_ROPE_SEED = 2463534242u,
+};
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Rope Node Management Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+static uint32_t
+cgs_rope_priority(struct cgs_rope* rope)
+{
+        // xorshift32
+        uint32_t x = rope->seed;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return rope->seed = x;
+}
+
+static struct cgs_rope_node*
+cgs_rope_node_new(struct cgs_rope* rope)
+{
+        struct cgs_rope_node* node = cgs_alloc(rope->alloc,
+                        CGS_ROPE_NODE_SIZE);
+        if (!node)
+                return NULL;
+
+        node->left = NULL;
+        node->right = NULL;
+        node->size = 0;
+        node->priority = cgs_rope_priority(rope);
+        node->len = 0;
+        return node;
+}
+
+static void
+cgs_rope_node_free(const struct cgs_allocator* a, struct cgs_rope_node* node)
+{
+        if (!node)
+                return;
+
+        cgs_rope_node_free(a, node->left);
+        cgs_rope_node_free(a, node->right);
+        cgs_free(a, node, CGS_ROPE_NODE_SIZE);
+}
+
+static inline size_t
+cgs_rope_node_size(const struct cgs_rope_node* node)
+{
+        return node ? node->size : 0;
+}
+
+static inline void
+cgs_rope_node_update(struct cgs_rope_node* node)
+{
+        node->size = cgs_rope_node_size(node->left) + node->len +
+                cgs_rope_node_size(node->right);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Treap Split and Merge
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_rope_merge
+ *
+ * Join two trees, all of whose text in 'a' comes before 'b'.
+ *
+ * @return      The root of the joined tree.
+ */
+static struct cgs_rope_node*
+cgs_rope_merge(struct cgs_rope_node* a, struct cgs_rope_node* b)
+{
+        if (!a)
+                return b;
+        if (!b)
+                return a;
+
+        if (a->priority >= b->priority) {
+                a->right = cgs_rope_merge(a->right, b);
+                cgs_rope_node_update(a);
+                return a;
+        }
+        b->left = cgs_rope_merge(a, b->left);
+        cgs_rope_node_update(b);
+        return b;
+}
+
+/**
+ * cgs_rope_split
+ *
+ * Split a tree into the text before 'pos' and the text from it on. If 'pos'
+ * falls inside a chunk, the tail of that chunk moves to 'spare', which is
+ * then used up.
+ *
+ * @param node  The root of the tree.
+ * @param pos   The split position, up to the size of the tree.
+ * @param l     Receives the tree before 'pos'.
+ * @param r     Receives the tree from 'pos' on.
+ * @param spare A free node, required if 'pos' may fall inside a chunk.
+ */
+static void
+cgs_rope_split(struct cgs_rope_node* node, size_t pos,
+                struct cgs_rope_node** l, struct cgs_rope_node** r,
+                struct cgs_rope_node** spare)
+{
+        if (!node) {
+                *l = *r = NULL;
+                return;
+        }
+
+        size_t left = cgs_rope_node_size(node->left);
+        if (pos <= left) {
+                cgs_rope_split(node->left, pos, l, &node->left, spare);
+                cgs_rope_node_update(node);
+                *r = node;
+        } else if (pos >= left + node->len) {
+                cgs_rope_split(node->right, pos - left - node->len,
+                                &node->right, r, spare);
+                cgs_rope_node_update(node);
+                *l = node;
+        } else {
+                // the tail takes this node's place above its right subtree
+                struct cgs_rope_node* tail = *spare;
+                *spare = NULL;
+
+                size_t off = pos - left;
+                tail->len = node->len - off;
+                memcpy(tail->text, &node->text[off], tail->len);
+                tail->priority = node->priority;
+                tail->left = NULL;
+                tail->right = node->right;
+                cgs_rope_node_update(tail);
+
+                node->len = off;
+                node->right = NULL;
+                cgs_rope_node_update(node);
+
+                *l = node;
+                *r = tail;
+        }
+}
+
+/**
+ * cgs_rope_unlink_first
+ *
+ * Take the first chunk out of a tree. Its right subtree takes its place.
+ *
+ * @return      The root of the remaining tree.
+ */
+static struct cgs_rope_node*
+cgs_rope_unlink_first(struct cgs_rope_node* node)
+{
+        if (!node->left)
+                return node->right;
+
+        node->left = cgs_rope_unlink_first(node->left);
+        cgs_rope_node_update(node);
+        return node;
+}
+
+/**
+ * cgs_rope_join
+ *
+ * Merge two trees like cgs_rope_merge, first moving the text of the first
+ * chunk of 'b' into the last chunk of 'a' if it fits.
+ *
+ * @return      The root of the joined tree.
+ */
+static struct cgs_rope_node*
+cgs_rope_join(struct cgs_rope* rope, struct cgs_rope_node* a,
+                struct cgs_rope_node* b)
+{
+        if (!a || !b)
+                return cgs_rope_merge(a, b);
+
+        struct cgs_rope_node* last = a;
+        while (last->right)
+                last = last->right;
+        struct cgs_rope_node* first = b;
+        while (first->left)
+                first = first->left;
+
+        if (last->len + first->len <= CGS_ROPE_CHUNK) {
+                memcpy(&last->text[last->len], first->text, first->len);
+                last->len += first->len;
+                for (struct cgs_rope_node* node = a; node; node = node->right)
+                        node->size += first->len;
+
+                b = cgs_rope_unlink_first(b);
+                cgs_free(rope->alloc, first, CGS_ROPE_NODE_SIZE);
+        }
+        return cgs_rope_merge(a, b);
+}
+
+/**
+ * cgs_rope_find
+ *
+ * Find the chunk holding a position. A position at the boundary of two
+ * chunks is found at the end of the first.
+ *
+ * @param node  The root of the tree.
+ * @param pos   The position, updated to the offset within the chunk.
+ *
+ * @return      The chunk.
+ */
+static struct cgs_rope_node*
+cgs_rope_find(struct cgs_rope_node* node, size_t* pos)
+{
+        for (;;) {
+                size_t left = cgs_rope_node_size(node->left);
+                if (*pos <= left && node->left) {
+                        node = node->left;
+                } else if (*pos > left + node->len) {
+                        *pos -= left + node->len;
+                        node = node->right;
+                } else {
+                        *pos -= left;
+                        return node;
+                }
+        }
+}
+
+/**
+ * cgs_rope_resize_path
+ *
+ * Add 'delta' to the size of every node from the root to the chunk found
+ * by cgs_rope_find for 'pos'.
+ */
+static void
+cgs_rope_resize_path(struct cgs_rope_node* node, size_t pos, size_t delta)
+{
+        for (;;) {
+                size_t left = cgs_rope_node_size(node->left);
+                node->size += delta;
+                if (pos <= left && node->left) {
+                        node = node->left;
+                } else if (pos > left + node->len) {
+                        pos -= left + node->len;
+                        node = node->right;
+                } else {
+                        return;
+                }
+        }
+}
+
+/**
+ * cgs_rope_tidy
+ *
+ * Coalesce the chunk found by cgs_rope_find for 'pos' with either neighbour
+ * it fits with. Checking costs two descents; the tree is only split and
+ * joined when there is something to coalesce.
+ */
+static void
+cgs_rope_tidy(struct cgs_rope* rope, size_t pos)
+{
+        size_t off = pos;
+        struct cgs_rope_node* node = cgs_rope_find(rope->root, &off);
+        size_t start = pos - off;
+        size_t end = start + node->len;
+
+        int fits = 0;
+        if (start > 0) {
+                size_t p = start;
+                fits |= cgs_rope_find(rope->root, &p)->len + node->len
+                        <= CGS_ROPE_CHUNK;
+        }
+        if (end < rope->length) {
+                size_t p = end + 1;
+                fits |= cgs_rope_find(rope->root, &p)->len + node->len
+                        <= CGS_ROPE_CHUNK;
+        }
+        if (!fits)
+                return;
+
+        // both splits fall on chunk boundaries, so no spare is needed
+        struct cgs_rope_node* none = NULL;
+        struct cgs_rope_node* l;
+        struct cgs_rope_node* mid;
+        struct cgs_rope_node* r;
+        cgs_rope_split(rope->root, start, &l, &r, &none);
+        cgs_rope_split(r, end - start, &mid, &r, &none);
+        rope->root = cgs_rope_join(rope, cgs_rope_join(rope, l, mid), r);
+}
+
+/**
+ * cgs_rope_build
+ *
+ * Build a tree of full chunks holding a text.
+ *
+ * @return      The root of the tree, or NULL on allocation failure or if
+ *              the text is empty.
+ */
+static struct cgs_rope_node*
+cgs_rope_build(struct cgs_rope* rope, const char* s, size_t n)
+{
+        struct cgs_rope_node* root = NULL;
+        for (size_t i = 0; i < n; i += CGS_ROPE_CHUNK) {
+                struct cgs_rope_node* node = cgs_rope_node_new(rope);
+                if (!node) {
+                        cgs_rope_node_free(rope->alloc, root);
+                        return NULL;
+                }
+
+                node->len = n - i < CGS_ROPE_CHUNK ? n - i : CGS_ROPE_CHUNK;
+                memcpy(node->text, &s[i], node->len);
+                cgs_rope_node_update(node);
+                root = cgs_rope_merge(root, node);
+        }
+        return root;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Rope Management Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+struct cgs_rope
+cgs_rope_new(void)
+{
+        return (struct cgs_rope){
+                .root = NULL,
+                .length = 0,
+                .seed = CGS_ROPE_SEED,
+                .alloc = cgs_allocator_default(),
+        };
+}
+
+void
+cgs_rope_free(struct cgs_rope* rope)
+{
+        cgs_rope_node_free(rope->alloc, rope->root);
+}
+
+void*
+cgs_rope_set_allocator(struct cgs_rope* rope, const struct cgs_allocator* a)
+{
+        if (rope->root)
+                return NULL;
+        rope->alloc = a;
+        return rope;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Rope Inline Symbols
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+size_t
+cgs_rope_length(const struct cgs_rope* rope);
+
+void*
+cgs_rope_append(struct cgs_rope* rope, const char* s, size_t n);
+
+void*
+cgs_rope_to_string(const struct cgs_rope* rope, struct cgs_string* dst);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Rope Editing
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_rope_splice
+ *
+ * Replace the range [pos, pos + count) with 's' by splitting the tree
+ * around it and joining the new chunks in. Every node the edit needs is
+ * allocated before the tree is touched, so the rope is unchanged on failure.
+ */
+static void*
+cgs_rope_splice(struct cgs_rope* rope, size_t pos, size_t count,
+                const char* s, size_t n)
+{
+        struct cgs_rope_node* mid = cgs_rope_build(rope, s, n);
+        struct cgs_rope_node* spare[2] = {
+                cgs_rope_node_new(rope),
+                count ? cgs_rope_node_new(rope) : NULL,
+        };
+        if ((n && !mid) || !spare[0] || (count && !spare[1])) {
+                cgs_rope_node_free(rope->alloc, mid);
+                cgs_free(rope->alloc, spare[0], CGS_ROPE_NODE_SIZE);
+                cgs_free(rope->alloc, spare[1], CGS_ROPE_NODE_SIZE);
+                return NULL;
+        }
+
+        struct cgs_rope_node* l;
+        struct cgs_rope_node* cut;
+        struct cgs_rope_node* r;
+        cgs_rope_split(rope->root, pos, &l, &r, &spare[0]);
+        cgs_rope_split(r, count, &cut, &r, &spare[1]);
+        rope->root = cgs_rope_join(rope, cgs_rope_join(rope, l, mid), r);
+        rope->length = rope->length - count + n;
+
+        // the splits may have left short chunks on either side
+        if (rope->root) {
+                cgs_rope_tidy(rope, pos);
+                if (pos + n < rope->length)
+                        cgs_rope_tidy(rope, pos + n + 1);
+        }
+
+        cgs_rope_node_free(rope->alloc, cut);
+        cgs_free(rope->alloc, spare[0], CGS_ROPE_NODE_SIZE);
+        cgs_free(rope->alloc, spare[1], CGS_ROPE_NODE_SIZE);
+        return rope;
+}
+
+void*
+cgs_rope_insert(struct cgs_rope* rope, size_t pos, const char* s, size_t n)
+{
+        return cgs_rope_replace(rope, pos, 0, s, n);
+}
+
+void*
+cgs_rope_erase(struct cgs_rope* rope, size_t pos, size_t count)
+{
+        return cgs_rope_replace(rope, pos, count, NULL, 0);
+}
+
+void*
+cgs_rope_replace(struct cgs_rope* rope, size_t pos, size_t count,
+                const char* s, size_t n)
+{
+        if (pos > rope->length)
+                return NULL;
+        if (count > rope->length - pos)
+                count = rope->length - pos;
+
+        // equal lengths overwrite in place, a chunk at a time
+        if (count == n) {
+                for (size_t i = 0; i < n; ) {
+                        size_t off = pos + i + 1;
+                        struct cgs_rope_node* node =
+                                cgs_rope_find(rope->root, &off);
+                        size_t k = node->len - --off;
+                        k = k < n - i ? k : n - i;
+                        memcpy(&node->text[off], &s[i], k);
+                        i += k;
+                }
+                return rope;
+        }
+
+        // a range inside one chunk is edited there if the chunk keeps some
+        // text and the result fits
+        if (rope->root) {
+                size_t off = pos;
+                struct cgs_rope_node* node = cgs_rope_find(rope->root, &off);
+                size_t len = node->len - count + n;
+                if (off + count <= node->len && len > 0
+                                && len <= CGS_ROPE_CHUNK) {
+                        memmove(&node->text[off + n],
+                                        &node->text[off + count],
+                                        node->len - off - count);
+                        if (n)
+                                memcpy(&node->text[off], s, n);
+                        node->len = len;
+                        cgs_rope_resize_path(rope->root, pos, n - count);
+                        rope->length = rope->length - count + n;
+                        if (count > n)
+                                cgs_rope_tidy(rope, pos);
+                        return rope;
+                }
+        }
+
+        return cgs_rope_splice(rope, pos, count, s, n);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Rope Access
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+char
+cgs_rope_get(const struct cgs_rope* rope, size_t pos)
+{
+        size_t off = pos + 1;
+        const struct cgs_rope_node* node = cgs_rope_find(rope->root, &off);
+        return node->text[off - 1];
+}
+
+/**
+ * cgs_rope_copy_range
+ *
+ * Copy the text of a subtree in the range [pos, pos + count) to 'dst'.
+ */
+static void
+cgs_rope_copy_range(const struct cgs_rope_node* node, size_t pos,
+                size_t count, char* dst)
+{
+        while (node && count) {
+                size_t left = cgs_rope_node_size(node->left);
+                if (pos < left) {
+                        size_t k = left - pos < count ? left - pos : count;
+                        cgs_rope_copy_range(node->left, pos, k, dst);
+                        dst += k;
+                        count -= k;
+                        pos = left;
+                }
+                if (count && pos < left + node->len) {
+                        size_t off = pos - left;
+                        size_t k = node->len - off < count ? node->len - off
+                                                           : count;
+                        memcpy(dst, &node->text[off], k);
+                        dst += k;
+                        count -= k;
+                        pos += k;
+                }
+                pos -= left + node->len;
+                node = node->right;
+        }
+}
+
+void*
+cgs_rope_substr(const struct cgs_rope* rope, size_t pos, size_t count,
+                struct cgs_string* dst)
+{
+        if (pos > rope->length)
+                return NULL;
+        if (count > rope->length - pos)
+                count = rope->length - pos;
+        if (dst->capacity < count + 1 && !cgs_string_alloc(dst, count + 1))
+                return NULL;
+
+        char* d = cgs_string_data_mut(dst);
+        cgs_rope_copy_range(rope->root, pos, count, d);
+        d[count] = '\0';
+        dst->length = count;
+        return dst;
+}
+
+static void
+cgs_rope_node_foreach(const struct cgs_rope_node* node, CgsUnaryOp f,
+                void* data, size_t* i)
+{
+        for ( ; node; node = node->right) {
+                cgs_rope_node_foreach(node->left, f, data, i);
+
+                struct cgs_strsub ss = cgs_strsub_new(node->text, node->len);
+                f(&ss, (*i)++, data);
+        }
+}
+
+void
+cgs_rope_foreach(const struct cgs_rope* rope, CgsUnaryOp f, void* data)
+{
+        size_t i = 0;
+        cgs_rope_node_foreach(rope->root, f, data, &i);
+}
@@ -0,0 +1,222 @@
+/* cgs_segvec.c
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_segvec.c
+ *
+ * This file contains the source code of the libcgs implementation of a
+ * segmented vector.
+ *
+ * Blocks are published with atomic compare-and-swap so that concurrent
+ * claims never leak or double-allocate a block. The GCC/Clang '__atomic'
+ * builtins are used since the library targets C99.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#include "cgs_segvec.h"
+
+#include <string.h>
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Private Segmented Vector Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_segvec_block_size
+ *
+ * Get the number of elements held by a block.
+ *
+ * @param b     The block index.
+ *
+ * @return      The capacity of the block in elements.
+ */
+static inline size_t
+cgs_segvec_block_size(size_t b)
+{
+        return (size_t)CGS_SEGVEC_FIRST_BLOCK << b;
+}
+
+/**
+ * cgs_segvec_alloc_block
+ *
+ * Ensure a block is allocated. If another thread publishes the block first
+ * the local allocation is discarded.
+ *
+ * @param sv    The segmented vector.
+ * @param b     The index of the block to allocate.
+ *
+ * @return      A pointer to the segmented vector on success, NULL on failure.
+ */
+static void*
+cgs_segvec_alloc_block(struct cgs_segvec* sv, size_t b)
+{
+        if (b >= CGS_SEGVEC_MAX_BLOCKS)
+                return NULL;
+        if (__atomic_load_n(&sv->blocks[b], __ATOMIC_ACQUIRE))
+                return sv;
+
+        size_t size = cgs_segvec_block_size(b) * sv->element_size;
+        char* p = cgs_alloc(sv->alloc, size);
+        if (!p)
+                return NULL;
+
+        char* expected = NULL;
+        if (!__atomic_compare_exchange_n(&sv->blocks[b], &expected, p, 0,
+                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                cgs_free(sv->alloc, p, size);   // lost the race
+        return sv;
+}
+
+/**
+ * cgs_segvec_alloc_range
+ *
+ * Ensure all blocks covering the elements [0:n) are allocated.
+ *
+ * @param sv    The segmented vector.
+ * @param n     The number of elements to cover.
+ *
+ * @return      A pointer to the segmented vector on success, NULL on failure.
+ */
+static void*
+cgs_segvec_alloc_range(struct cgs_segvec* sv, size_t n)
+{
+        if (n == 0)
+                return sv;
+
+        for (size_t b = 0, last = cgs_segvec_block_of(n - 1); b <= last; ++b)
+                if (!cgs_segvec_alloc_block(sv, b))
+                        return NULL;
+        return sv;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Segmented Vector Management Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+struct cgs_segvec
+cgs_segvec_new(size_t size)
+{
+        return (struct cgs_segvec){
+                .length = 0,
+                .element_size = size,
+                .blocks = { NULL },
+                .alloc = cgs_allocator_default(),
+        };
+}
+
+void
+cgs_segvec_free(struct cgs_segvec* sv)
+{
+        for (size_t b = 0; b < CGS_SEGVEC_MAX_BLOCKS; ++b) {
+                cgs_free(sv->alloc, sv->blocks[b],
+                                cgs_segvec_block_size(b) * sv->element_size);
+                sv->blocks[b] = NULL;
+        }
+        sv->length = 0;
+}
+
+void*
+cgs_segvec_reserve(struct cgs_segvec* sv, size_t n)
+{
+        return cgs_segvec_alloc_range(sv, n);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Segmented Vector Inline Symbols
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+size_t
+cgs_segvec_length(const struct cgs_segvec* sv);
+
+size_t
+cgs_segvec_block_of(size_t i);
+
+size_t
+cgs_segvec_block_start(size_t b);
+
+const void*
+cgs_segvec_get(const struct cgs_segvec* sv, size_t i);
+
+void*
+cgs_segvec_get_mut(struct cgs_segvec* sv, size_t i);
+
+void
+cgs_segvec_clear(struct cgs_segvec* sv);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Segmented Vector Standard Operations
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+void*
+cgs_segvec_push(struct cgs_segvec* sv, const void* src)
+{
+        if (!cgs_segvec_alloc_block(sv, cgs_segvec_block_of(sv->length)))
+                return NULL;
+
+        void* dst = cgs_segvec_get_mut(sv, sv->length);
+        memcpy(dst, src, sv->element_size);
+        ++sv->length;
+        return dst;
+}
+
+void*
+cgs_segvec_pop(struct cgs_segvec* sv, void* p)
+{
+        if (sv->length == 0)
+                return NULL;
+
+        --sv->length;
+        memcpy(p, cgs_segvec_get(sv, sv->length), sv->element_size);
+        return p;
+}
+
+void*
+cgs_segvec_claim(struct cgs_segvec* sv, size_t n, size_t* first)
+{
+        size_t len = __atomic_load_n(&sv->length, __ATOMIC_ACQUIRE);
+        do {
+                if (!cgs_segvec_alloc_range(sv, len + n))
+                        return NULL;
+        } while (!__atomic_compare_exchange_n(&sv->length, &len, len + n, 0,
+                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+        *first = len;
+        return sv;
+}
+
+void
+cgs_segvec_foreach(const struct cgs_segvec* sv, CgsUnaryOp f, void* data)
+{
+        const size_t sz = sv->element_size;
+
+        for (size_t b = 0, i = 0; i < sv->length; ++b) {
+                const char* p = sv->blocks[b];
+                const size_t end = CGS_MIN(sv->length,
+                                i + cgs_segvec_block_size(b));
+                for ( ; i < end; ++i, p += sz)
+                        f(p, i, data);
+        }
+}
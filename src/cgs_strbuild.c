@@ -0,0 +1,379 @@
+/* cgs_strbuild.c
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_strbuild.c
+ *
+ * This file contains the source code of the libcgs string builder.
+ *
+ * Chunks form a singly linked list with a pointer to the last one, which is
+ * the only one appended to. Each new chunk is twice the size of the one
+ * before it up to a ceiling, or larger if a single append needs it.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#include "cgs_strbuild.h"
+#include "cgs_string_private.h"
+
+#include <errno.h>
+#include <sys/uio.h>
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * String Builder Private Types
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * struct cgs_strbuild_chunk
+ *
+ * @member next         The chunk after this one or NULL.
+ * @member len          The number of bytes used in 'text'.
+ * @member cap          The number of bytes 'text' has room for.
+ * @member text         The chunk's text. Not null-terminated.
+ */
+struct cgs_strbuild_chunk {
+        struct cgs_strbuild_chunk* next;
+        size_t len;
+        size_t cap;
+        char text[];
+};
+
+enum cgs_strbuild_constants {
+        CGS_STRBUILD_FIRST_SIZE = 256,
+        CGS_STRBUILD_MAX_SIZE = 64 * 1024,
+        CGS_STRBUILD_IOV_BATCH = 16,            // the POSIX minimum IOV_MAX
+};
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * String Builder Inline Symbols
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+size_t
+cgs_strbuild_length(const struct cgs_strbuild* sb);
+
+void*
+cgs_strbuild_append_str(struct cgs_strbuild* sb, const char* s);
+
+void*
+cgs_strbuild_append_strsub(struct cgs_strbuild* sb,
+                const struct cgs_strsub* ss);
+
+void*
+cgs_strbuild_append_string(struct cgs_strbuild* sb, const struct cgs_string* s);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * String Builder Chunk Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+static inline size_t
+cgs_strbuild_chunk_size(const struct cgs_strbuild_chunk* c)
+{
+        return sizeof(struct cgs_strbuild_chunk) + c->cap;
+}
+
+/**
+ * cgs_strbuild_chunk_new
+ *
+ * Allocate a chunk with room for at least 'need' bytes. The chunk is not
+ * linked into the builder.
+ */
+static struct cgs_strbuild_chunk*
+cgs_strbuild_chunk_new(struct cgs_strbuild* sb, size_t need)
+{
+        size_t size = CGS_STRBUILD_FIRST_SIZE;
+        if (sb->tail) {
+                size = cgs_strbuild_chunk_size(sb->tail) * 2;
+                if (size > CGS_STRBUILD_MAX_SIZE)
+                        size = CGS_STRBUILD_MAX_SIZE;
+        }
+        size_t cap = size - sizeof(struct cgs_strbuild_chunk);
+        if (cap < need)
+                cap = need;
+
+        struct cgs_strbuild_chunk* c = cgs_alloc(sb->alloc,
+                        sizeof(struct cgs_strbuild_chunk) + cap);
+        if (!c)
+                return NULL;
+
+        c->next = NULL;
+        c->len = 0;
+        c->cap = cap;
+        return c;
+}
+
+static void
+cgs_strbuild_link(struct cgs_strbuild* sb, struct cgs_strbuild_chunk* c)
+{
+        if (sb->tail)
+                sb->tail->next = c;
+        else
+                sb->head = c;
+        sb->tail = c;
+        ++sb->chunks;
+}
+
+static void
+cgs_strbuild_free_from(const struct cgs_allocator* a,
+                struct cgs_strbuild_chunk* c)
+{
+        while (c) {
+                struct cgs_strbuild_chunk* next = c->next;
+                cgs_free(a, c, cgs_strbuild_chunk_size(c));
+                c = next;
+        }
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * String Builder Management Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+struct cgs_strbuild
+cgs_strbuild_new(void)
+{
+        return (struct cgs_strbuild){
+                .head = NULL,
+                .tail = NULL,
+                .length = 0,
+                .chunks = 0,
+                .alloc = cgs_allocator_default(),
+        };
+}
+
+void
+cgs_strbuild_free(struct cgs_strbuild* sb)
+{
+        cgs_strbuild_free_from(sb->alloc, sb->head);
+        sb->head = NULL;
+        sb->tail = NULL;
+        sb->length = 0;
+        sb->chunks = 0;
+}
+
+void*
+cgs_strbuild_set_allocator(struct cgs_strbuild* sb,
+                const struct cgs_allocator* a)
+{
+        if (sb->head)
+                return NULL;
+
+        sb->alloc = a;
+        return sb;
+}
+
+void
+cgs_strbuild_clear(struct cgs_strbuild* sb)
+{
+        if (!sb->head)
+                return;
+
+        cgs_strbuild_free_from(sb->alloc, sb->head->next);
+        sb->head->next = NULL;
+        sb->head->len = 0;
+        sb->tail = sb->head;
+        sb->length = 0;
+        sb->chunks = 1;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * String Builder Appending
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+void*
+cgs_strbuild_append(struct cgs_strbuild* sb, const char* s, size_t n)
+{
+        struct cgs_strbuild_chunk* t = sb->tail;
+        size_t fit = t ? t->cap - t->len : 0;
+        if (n <= fit) {
+                memcpy(&t->text[t->len], s, n);
+                t->len += n;
+                sb->length += n;
+                return sb;
+        }
+
+        // allocate before copying so a failure leaves the builder unchanged
+        struct cgs_strbuild_chunk* c = cgs_strbuild_chunk_new(sb, n - fit);
+        if (!c)
+                return NULL;
+
+        if (fit) {
+                memcpy(&t->text[t->len], s, fit);
+                t->len += fit;
+        }
+        memcpy(c->text, s + fit, n - fit);
+        c->len = n - fit;
+        cgs_strbuild_link(sb, c);
+
+        sb->length += n;
+        return sb;
+}
+
+void*
+cgs_strbuild_push(struct cgs_strbuild* sb, char c)
+{
+        struct cgs_strbuild_chunk* t = sb->tail;
+        if (t && t->len < t->cap) {
+                t->text[t->len++] = c;
+                ++sb->length;
+                return sb;
+        }
+        return cgs_strbuild_append(sb, &c, 1);
+}
+
+void*
+cgs_strbuild_appendf(struct cgs_strbuild* sb, const char* fmt, ...)
+{
+        va_list args;
+        va_start(args, fmt);
+        void* res = cgs_strbuild_vappendf(sb, fmt, args);
+        va_end(args);
+
+        return res;
+}
+
+void*
+cgs_strbuild_vappendf(struct cgs_strbuild* sb, const char* fmt, va_list args)
+{
+        // try the spare room of the last chunk first
+        struct cgs_strbuild_chunk* t = sb->tail;
+        size_t avail = t ? t->cap - t->len : 0;
+
+        // vsnprintf needs room for a '\0', which the chunk does not keep
+        char tmp[1];
+        va_list measure;
+        va_copy(measure, args);
+        int n = avail > 0
+                ? vsnprintf(&t->text[t->len], avail, fmt, measure)
+                : vsnprintf(tmp, sizeof(tmp), fmt, measure);
+        va_end(measure);
+
+        if (n < 0)
+                return NULL;
+        if ((size_t)n < avail) {
+                t->len += n;
+                sb->length += n;
+                return sb;
+        }
+
+        // too long: format again into a chunk of its own
+        struct cgs_strbuild_chunk* c = cgs_strbuild_chunk_new(sb, n + 1);
+        if (!c)
+                return NULL;
+
+        vsnprintf(c->text, n + 1, fmt, args);
+        c->len = n;
+        cgs_strbuild_link(sb, c);
+        sb->length += n;
+        return sb;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * String Builder Output
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+void*
+cgs_strbuild_to_string(const struct cgs_strbuild* sb, struct cgs_string* dst)
+{
+        // drop the old contents so growing does not copy them
+        dst->length = 0;
+        cgs_string_data_mut(dst)[0] = '\0';
+        if (dst->capacity != sb->length + 1 &&
+                        !cgs_string_alloc(dst, sb->length + 1))
+                return NULL;
+
+        char* d = cgs_string_data_mut(dst);
+        for (const struct cgs_strbuild_chunk* c = sb->head; c; c = c->next) {
+                memcpy(d, c->text, c->len);
+                d += c->len;
+        }
+        *d = '\0';
+
+        dst->length = sb->length;
+        return dst;
+}
+
+void*
+cgs_strbuild_write(const struct cgs_strbuild* sb, FILE* fp)
+{
+        for (const struct cgs_strbuild_chunk* c = sb->head; c; c = c->next)
+                if (fwrite(c->text, 1, c->len, fp) != c->len)
+                        return NULL;
+
+        return (void*)sb;
+}
+
+void*
+cgs_strbuild_write_fd(const struct cgs_strbuild* sb, int fd)
+{
+        const struct cgs_strbuild_chunk* c = sb->head;
+        size_t off = 0;                 // bytes of 'c' already written
+
+        while (c) {
+                struct iovec iov[CGS_STRBUILD_IOV_BATCH];
+                int cnt = 0;
+                size_t o = off;
+                for (const struct cgs_strbuild_chunk* p = c;
+                                p && cnt < CGS_STRBUILD_IOV_BATCH;
+                                p = p->next, o = 0) {
+                        if (p->len == o)
+                                continue;
+                        iov[cnt].iov_base = (char*)&p->text[o];
+                        iov[cnt].iov_len = p->len - o;
+                        ++cnt;
+                }
+                if (cnt == 0)
+                        break;
+
+                ssize_t w = writev(fd, iov, cnt);
+                if (w < 0) {
+                        if (errno == EINTR)
+                                continue;
+                        return NULL;
+                }
+
+                // advance past what was written, which may end mid-chunk
+                size_t left = w;
+                while (c && left >= c->len - off) {
+                        left -= c->len - off;
+                        c = c->next;
+                        off = 0;
+                }
+                off += left;
+        }
+
+        return (void*)sb;
+}
+
+void
+cgs_strbuild_foreach(const struct cgs_strbuild* sb, CgsUnaryOp f, void* data)
+{
+        size_t i = 0;
+        for (const struct cgs_strbuild_chunk* c = sb->head; c; c = c->next) {
+                if (c->len == 0)
+                        continue;
+
+                struct cgs_strsub ss = cgs_strsub_new(c->text, c->len);
+                f(&ss, i++, data);
+        }
+}
@@ -25,30 +25,48 @@
 #include "cgs_string.h"
 #include "cgs_string_private.h"
 #include "cgs_string_utils.h"
+#include "cgs_format.h"
+#include "cgs_parse.h"
 #include "cgs_compare.h"
 #include "cgs_defs.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 /**
- * CGS_EMPTY_STRING
- *
- * An empty string for non-allocated string structs to use.
+ * The largest delimiter set matched with one SIMD compare per byte. Larger
+ * sets are matched through a lookup table.
  */
-char* const CGS_EMPTY_STRING = "";
+enum { CGS_SPLIT_SIMD_SET = 8 };
 
 struct cgs_string
 cgs_string_new(void)
 {
         return (struct cgs_string){
                 .length = 0,
-                .capacity = 0,
-                .data = CGS_EMPTY_STRING,
+                .capacity = CGS_STRING_INLINE_SIZE,
+                .data = NULL,
+                .alloc = cgs_allocator_default(),
+                .local = { '\0' },
         };
 }
 
+struct cgs_string
+cgs_string_new_with(const struct cgs_allocator* a)
+{
+        struct cgs_string s = cgs_string_new();
+        s.alloc = a;
+        return s;
+}
+
 void*
 cgs_string_copy(const void* s, void* d)
 {
@@ -56,12 +74,11 @@ cgs_string_copy(const void* s, void* d)
         struct cgs_string* dst = d;
 
         const size_t new_cap = src->length + 1;
-        if (dst->capacity < src->capacity && !cgs_string_alloc(dst, new_cap))
+        if (dst->capacity < new_cap && !cgs_string_alloc(dst, new_cap))
                 return NULL;
 
-        strcpy(dst->data, src->data);
+        memcpy(cgs_string_data_mut(dst), cgs_string_data(src), new_cap);
         dst->length = src->length;
-        dst->capacity = new_cap;
         return dst;
 }
 
@@ -71,13 +88,8 @@ cgs_string_move(void* s, void* d)
         struct cgs_string* src = s;
         struct cgs_string* dst = d;
 
-        dst->length = src->length;
-        dst->capacity = src->capacity;
-        dst->data = src->data;
-
-        src->length = 0;
-        src->capacity = 0;
-        src->data = CGS_EMPTY_STRING;
+        memcpy(dst, src, sizeof(struct cgs_string));
+        *src = cgs_string_new_with(src->alloc);
 }
 
 void*
@@ -87,7 +99,7 @@ cgs_string_from(const char* src, struct cgs_string* s)
         if (!cgs_string_alloc(s, len + 1))
                 return NULL;
 
-        strcpy(s->data, src);
+        memcpy(cgs_string_data_mut(s), src, len + 1);
         s->length = len;
 	return s;
 }
@@ -95,27 +107,15 @@ cgs_string_from(const char* src, struct cgs_string* s)
 void*
 cgs_string_from_int(int n, struct cgs_string* s)
 {
-        int sign = n < 0 ? -1 : 1;
-        n *= sign;
-
-        do {
-                if (!cgs_string_push(s, '0' + n % 10))
-                        return NULL;
-        } while ((n /= 10) != 0);
-
-        if (sign == -1 && !cgs_string_push(s, '-'))
-                return NULL;
-
-        cgs_string_reverse(s);
-        return s;
+        return cgs_string_append_int(s, n);
 }
 
 void
 cgs_string_free(void* p)
 {
         struct cgs_string* s = p;
-	if (s && s->data != CGS_EMPTY_STRING)
-		free(s->data);
+	if (s && !cgs_string_is_local(s))
+		cgs_free(s->alloc, s->data, s->capacity);
 }
 
 void*
@@ -129,16 +129,40 @@ cgs_string_shrink(struct cgs_string* s)
 char*
 cgs_string_xfer(struct cgs_string* s)
 {
-	char* p = s->data;
-	s->data = CGS_EMPTY_STRING;
-        s->capacity = 0;
+        char* p = s->data;
+        if (cgs_string_is_local(s)) {
+                p = cgs_alloc(s->alloc, s->length + 1);
+                if (!p)
+                        return NULL;
+                memcpy(p, s->local, s->length + 1);
+        } else if (s->capacity > s->length + 1) {
+                // exact size so the block is freed with the size callers
+                // can work out
+                if (!cgs_string_alloc(s, s->length + 1))
+                        return NULL;
+                p = s->data;
+        }
+
+        *s = cgs_string_new_with(s->alloc);
 	return p;
 }
 
+void*
+cgs_string_set_allocator(struct cgs_string* s, const struct cgs_allocator* a)
+{
+        if (!cgs_string_is_local(s))
+                return NULL;
+        s->alloc = a;
+        return s;
+}
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * String Inline Symbols
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
 
+int
+cgs_string_is_local(const struct cgs_string* s);
+
 const char*
 cgs_string_data(const struct cgs_string* s);
 
@@ -178,18 +202,26 @@ cgs_string_begin_mut(struct cgs_string* s);
 void*
 cgs_string_alloc(struct cgs_string* s, size_t cap)
 {
-        char* p = NULL;
-        if (s->data == CGS_EMPTY_STRING)
-                p = malloc(cap);
-        else
-                p = realloc(s->data, cap);
+        if (cgs_string_is_local(s)) {
+                if (cap <= CGS_STRING_INLINE_SIZE) {    // still fits inline
+                        s->capacity = CGS_STRING_INLINE_SIZE;
+                        return s;
+                }
+
+                char* p = cgs_alloc(s->alloc, cap);     // spill to the heap
+                if (!p)
+                        return NULL;
+
+                memcpy(p, s->local, s->length + 1);
+                s->data = p;
+                s->capacity = cap;
+                return s;
+        }
 
+        char* p = cgs_realloc(s->alloc, s->data, s->capacity, cap);
         if (!p)
                 return NULL;
 
-        if (s->data == CGS_EMPTY_STRING)
-                p[0] = '\0';
-
         s->data = p;
         s->capacity = cap;
         return s;
@@ -264,57 +296,126 @@ cgs_string_push(struct cgs_string* s, int c)
                         return NULL;
         }
 
-	s->data[s->length++] = c;
-	s->data[s->length] = '\0';
+        char* d = cgs_string_data_mut(s);
+	d[s->length++] = c;
+	d[s->length] = '\0';
 	return s;
 }
 
 void*
 cgs_string_cat(struct cgs_string* dst, const struct cgs_string* src)
 {
-        size_t new_cap = dst->length + src->length + 1;
-        if (dst->capacity < new_cap && !cgs_string_grow_len(dst, new_cap))
+        // grow before reading 'src', which may be 'dst' itself
+        size_t new_len = dst->length + src->length;
+        if (new_len + 1 > dst->capacity && !cgs_string_grow_len(dst, new_len))
                 return NULL;
-        strcat(dst->data, src->data);
-        dst->length = new_cap - 1;
+
+        char* d = cgs_string_data_mut(dst);
+        memcpy(&d[dst->length], cgs_string_data(src), src->length);
+        d[new_len] = '\0';
+
+        dst->length = new_len;
         return dst;
 }
 
 void
 cgs_string_clear(struct cgs_string* s)
 {
-	s->data[0] = '\0';
+	cgs_string_data_mut(s)[0] = '\0';
 	s->length = 0;
 }
 
 void
 cgs_string_erase(struct cgs_string* s)
 {
-	for (char* p = s->data; p < s->data + s->capacity; ++p)
-		*p = '\0';
+	memset(cgs_string_data_mut(s), 0, s->capacity);
 	s->length = 0;
 }
 
+/**
+ * Strings shorter than this are insertion sorted, which beats walking all
+ * 256 buckets of a counting sort.
+ */
+enum { CGS_STRING_SORT_SMALL = 16 };
+
 void
 cgs_string_sort(struct cgs_string* s)
 {
-	qsort(s->data, s->length, sizeof(char), cgs_char_cmp);
+        char* d = cgs_string_data_mut(s);
+        size_t n = s->length;
+
+        if (n < CGS_STRING_SORT_SMALL) {
+                for (size_t i = 1; i < n; ++i) {
+                        char c = d[i];
+                        size_t j = i;
+                        for ( ; j > 0 && d[j - 1] > c; --j)
+                                d[j] = d[j - 1];
+                        d[j] = c;
+                }
+                return;
+        }
+
+        size_t counts[256] = { 0 };
+        cgs_str_byte_histogram(d, n, counts);
+
+        // emit in 'char' order, so negative chars come first where signed
+        for (int c = CHAR_MIN; c <= CHAR_MAX; ++c) {
+                size_t k = counts[(unsigned char)c];
+                if (k) {
+                        memset(d, c, k);
+                        d += k;
+                }
+        }
+}
+
+void
+cgs_string_tolower(struct cgs_string* s)
+{
+        char* d = cgs_string_data_mut(s);
+        cgs_memlower(d, d, s->length);
+}
+
+void
+cgs_string_toupper(struct cgs_string* s)
+{
+        char* d = cgs_string_data_mut(s);
+        cgs_memupper(d, d, s->length);
 }
 
 size_t
 cgs_string_find(const struct cgs_string* s, const struct cgs_string* sub)
 {
-        size_t i = 0;
-        while (i < s->length) {
-                for (size_t j = 0; j < sub->length; ++j)
-                        if ((i + j >= s->length)
-                                        || (s->data[i+j] != sub->data[j]))
-                                goto next_iter;
-                return i;
-next_iter:
-                ++i;
+        return cgs_memfind(cgs_string_data(s), s->length,
+                        cgs_string_data(sub), sub->length);
+}
+
+size_t
+cgs_string_rfind(const struct cgs_string* s, const struct cgs_string* sub)
+{
+        return cgs_memrfind(cgs_string_data(s), s->length,
+                        cgs_string_data(sub), sub->length);
+}
+
+void*
+cgs_string_find_all(const struct cgs_string* s, const struct cgs_string* sub,
+                struct cgs_vector* vec)
+{
+        if (vec->element_size != sizeof(size_t) || sub->length == 0)
+                return NULL;
+
+        const char* str = cgs_string_data(s);
+        const char* pat = cgs_string_data(sub);
+        for (size_t i = 0; i < s->length; i += sub->length) {
+                size_t pos = cgs_memfind(&str[i], s->length - i, pat,
+                                sub->length);
+                if (pos == s->length - i)
+                        break;
+
+                i += pos;
+                if (!cgs_vector_push(vec, &i))
+                        return NULL;
         }
-        return s->length;
+        return vec;
 }
 
 void
@@ -322,14 +423,15 @@ cgs_string_trunc(struct cgs_string* s, size_t n)
 {
         if (s->length <= n)
                 return;
-        s->data[n] = '\0';
+        cgs_string_data_mut(s)[n] = '\0';
         s->length = n;
 }
 
 void
 cgs_string_reverse(struct cgs_string* s)
 {
-        for (char* b = s->data, *e = &s->data[s->length-1]; b < e; ++b, --e)
+        char* d = cgs_string_data_mut(s);
+        for (char* b = d, *e = &d[s->length-1]; b < e; ++b, --e)
                 CGS_SWAP(*b, *e, char);
 }
 
@@ -344,16 +446,119 @@ cgs_string_replace(struct cgs_string* s, size_t pos, size_t count,
         if (s->capacity < new_cap && !cgs_string_grow_len(s, new_cap))
                 return NULL;
 
-        memmove(&s->data[pos + rep->length],            // gap for new string
-                        &s->data[pos + count],          // tail to keep
+        char* d = cgs_string_data_mut(s);
+        memmove(&d[pos + rep->length],                  // gap for new string
+                        &d[pos + count],                // tail to keep
                         s->length - pos - count + 1);
 
-        strncpy(&s->data[pos], rep->data, rep->length);
+        memcpy(&d[pos], cgs_string_data(rep), rep->length);
 
         s->length = s->length - count + rep->length;
         return s;
 }
 
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * String Formatting
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+/**
+ * cgs_string_reserve_tail
+ *
+ * Make room for 'n' more characters and the terminating '\0'.
+ *
+ * @return      A pointer to where the next character goes, NULL on failure.
+ */
+static char*
+cgs_string_reserve_tail(struct cgs_string* s, size_t n)
+{
+        size_t new_len = s->length + n;
+        if (new_len + 1 > s->capacity && !cgs_string_grow_len(s, new_len))
+                return NULL;
+        return cgs_string_data_mut(s) + s->length;
+}
+
+void*
+cgs_string_append_u64(struct cgs_string* s, uint64_t n)
+{
+        char* p = cgs_string_reserve_tail(s, CGS_FORMAT_INT_SIZE - 1);
+        if (!p)
+                return NULL;
+
+        s->length += cgs_format_u64(p, n);
+        return s;
+}
+
+void*
+cgs_string_append_i64(struct cgs_string* s, int64_t n)
+{
+        char* p = cgs_string_reserve_tail(s, CGS_FORMAT_INT_SIZE - 1);
+        if (!p)
+                return NULL;
+
+        s->length += cgs_format_i64(p, n);
+        return s;
+}
+
+// Inline symbols
+void*
+cgs_string_append_int(struct cgs_string* s, int n);
+
+void*
+cgs_string_append_uint(struct cgs_string* s, unsigned n);
+
+void*
+cgs_string_append_long(struct cgs_string* s, long n);
+
+void*
+cgs_string_append_double(struct cgs_string* s, double d)
+{
+        char* p = cgs_string_reserve_tail(s, CGS_FORMAT_DOUBLE_SIZE - 1);
+        if (!p)
+                return NULL;
+
+        s->length += cgs_format_double(p, d);
+        return s;
+}
+
+void*
+cgs_string_appendf(struct cgs_string* s, const char* fmt, ...)
+{
+        va_list args;
+
+        va_start(args, fmt);
+        void* res = cgs_string_vappendf(s, fmt, args);
+        va_end(args);
+
+        return res;
+}
+
+void*
+cgs_string_vappendf(struct cgs_string* s, const char* fmt, va_list args)
+{
+        va_list measure;
+        va_copy(measure, args);
+        size_t avail = s->capacity > s->length ? s->capacity - s->length : 0;
+        int n = vsnprintf(cgs_string_data_mut(s) + s->length, avail, fmt,
+                        measure);
+        va_end(measure);
+
+        if (n >= 0 && (size_t)n >= avail) {
+                if (cgs_string_grow_len(s, s->length + n))
+                        vsnprintf(cgs_string_data_mut(s) + s->length, n + 1,
+                                        fmt, args);
+                else
+                        n = -1;
+        }
+
+        // a failed or truncated attempt may have overwritten the '\0'
+        if (n < 0) {
+                cgs_string_data_mut(s)[s->length] = '\0';
+                return NULL;
+        }
+        s->length += n;
+        return s;
+}
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * Strsub Inline Symbols
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
@@ -395,35 +600,112 @@ cgs_strsub_eq_str(const struct cgs_strsub* ss, const char* s)
                 && strncmp(ss->data, s, ss->length) == 0;
 }
 
-void*
-cgs_strsub_to_int(const struct cgs_strsub* ss, int* out)
+int
+cgs_strsub_cmp_nocase(const void* a, const void* b)
 {
-        const char* s = ss->data;
-        size_t i = 0;
-        while (i < ss->length && isspace(s[i]))
-                ++i;
+        const struct cgs_strsub* ss1 = a;
+        const struct cgs_strsub* ss2 = b;
+        size_t n = ss1->length < ss2->length ? ss1->length : ss2->length;
 
-        int sign = 1;
-        if (s[i] == '-' || s[i] == '+')
-                sign = s[i++] == '-' ? -1 : 1;
+        int res = cgs_memcasecmp(ss1->data, ss2->data, n);
+        if (res != 0)
+                return res;
+        return (ss1->length > ss2->length) - (ss1->length < ss2->length);
+}
 
-        if (i >= ss->length || !isdigit(s[i]))
-                return NULL;
+int
+cgs_strsub_eq_nocase(const struct cgs_strsub* a, const struct cgs_strsub* b)
+{
+        return a->length == b->length
+                && cgs_memcasecmp(a->data, b->data, a->length) == 0;
+}
 
-        *out = 0;
-        for ( ; i < ss->length && isdigit(ss->data[i]); ++i) {
-                *out *= 10;
-                *out += ss->data[i] - '0';
-        }
+int
+cgs_strsub_eq_str_nocase(const struct cgs_strsub* ss, const char* s)
+{
+        return strlen(s) == ss->length
+                && cgs_memcasecmp(ss->data, s, ss->length) == 0;
+}
+
+void
+cgs_strsub_trim_left(struct cgs_strsub* ss)
+{
+        size_t k = cgs_memspn_space(ss->data, ss->length);
+        ss->data += k;
+        ss->length -= k;
+}
+
+void
+cgs_strsub_trim_right(struct cgs_strsub* ss)
+{
+        ss->length -= cgs_memrspn_space(ss->data, ss->length);
+}
+
+void
+cgs_strsub_trim(struct cgs_strsub* ss)
+{
+        cgs_strsub_trim_left(ss);
+        cgs_strsub_trim_right(ss);
+}
 
-        *out *= sign;
+void
+cgs_strsub_trim_set(struct cgs_strsub* ss, const char* set)
+{
+        uint64_t table[4] = { 0 };
+        for (const unsigned char* p = (const unsigned char*)set; *p; ++p)
+                table[*p >> 6] |= (uint64_t)1 << (*p & 63);
+
+        const unsigned char* d = (const unsigned char*)ss->data;
+        size_t lo = 0;
+        size_t hi = ss->length;
+        while (lo < hi && table[d[lo] >> 6] >> (d[lo] & 63) & 1)
+                ++lo;
+        while (hi > lo && table[d[hi - 1] >> 6] >> (d[hi - 1] & 63) & 1)
+                --hi;
+
+        ss->data += lo;
+        ss->length = hi - lo;
+}
+
+void
+cgs_strsub_tolower(const struct cgs_strsub* ss, char* dst)
+{
+        cgs_memlower(dst, ss->data, ss->length);
+}
+
+void
+cgs_strsub_toupper(const struct cgs_strsub* ss, char* dst)
+{
+        cgs_memupper(dst, ss->data, ss->length);
+}
+
+void*
+cgs_strsub_to_int(const struct cgs_strsub* ss, int* out)
+{
+        int32_t n;
+        if (!cgs_parse_i32(ss->data, ss->length, 10, &n))
+                return NULL;
+
+        *out = n;
         return out;
 }
 
+size_t
+cgs_strsub_find(const struct cgs_strsub* ss, const struct cgs_strsub* sub)
+{
+        return cgs_memfind(ss->data, ss->length, sub->data, sub->length);
+}
+
+size_t
+cgs_strsub_rfind(const struct cgs_strsub* ss, const struct cgs_strsub* sub)
+{
+        return cgs_memrfind(ss->data, ss->length, sub->data, sub->length);
+}
+
 char*
 cgs_strsub_to_str(const struct cgs_strsub* ss)
 {
-        char* p = malloc(ss->length + 1);
+        char* p = cgs_alloc(cgs_allocator_default(), ss->length + 1);
         if (!p)
                 return NULL;
 
@@ -435,38 +717,106 @@ cgs_strsub_to_str(const struct cgs_strsub* ss)
 void*
 cgs_strsub_to_string(const struct cgs_strsub* ss, struct cgs_string* dst)
 {
-        char* p = cgs_strsub_to_str(ss);
-        if (!p)
+        if (!cgs_string_alloc(dst, ss->length + 1))
                 return NULL;
 
-        dst->data = p;
+        char* d = cgs_string_data_mut(dst);
+        memcpy(d, ss->data, ss->length);
+        d[ss->length] = '\0';
         dst->length = ss->length;
-        dst->capacity = ss->length + 1;
 
         return dst;
 }
 
-void*
-cgs_str_split(const char* s, char delim, struct cgs_vector* vec)
+/**
+ * cgs_split_push
+ *
+ * Push a field onto a split result unless it is empty and empty fields are
+ * dropped.
+ *
+ * @return      A pointer back to the vector on success, NULL on failure.
+ */
+static void*
+cgs_split_push(struct cgs_vector* vec, const char* p, size_t len, int flags)
+{
+        if (len == 0 && !(flags & CGS_SPLIT_KEEP_EMPTY))
+                return vec;
+
+        struct cgs_strsub ss = cgs_strsub_new(p, len);
+        return cgs_vector_push(vec, &ss);
+}
+
+/**
+ * cgs_split_set
+ *
+ * Split on any byte of a set. Sets of up to CGS_SPLIT_SIMD_SET bytes are
+ * matched 16 bytes at a time with SSE2, one compare per set byte, and every
+ * delimiter in the block is emitted from the resulting bit mask. Larger
+ * sets and the tail use a lookup table.
+ *
+ * @param ss    The sub-string to split.
+ * @param set   The delimiter bytes.
+ * @param k     The number of delimiter bytes.
+ * @param flags A combination of `enum cgs_split_flags`.
+ * @param vec   The vector to store the strsub elements into.
+ *
+ * @return      A pointer back to the vector on success, NULL on failure.
+ */
+static void*
+cgs_split_set(const struct cgs_strsub* ss, const char* set, size_t k,
+                int flags, struct cgs_vector* vec)
 {
         if (vec->element_size != sizeof(struct cgs_strsub))
                 return NULL;
 
-        for (const char* p = s; ; ++s, p = s) {
-                size_t count = 0;
-                while (*s && *s != delim) {
-                        ++s;
-                        ++count;
-                }
-                if (count != 0) {
-                        struct cgs_strsub ss = cgs_strsub_new(p, count);
-                        if (!cgs_vector_push(vec, &ss))
-                                return NULL;
+        const char* s = ss->data;
+        const size_t n = ss->length;
+        size_t field = 0;
+        size_t i = 0;
+
+#ifdef __SSE2__
+        if (k > 0 && k <= CGS_SPLIT_SIMD_SET) {
+                __m128i d[CGS_SPLIT_SIMD_SET];
+                for (size_t j = 0; j < k; ++j)
+                        d[j] = _mm_set1_epi8(set[j]);
+
+                for ( ; i + 16 <= n; i += 16) {
+                        __m128i v = _mm_loadu_si128((const __m128i*)&s[i]);
+                        __m128i m = _mm_cmpeq_epi8(v, d[0]);
+                        for (size_t j = 1; j < k; ++j)
+                                m = _mm_or_si128(m, _mm_cmpeq_epi8(v, d[j]));
+
+                        for (unsigned mask = _mm_movemask_epi8(m); mask;
+                                        mask &= mask - 1) {
+                                size_t p = i + __builtin_ctz(mask);
+                                if (!cgs_split_push(vec, &s[field],
+                                                        p - field, flags))
+                                        return NULL;
+                                field = p + 1;
+                        }
                 }
-                if (!*s)
-                        break;
         }
-        return vec;
+#endif
+
+        unsigned char table[UCHAR_MAX + 1] = { 0 };
+        for (size_t j = 0; j < k; ++j)
+                table[(unsigned char)set[j]] = 1;
+
+        for ( ; i < n; ++i) {
+                if (!table[(unsigned char)s[i]])
+                        continue;
+                if (!cgs_split_push(vec, &s[field], i - field, flags))
+                        return NULL;
+                field = i + 1;
+        }
+        return cgs_split_push(vec, &s[field], n - field, flags);
+}
+
+void*
+cgs_str_split(const char* s, char delim, struct cgs_vector* vec)
+{
+        struct cgs_strsub ss = cgs_strsub_from_str(s);
+        return cgs_split_set(&ss, &delim, 1, 0, vec);
 }
 
 // Inline symbol
@@ -477,25 +827,117 @@ void*
 cgs_strsub_split(const struct cgs_strsub* ss, char delim,
                 struct cgs_vector* vec)
 {
-        if (vec->element_size != sizeof(struct cgs_strsub))
+        return cgs_split_set(ss, &delim, 1, 0, vec);
+}
+
+void*
+cgs_strsub_split_any(const struct cgs_strsub* ss, const char* delims,
+                int flags, struct cgs_vector* vec)
+{
+        return cgs_split_set(ss, delims, strlen(delims), flags, vec);
+}
+
+void*
+cgs_strsub_split_str(const struct cgs_strsub* ss, const struct cgs_strsub* sep,
+                int flags, struct cgs_vector* vec)
+{
+        if (vec->element_size != sizeof(struct cgs_strsub) || sep->length == 0)
                 return NULL;
 
-        const char* beg = ss->data;
-        const char* end = beg + ss->length;
-        for ( ; beg < end; ++beg) {
-                const char* start = beg;
-                size_t count = 0;
-                while (beg < end && *beg != delim) {
-                        ++beg;
-                        ++count;
+        const char* s = ss->data;
+        const size_t n = ss->length;
+        size_t field = 0;
+        for (;;) {
+                size_t p = field + cgs_memfind(&s[field], n - field,
+                                sep->data, sep->length);
+                if (p == n)
+                        break;
+                if (!cgs_split_push(vec, &s[field], p - field, flags))
+                        return NULL;
+                field = p + sep->length;
+        }
+        return cgs_split_push(vec, &s[field], n - field, flags);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * Split Iterator
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+struct cgs_split_iter
+cgs_split_iter_new(const struct cgs_strsub* ss, const char* delims, int flags)
+{
+        struct cgs_split_iter it = {
+                .data = ss->data,
+                .length = ss->length,
+                .pos = 0,
+                .delim = -1,
+                .flags = flags,
+                .set = { 0 },
+        };
+
+        for (const unsigned char* p = (const unsigned char*)delims; *p; ++p)
+                it.set[*p >> 6] |= (uint64_t)1 << (*p & 63);
+        if (delims[0] && !delims[1])
+                it.delim = (unsigned char)delims[0];
+        return it;
+}
+
+// Inline symbols
+struct cgs_split_iter
+cgs_str_split_iter(const char* s, const char* delims, int flags);
+
+struct cgs_split_iter
+cgs_string_split_iter(const struct cgs_string* s, const char* delims,
+                int flags);
+
+void*
+cgs_split_iter_next(struct cgs_split_iter* it, struct cgs_strsub* out)
+{
+        while (it->pos <= it->length) {
+                const char* s = &it->data[it->pos];
+                size_t n = it->length - it->pos;
+                size_t len = 0;
+
+                if (it->delim >= 0) {
+                        const char* p = memchr(s, it->delim, n);
+                        len = p ? (size_t)(p - s) : n;
+                } else {
+                        while (len < n) {
+                                unsigned char c = s[len];
+                                if (it->set[c >> 6] >> (c & 63) & 1)
+                                        break;
+                                ++len;
+                        }
                 }
-                if (count != 0) {
-                        struct cgs_strsub ss = cgs_strsub_new(start, count);
-                        if (!cgs_vector_push(vec, &ss))
-                                return NULL;
+
+                // step past the delimiter, or past the end on the last field
+                it->pos += len + 1;
+                if (len != 0 || it->flags & CGS_SPLIT_KEEP_EMPTY) {
+                        *out = cgs_strsub_new(s, len);
+                        return it;
                 }
         }
-        return vec;
+        return NULL;
+}
+
+size_t
+cgs_split_iter_skip(struct cgs_split_iter* it, size_t n)
+{
+        struct cgs_strsub ss;
+        size_t i = 0;
+        while (i < n && cgs_split_iter_next(it, &ss))
+                ++i;
+        return i;
+}
+
+size_t
+cgs_split_iter_collect(struct cgs_split_iter* it, struct cgs_strsub* arr,
+                size_t n)
+{
+        size_t i = 0;
+        while (i < n && cgs_split_iter_next(it, &arr[i]))
+                ++i;
+        return i;
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
@@ -506,10 +948,10 @@ void*
 cgs_string_prepend_str(struct cgs_string* s, const char* add, size_t len)
 {
         size_t new_len = s->length + len;
-        if (new_len >= s->capacity - 1 && !cgs_string_grow_len(s, new_len))
+        if (new_len + 1 > s->capacity && !cgs_string_grow_len(s, new_len))
                 return NULL;
 
-        cgs_strprepend(s->data, add, len);
+        cgs_strprepend(cgs_string_data_mut(s), add, len);
 
         s->length = new_len;
         return s;
@@ -519,10 +961,12 @@ void*
 cgs_string_cat_str(struct cgs_string* s, const char* add, size_t len)
 {
         size_t new_len = s->length + len;
-        if (new_len >= s->capacity - 1 && !cgs_string_grow_len(s, new_len))
+        if (new_len + 1 > s->capacity && !cgs_string_grow_len(s, new_len))
                 return NULL;
 
-        strncat(s->data, add, len);
+        char* d = cgs_string_data_mut(s);
+        memcpy(&d[s->length], add, len);
+        d[new_len] = '\0';
 
         s->length = new_len;
         return s;
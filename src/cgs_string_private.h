@@ -24,11 +24,39 @@
  */
 #pragma once
 
+#include "cgs_string.h"
+
 enum cgs_string_defaults {
         CGS_STRING_INITIAL_CAPACITY = 16,
         CGS_STRING_GROWTH_RATE = 2,
 };
 
+/**
+ * cgs_string_is_local
+ *
+ * Check whether a string is currently stored inline.
+ *
+ * @param s     The string.
+ *
+ * @return      A boolean integer indicating true(1) or false(0).
+ */
+inline int
+cgs_string_is_local(const struct cgs_string* s)
+{
+        return !s->data;
+}
+
+/**
+ * cgs_string_alloc
+ *
+ * Make room for exactly 'cap' bytes, or CGS_STRING_INLINE_SIZE while the
+ * string still fits inline. The contents up to 'cap' are kept.
+ *
+ * @param s     The string.
+ * @param cap   The new capacity in bytes, including the terminating '\0'.
+ *
+ * @return      A pointer back to the string on success, NULL on failure.
+ */
 void*
 cgs_string_alloc(struct cgs_string* s, size_t cap);
 
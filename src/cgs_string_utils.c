@@ -23,11 +23,27 @@
  * SOFTWARE.
  */
 #include "cgs_string_utils.h"
+#include "cgs_parse.h"
 
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
 #include <limits.h>
+#include <stdint.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * Needles longer than this are searched for with Boyer-Moore-Horspool.
+ * Shorter ones are cheaper to verify than to build a skip table for.
+ */
+enum { CGS_FIND_SHORT_NEEDLE = 32 };
+
+// Inline symbols
+int cgs_ascii_tolower(int c);
+
+int cgs_ascii_toupper(int c);
 
 char* cgs_strdup(const char* src)
 {
@@ -40,40 +56,31 @@ char* cgs_strdup(const char* src)
 	return dst;
 }
 
+static inline int cgs_is_space(unsigned char c)
+{
+	return c == ' ' || (unsigned)c - '\t' < 5;
+}
+
 int
 cgs_strtoi(const char* s, const char** p)
 {
-        int ret = 0;
-        if (p)
-                *p = s;
-
-        while (isspace(*s))
-                ++s;
+        /* Only measure the number itself: 's' is often the head of a large
+         * buffer, and a strlen() per call would make scanning one quadratic.
+         */
+        size_t n = 0;
+        while (cgs_is_space(s[n]))
+                ++n;
+        if (s[n] == '-' || s[n] == '+')
+                ++n;
+        while ((unsigned char)(s[n] - '0') < 10)
+                ++n;
 
-        int sign = 1;
-        if (*s == '-' || *s == '+') {
-                sign = *s == '-' ? -1 : 1;
-                ++s;
-        }
-
-        if (!isdigit(*s))
-                return ret;
-
-        for (const int max = INT_MAX / 10; isdigit(*s) && ret <= max; ++s) {
-                ret *= 10;
-                int c = *s - '0';
-                if (c > INT_MAX - ret)
-                        break;
-                ret += c;
-        }
-        if (isdigit(*s))
-                goto overflow_detected;
-
-        *p = s;
-        return ret * sign;
+        int32_t ret = 0;
+        const char* end = cgs_parse_i32(s, n, 10, &ret);
+        if (p)
+                *p = end ? end : s;
 
-overflow_detected:
-        return ret;
+        return end ? ret : 0;
 }
 
 void cgs_strmove(char* s, size_t n)
@@ -137,29 +144,308 @@ void cgs_strshiftr(char* s, size_t n, int c)
 
 void cgs_strtrim(char* s)
 {
-	char* p = s;
-	while (isspace(*p))
-		++p;
-
-	while (*p)
-		*s++ = *p++;
+	size_t n = strlen(s);
+	size_t lo = cgs_memspn_space(s, n);
+	size_t len = n - lo - cgs_memrspn_space(&s[lo], n - lo);
 
-	do {
-		*s = '\0';
-	} while (isspace(*--s));
+	memmove(s, &s[lo], len);
+	s[len] = '\0';
 }
 
 void cgs_strtrimch(char* s, char ch)
 {
-	char* p = s;
-	while (*p == ch)
-		++p;
+	size_t n = strlen(s);
+	size_t lo = 0;
+	while (lo < n && s[lo] == ch)
+		++lo;
+	size_t hi = n;
+	while (hi > lo && s[hi - 1] == ch)
+		--hi;
+
+	memmove(s, &s[lo], hi - lo);
+	s[hi - lo] = '\0';
+}
+
+#ifdef __SSE2__
+/**
+ * cgs_space_mask16
+ *
+ * Mark the ASCII whitespace bytes of a block: ' ' and '\t' through '\r'.
+ * Subtracting '\t' moves the control characters to [0, 4], which an
+ * unsigned minimum tests in one step.
+ *
+ * @return	A 16-bit mask with a bit set for each whitespace byte.
+ */
+static inline unsigned cgs_space_mask16(__m128i v)
+{
+	__m128i t = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+	__m128i ctl = _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8(4)), t);
+	__m128i sp = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+	return _mm_movemask_epi8(_mm_or_si128(ctl, sp));
+}
+#endif
+
+size_t cgs_memspn_space(const char* s, size_t n)
+{
+	size_t i = 0;
+	// short runs are the common case; only scan blocks past the first byte
+	if (n > 0 && !cgs_is_space(s[0]))
+		return 0;
+#ifdef __SSE2__
+	for ( ; i + 16 <= n; i += 16) {
+		unsigned mask = ~cgs_space_mask16(_mm_loadu_si128(
+					(const __m128i*)&s[i])) & 0xFFFF;
+		if (mask)
+			return i + __builtin_ctz(mask);
+	}
+#endif
+	while (i < n && cgs_is_space(s[i]))
+		++i;
+	return i;
+}
+
+size_t cgs_memrspn_space(const char* s, size_t n)
+{
+	size_t i = n;
+	if (n > 0 && !cgs_is_space(s[n - 1]))
+		return 0;
+#ifdef __SSE2__
+	for ( ; i >= 16; i -= 16) {
+		unsigned mask = ~cgs_space_mask16(_mm_loadu_si128(
+					(const __m128i*)&s[i - 16])) & 0xFFFF;
+		if (mask)
+			return n - (i - 16 + 31 - __builtin_clz(mask)) - 1;
+	}
+#endif
+	while (i > 0 && cgs_is_space(s[i - 1]))
+		--i;
+	return n - i;
+}
+
+/**
+ * cgs_memfind_short
+ *
+ * Find a needle of at least 2 bytes by testing its first and last byte at
+ * 16 candidate positions per step and verifying the hits with memcmp.
+ */
+static size_t cgs_memfind_short(const char* s, size_t n, const char* sub,
+		size_t m)
+{
+	size_t i = 0;
+#ifdef __SSE2__
+	const __m128i first = _mm_set1_epi8(sub[0]);
+	const __m128i last = _mm_set1_epi8(sub[m - 1]);
+
+	for ( ; i + m - 1 + 16 <= n; i += 16) {
+		__m128i a = _mm_loadu_si128((const __m128i*)&s[i]);
+		__m128i b = _mm_loadu_si128((const __m128i*)&s[i + m - 1]);
+		unsigned mask = _mm_movemask_epi8(_mm_and_si128(
+					_mm_cmpeq_epi8(a, first),
+					_mm_cmpeq_epi8(b, last)));
+		while (mask) {
+			unsigned bit = __builtin_ctz(mask);
+			if (memcmp(&s[i + bit + 1], &sub[1], m - 2) == 0)
+				return i + bit;
+			mask &= mask - 1;
+		}
+	}
+#endif
+	for (const char* p; i + m <= n; ++i) {
+		p = memchr(&s[i], sub[0], n - m + 1 - i);
+		if (!p)
+			break;
+		i = p - s;
+		if (s[i + m - 1] == sub[m - 1]
+				&& memcmp(&s[i + 1], &sub[1], m - 2) == 0)
+			return i;
+	}
+	return n;
+}
+
+/**
+ * cgs_memfind_bmh
+ *
+ * Find a long needle with Boyer-Moore-Horspool: on a mismatch, skip ahead by
+ * the distance from the last occurrence of the window's final byte in the
+ * needle to the needle's end.
+ */
+static size_t cgs_memfind_bmh(const char* s, size_t n, const char* sub,
+		size_t m)
+{
+	size_t skip[UCHAR_MAX + 1];
+	for (size_t c = 0; c <= UCHAR_MAX; ++c)
+		skip[c] = m;
+	for (size_t j = 0; j < m - 1; ++j)
+		skip[(unsigned char)sub[j]] = m - 1 - j;
+
+	const char last = sub[m - 1];
+	for (size_t i = 0; i + m <= n; ) {
+		char c = s[i + m - 1];
+		if (c == last && memcmp(&s[i], sub, m - 1) == 0)
+			return i;
+		i += skip[(unsigned char)c];
+	}
+	return n;
+}
+
+size_t cgs_memfind(const char* s, size_t n, const char* sub, size_t m)
+{
+	if (m == 0)
+		return 0;
+	if (m > n)
+		return n;
+
+	if (m == 1) {
+		const char* p = memchr(s, sub[0], n);
+		return p ? (size_t)(p - s) : n;
+	}
+	if (m <= CGS_FIND_SHORT_NEEDLE)
+		return cgs_memfind_short(s, n, sub, m);
+	return cgs_memfind_bmh(s, n, sub, m);
+}
+
+size_t cgs_memrfind(const char* s, size_t n, const char* sub, size_t m)
+{
+	if (m == 0 || m > n)
+		return n;
+
+	for (size_t i = n - m + 1; i-- > 0; )
+		if (s[i] == sub[0] && memcmp(&s[i + 1], &sub[1], m - 1) == 0)
+			return i;
+	return n;
+}
+
+/**
+ * Buffers shorter than this are counted straight into the caller's table.
+ * Longer ones amortize zeroing and summing the interleaved tables.
+ */
+enum { CGS_HISTOGRAM_SPLIT = 256 };
+
+void cgs_str_byte_histogram(const char* s, size_t n, size_t counts[256])
+{
+	const unsigned char* p = (const unsigned char*)s;
+
+	if (n < CGS_HISTOGRAM_SPLIT) {
+		for (size_t i = 0; i < n; ++i)
+			++counts[p[i]];
+		return;
+	}
+
+	// blocks are short enough that no 32-bit count can overflow
+	uint32_t t[4][256];
+	while (n > 0) {
+		size_t block = n < (size_t)UINT32_MAX ? n : (size_t)UINT32_MAX;
+		memset(t, 0, sizeof(t));
+
+		size_t i = 0;
+		for ( ; i + 4 <= block; i += 4) {
+			++t[0][p[i]];
+			++t[1][p[i + 1]];
+			++t[2][p[i + 2]];
+			++t[3][p[i + 3]];
+		}
+		for ( ; i < block; ++i)
+			++t[0][p[i]];
+
+		for (int c = 0; c < 256; ++c)
+			counts[c] += (size_t)t[0][c] + t[1][c] + t[2][c] + t[3][c];
+
+		p += block;
+		n -= block;
+	}
+}
+
+int cgs_str_is_anagram(const char* a, size_t n, const char* b, size_t m)
+{
+	if (n != m)
+		return 0;
+
+	// every byte of 'b' must use up a byte of 'a'; the lengths match
+	size_t counts[256] = { 0 };
+	cgs_str_byte_histogram(a, n, counts);
+
+	const unsigned char* p = (const unsigned char*)b;
+	for (size_t i = 0; i < m; ++i)
+		if (counts[p[i]]-- == 0)
+			return 0;
+	return 1;
+}
+
+#ifdef __SSE2__
+/**
+ * cgs_mem_fold16
+ *
+ * Set or clear the 0x20 bit of the bytes of a block that lie in ['lo',
+ * 'lo' + 25]. Adding 0x80 - 'lo' moves that range to the bottom of the
+ * signed bytes, so one signed compare finds it.
+ */
+static inline __m128i cgs_mem_fold16(__m128i v, char lo, int upper)
+{
+	__m128i t = _mm_add_epi8(v, _mm_set1_epi8((char)(0x80 - lo)));
+	__m128i in = _mm_cmplt_epi8(t, _mm_set1_epi8(-128 + 26));
+	__m128i bit = _mm_and_si128(in, _mm_set1_epi8(0x20));
+	return upper ? _mm_xor_si128(v, bit) : _mm_or_si128(v, bit);
+}
+#endif
 
-	while (*p)
-		*s++ = *p++;
+void cgs_memlower(char* dst, const char* src, size_t n)
+{
+	size_t i = 0;
+#ifdef __SSE2__
+	for ( ; i + 16 <= n; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i*)&src[i]);
+		_mm_storeu_si128((__m128i*)&dst[i], cgs_mem_fold16(v, 'A', 0));
+	}
+#endif
+	for ( ; i < n; ++i)
+		dst[i] = cgs_ascii_tolower((unsigned char)src[i]);
+}
+
+void cgs_memupper(char* dst, const char* src, size_t n)
+{
+	size_t i = 0;
+#ifdef __SSE2__
+	for ( ; i + 16 <= n; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i*)&src[i]);
+		_mm_storeu_si128((__m128i*)&dst[i], cgs_mem_fold16(v, 'a', 1));
+	}
+#endif
+	for ( ; i < n; ++i)
+		dst[i] = cgs_ascii_toupper((unsigned char)src[i]);
+}
 
-	do {
-		*s = '\0';
-	} while (*--s == ch);
+int cgs_memcasecmp(const char* a, const char* b, size_t n)
+{
+	size_t i = 0;
+#ifdef __SSE2__
+	for ( ; i + 16 <= n; i += 16) {
+		__m128i va = _mm_loadu_si128((const __m128i*)&a[i]);
+		__m128i vb = _mm_loadu_si128((const __m128i*)&b[i]);
+		unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(
+					cgs_mem_fold16(va, 'A', 0),
+					cgs_mem_fold16(vb, 'A', 0)));
+		if (mask != 0xFFFF) {
+			i += __builtin_ctz(~mask);
+			break;
+		}
+	}
+#endif
+	for ( ; i < n; ++i) {
+		int ca = cgs_ascii_tolower((unsigned char)a[i]);
+		int cb = cgs_ascii_tolower((unsigned char)b[i]);
+		if (ca != cb)
+			return ca - cb;
+	}
+	return 0;
 }
 
+int cgs_strcasecmp(const char* a, const char* b)
+{
+	size_t na = strlen(a);
+	size_t nb = strlen(b);
+
+	int res = cgs_memcasecmp(a, b, na < nb ? na : nb);
+	if (res != 0)
+		return res;
+	return (na > nb) - (na < nb);
+}
@@ -0,0 +1,412 @@
+/* cgs_utf8.c
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ *
+ * cgs_utf8.c
+ *
+ * This file contains the source code of the libcgs UTF-8 functions.
+ *
+ * The vector validator is the lookup algorithm of Keiser and Lemire
+ * ("Validating UTF-8 In Less Than One Instruction Per Byte", 2021). Every
+ * error in a two byte window is found by looking up the high nibble of the
+ * first byte, its low nibble and the high nibble of the second byte in three
+ * tables of error flags and and-ing the results. Third and fourth bytes of
+ * longer sequences are checked separately against their lead bytes. When a
+ * block fails, the scalar validator takes over from the sequence boundary
+ * before it to find the exact position.
+ *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#include "cgs_utf8.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* The vector validator is built for any x86 target GCC or Clang can compile
+ * SSSE3 functions for. Unless the whole build already targets SSSE3 it is
+ * compiled for it alone and chosen at run time.
+ */
+#if defined(__SSSE3__)
+#define CGS_UTF8_SSSE3
+#define CGS_UTF8_TARGET_SSSE3
+#elif (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CGS_UTF8_SSSE3
+#define CGS_UTF8_SSSE3_DISPATCH
+#define CGS_UTF8_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+
+#ifdef CGS_UTF8_SSSE3
+#include <tmmintrin.h>
+#endif
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * UTF-8 Inline Symbols
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+int
+cgs_utf8_valid(const char* s, size_t n);
+
+int
+cgs_strsub_utf8_valid(const struct cgs_strsub* ss);
+
+int
+cgs_string_utf8_valid(const struct cgs_string* s);
+
+size_t
+cgs_strsub_utf8_count(const struct cgs_strsub* ss);
+
+size_t
+cgs_string_utf8_count(const struct cgs_string* s);
+
+struct cgs_utf8_iter
+cgs_utf8_iter_new(const struct cgs_strsub* ss);
+
+void*
+cgs_utf8_iter_next(struct cgs_utf8_iter* it, uint32_t* cp);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * UTF-8 Scalar Functions
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+static inline int
+cgs_utf8_is_cont(unsigned char c)
+{
+        return (c & 0xC0) == 0x80;
+}
+
+size_t
+cgs_utf8_decode(const char* s, size_t n, uint32_t* cp)
+{
+        const unsigned char* p = (const unsigned char*)s;
+        unsigned c = p[0];
+
+        if (c < 0x80) {
+                *cp = c;
+                return 1;
+        }
+        if (c < 0xC2)                   // continuation or overlong 2-byte
+                return 0;
+
+        if (c < 0xE0) {
+                if (n < 2 || !cgs_utf8_is_cont(p[1]))
+                        return 0;
+                *cp = (c & 0x1F) << 6 | (p[1] & 0x3F);
+                return 2;
+        }
+
+        // the second byte's range excludes overlongs, surrogates and
+        // values above U+10FFFF
+        if (c < 0xF0) {
+                unsigned lo = c == 0xE0 ? 0xA0 : 0x80;
+                unsigned hi = c == 0xED ? 0x9F : 0xBF;
+                if (n < 3 || p[1] < lo || p[1] > hi || !cgs_utf8_is_cont(p[2]))
+                        return 0;
+                *cp = (c & 0x0F) << 12 | (p[1] & 0x3F) << 6 | (p[2] & 0x3F);
+                return 3;
+        }
+
+        if (c < 0xF5) {
+                unsigned lo = c == 0xF0 ? 0x90 : 0x80;
+                unsigned hi = c == 0xF4 ? 0x8F : 0xBF;
+                if (n < 4 || p[1] < lo || p[1] > hi ||
+                                !cgs_utf8_is_cont(p[2]) ||
+                                !cgs_utf8_is_cont(p[3]))
+                        return 0;
+                *cp = (uint32_t)(c & 0x07) << 18 | (p[1] & 0x3F) << 12 |
+                        (p[2] & 0x3F) << 6 | (p[3] & 0x3F);
+                return 4;
+        }
+
+        return 0;
+}
+
+size_t
+cgs_utf8_ascii_prefix(const char* s, size_t n)
+{
+        size_t i = 0;
+#ifdef __SSE2__
+        for ( ; i + 64 <= n; i += 64) {
+                const __m128i* p = (const __m128i*)&s[i];
+                __m128i v = _mm_or_si128(
+                                _mm_or_si128(_mm_loadu_si128(p),
+                                        _mm_loadu_si128(p + 1)),
+                                _mm_or_si128(_mm_loadu_si128(p + 2),
+                                        _mm_loadu_si128(p + 3)));
+                if (_mm_movemask_epi8(v))
+                        break;
+        }
+        for ( ; i + 16 <= n; i += 16) {
+                __m128i v = _mm_loadu_si128((const __m128i*)&s[i]);
+                unsigned mask = _mm_movemask_epi8(v);
+                if (mask)
+                        return i + __builtin_ctz(mask);
+        }
+#endif
+        for ( ; i < n; ++i)
+                if ((unsigned char)s[i] >= 0x80)
+                        return i;
+        return n;
+}
+
+static size_t
+cgs_utf8_validate_scalar(const char* s, size_t i, size_t n)
+{
+        while (i < n) {
+                if ((unsigned char)s[i] < 0x80) {
+                        i += cgs_utf8_ascii_prefix(&s[i], n - i);
+                        continue;
+                }
+
+                uint32_t cp;
+                size_t len = cgs_utf8_decode(&s[i], n - i, &cp);
+                if (len == 0)
+                        return i;
+                i += len;
+        }
+        return n;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * UTF-8 Vector Validation
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+#ifdef CGS_UTF8_SSSE3
+
+/**
+ * The error flags of the lookup tables. A pair of bytes is in error when a
+ * flag is set in all three lookups. OVERLONG_4 and TOO_LARGE_1000 share a bit
+ * because the lead bytes they apply to, F0 and F5-FF, never overlap.
+ */
+enum cgs_utf8_errors {
+        CGS_UTF8_TOO_SHORT = 1 << 0,    // lead byte, then not a continuation
+        CGS_UTF8_TOO_LONG = 1 << 1,     // ASCII, then a continuation
+        CGS_UTF8_OVERLONG_3 = 1 << 2,   // E0 80-9F
+        CGS_UTF8_TOO_LARGE = 1 << 3,    // F4 90-BF or F5-FF 90-BF
+        CGS_UTF8_SURROGATE = 1 << 4,    // ED A0-BF
+        CGS_UTF8_OVERLONG_2 = 1 << 5,   // C0-C1, then a continuation
+        CGS_UTF8_TOO_LARGE_1000 = 1 << 6,       // F5-FF 80-8F
+        CGS_UTF8_OVERLONG_4 = 1 << 6,   // F0 80-8F
+        CGS_UTF8_TWO_CONTS = 1 << 7,    // a continuation after one
+        CGS_UTF8_CARRY = CGS_UTF8_TOO_SHORT | CGS_UTF8_TOO_LONG |
+                CGS_UTF8_TWO_CONTS,
+};
+
+/**
+ * cgs_utf8_block_errors
+ *
+ * Check a block of 16 bytes given the block before it.
+ *
+ * @return      A vector that is zero if and only if the block is free of
+ *              errors, not counting sequences left incomplete at its end.
+ */
+static inline CGS_UTF8_TARGET_SSSE3 __m128i
+cgs_utf8_block_errors(__m128i input, __m128i prev)
+{
+        enum {
+                SHORT = CGS_UTF8_TOO_SHORT,
+                LONG = CGS_UTF8_TOO_LONG,
+                OVER3 = CGS_UTF8_OVERLONG_3,
+                LARGE = CGS_UTF8_TOO_LARGE,
+                SURR = CGS_UTF8_SURROGATE,
+                OVER2 = CGS_UTF8_OVERLONG_2,
+                L1000 = CGS_UTF8_TOO_LARGE_1000,
+                OVER4 = CGS_UTF8_OVERLONG_4,
+                CONTS = CGS_UTF8_TWO_CONTS,
+                CARRY = CGS_UTF8_CARRY,
+        };
+
+        const __m128i byte_1_high = _mm_setr_epi8(
+                        // 0___ ASCII
+                        LONG, LONG, LONG, LONG, LONG, LONG, LONG, LONG,
+                        // 10__ continuation
+                        CONTS, CONTS, CONTS, CONTS,
+                        // 1100, 1101 two byte lead
+                        SHORT | OVER2, SHORT,
+                        // 1110 three byte lead
+                        SHORT | OVER3 | SURR,
+                        // 1111 four byte lead
+                        SHORT | LARGE | L1000 | OVER4);
+        const __m128i byte_1_low = _mm_setr_epi8(
+                        CARRY | OVER3 | OVER2 | OVER4,          // ____0000
+                        CARRY | OVER2,                          // ____0001
+                        CARRY, CARRY,                           // ____001_
+                        CARRY | LARGE,                          // ____0100
+                        CARRY | LARGE | L1000,                  // ____0101
+                        CARRY | LARGE | L1000,                  // ____011_
+                        CARRY | LARGE | L1000,
+                        CARRY | LARGE | L1000,                  // ____1___
+                        CARRY | LARGE | L1000,
+                        CARRY | LARGE | L1000,
+                        CARRY | LARGE | L1000,
+                        CARRY | LARGE | L1000,
+                        CARRY | LARGE | L1000 | SURR,           // ____1101
+                        CARRY | LARGE | L1000,
+                        CARRY | LARGE | L1000);
+        const __m128i byte_2_high = _mm_setr_epi8(
+                        // 0___ ASCII
+                        SHORT, SHORT, SHORT, SHORT,
+                        SHORT, SHORT, SHORT, SHORT,
+                        // 1000
+                        (char)(LONG | OVER2 | CONTS | OVER3 | L1000 | OVER4),
+                        // 1001
+                        (char)(LONG | OVER2 | CONTS | OVER3 | LARGE),
+                        // 101_
+                        (char)(LONG | OVER2 | CONTS | SURR | LARGE),
+                        (char)(LONG | OVER2 | CONTS | SURR | LARGE),
+                        // 11__ lead
+                        SHORT, SHORT, SHORT, SHORT);
+
+        const __m128i nibble = _mm_set1_epi8(0x0F);
+        __m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+        __m128i special = _mm_and_si128(
+                        _mm_and_si128(
+                                _mm_shuffle_epi8(byte_1_high, _mm_and_si128(
+                                                _mm_srli_epi16(prev1, 4),
+                                                nibble)),
+                                _mm_shuffle_epi8(byte_1_low, _mm_and_si128(
+                                                prev1, nibble))),
+                        _mm_shuffle_epi8(byte_2_high, _mm_and_si128(
+                                        _mm_srli_epi16(input, 4), nibble)));
+
+        // bytes two and three after a 3 or 4 byte lead must be continuations,
+        // which 'special' flags as TWO_CONTS; the two must agree
+        __m128i prev2 = _mm_alignr_epi8(input, prev, 14);
+        __m128i prev3 = _mm_alignr_epi8(input, prev, 13);
+        __m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80));
+        __m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(0xF0 - 0x80));
+        __m128i must23 = _mm_and_si128(_mm_or_si128(third, fourth),
+                        _mm_set1_epi8((char)0x80));
+
+        return _mm_xor_si128(must23, special);
+}
+
+/**
+ * cgs_utf8_validate_ssse3
+ *
+ * Check whole blocks of 16 bytes starting at a sequence boundary.
+ *
+ * @return      A sequence boundary at or before the first error or the
+ *              first unchecked byte, from which the scalar check resumes.
+ */
+static CGS_UTF8_TARGET_SSSE3 size_t
+cgs_utf8_validate_ssse3(const char* s, size_t i, size_t n)
+{
+        // a lead byte in the last 1, 2 or 3 bytes of a block needs more
+        const __m128i max = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1,
+                        -1, -1, -1, -1, -1, (char)0xEF, (char)0xDF,
+                        (char)0xBF);
+        const __m128i zero = _mm_setzero_si128();
+
+        size_t start = i;
+        __m128i prev = zero;
+        __m128i incomplete = zero;
+        for ( ; i + 16 <= n; i += 16) {
+                __m128i input = _mm_loadu_si128((const __m128i*)&s[i]);
+                __m128i err = incomplete;
+                if (_mm_movemask_epi8(input)) {
+                        err = cgs_utf8_block_errors(input, prev);
+                        incomplete = _mm_subs_epu8(input, max);
+                } else {
+                        incomplete = zero;
+                }
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(err, zero)) != 0xFFFF)
+                        break;
+                prev = input;
+        }
+
+        // back up over continuation bytes to a lead that may reach past 'i'
+        for (size_t j = 1; j <= 3 && j <= i - start; ++j) {
+                unsigned char c = s[i - j];
+                if (c >= 0xC0)
+                        return i - j;
+                if (c < 0x80)
+                        break;
+        }
+        return i;
+}
+
+/**
+ * cgs_utf8_has_ssse3
+ *
+ * @return      Whether the vector validator can run on this CPU.
+ */
+static inline int
+cgs_utf8_has_ssse3(void)
+{
+#ifdef CGS_UTF8_SSSE3_DISPATCH
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("ssse3");
+#else
+        return 1;
+#endif
+}
+
+#endif
+
+size_t
+cgs_utf8_validate(const char* s, size_t n)
+{
+        size_t i = cgs_utf8_ascii_prefix(s, n);
+#ifdef CGS_UTF8_SSSE3
+        if (i < n && cgs_utf8_has_ssse3())
+                i = cgs_utf8_validate_ssse3(s, i, n);
+#endif
+        return cgs_utf8_validate_scalar(s, i, n);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
+ * UTF-8 Counting
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+size_t
+cgs_utf8_count(const char* s, size_t n)
+{
+        size_t count = 0;
+        size_t i = 0;
+#ifdef __SSE2__
+        // continuation bytes are the signed bytes below -64; each lane
+        // counts up to 255 blocks before the lanes are summed
+        const __m128i limit = _mm_set1_epi8(-65);
+        while (i + 16 <= n) {
+                size_t blocks = (n - i) / 16;
+                if (blocks > 255)
+                        blocks = 255;
+
+                __m128i acc = _mm_setzero_si128();
+                for (size_t b = 0; b < blocks; ++b, i += 16) {
+                        __m128i v = _mm_loadu_si128((const __m128i*)&s[i]);
+                        acc = _mm_sub_epi8(acc, _mm_cmpgt_epi8(v, limit));
+                }
+                __m128i sum = _mm_sad_epu8(acc, _mm_setzero_si128());
+                count += (size_t)_mm_cvtsi128_si32(sum) +
+                        (size_t)_mm_cvtsi128_si32(_mm_srli_si128(sum, 8));
+        }
+#endif
+        for ( ; i < n; ++i)
+                count += (signed char)s[i] > -65;
+        return count;
+}
@@ -37,7 +37,9 @@
 
 #include "cgs_vector.h"
 #include "cgs_vector_private.h"
+#include "cgs_parallel.h"
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -45,22 +47,102 @@
  * Private Vector Functions
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
 
+int
+cgs_vector_is_local(const struct cgs_vector* v);
+
 void*
-cgs_vector_grow(struct cgs_vector* v)
+cgs_vector_alloc(struct cgs_vector* v, size_t cap)
 {
-	size_t new_capacity = v->capacity == 0
-                ? CGS_VECTOR_INITIAL_CAPACITY
-		: v->capacity * CGS_VECTOR_GROWTH_RATE;
-	
-	char* p = realloc(v->data, v->element_size * new_capacity);
+        if (cgs_vector_is_local(v)) {           // spill to the heap
+                char* p = cgs_alloc(v->alloc, v->element_size * cap);
+                if (!p)
+                        return NULL;
+
+                memcpy(p, v->local.bytes, v->element_size * v->length);
+                v->data = p;
+                v->capacity = cap;
+                return v;
+        }
+
+	char* p = cgs_realloc(v->alloc, v->data,
+                        v->element_size * v->capacity, v->element_size * cap);
         if (!p)
                 return NULL;
 
         v->data = p;
-        v->capacity = new_capacity;
+        v->capacity = cap;
 	return v;
 }
 
+size_t
+cgs_vector_new_capacity(const struct cgs_vector* v)
+{
+        size_t new_capacity = 0;
+        if (v->growth)
+                new_capacity = v->growth(v->capacity);
+        else
+                new_capacity = v->capacity == 0
+                        ? CGS_VECTOR_INITIAL_CAPACITY
+                        : v->capacity * CGS_VECTOR_GROWTH_RATE;
+
+        // a policy that fails to grow would loop forever on push
+        return CGS_MAX(new_capacity, v->capacity + 1);
+}
+
+void*
+cgs_vector_grow(struct cgs_vector* v)
+{
+        return cgs_vector_alloc(v, cgs_vector_new_capacity(v));
+}
+
+void*
+cgs_vector_grow_len(struct cgs_vector* v, size_t len)
+{
+        size_t new_capacity = cgs_vector_new_capacity(v);
+        return cgs_vector_alloc(v, CGS_MAX(len, new_capacity));
+}
+
+/**
+ * cgs_vector_compact
+ *
+ * Remove the elements for which the predicate result matches 'remove'. Kept
+ * elements are moved down in runs so that each survivor is copied at most
+ * once, and the predicate is called exactly once per element in order.
+ *
+ * @param v      The vector.
+ * @param pred   The predicate.
+ * @param data   Userdata for the predicate.
+ * @param remove The (boolean) predicate result that marks an element for
+ *               removal.
+ *
+ * @return       The number of elements removed.
+ */
+static size_t
+cgs_vector_compact(struct cgs_vector* v, CgsPredicate pred, const void* data,
+                int remove)
+{
+        const size_t sz = v->element_size;
+        const size_t len = v->length;
+        char* buf = cgs_vector_data_mut(v);
+
+        size_t dst = 0;
+        size_t run = 0;                 // start of the current kept run
+        for (size_t i = 0; i <= len; ++i) {
+                if (i < len && !pred(&buf[i * sz], data) != !remove)
+                        continue;
+
+                // element i is removed or the end is reached, move the run
+                if (run != dst)
+                        memmove(&buf[dst * sz], &buf[run * sz],
+                                        (i - run) * sz);
+                dst += i - run;
+                run = i + 1;
+        }
+
+        v->length = dst;
+        return len - dst;
+}
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * Vector Management Functions
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
@@ -73,21 +155,42 @@ cgs_vector_new(size_t size)
                 .capacity = 0,
                 .element_size = size,
                 .data = NULL,
+                .growth = NULL,
+                .alloc = cgs_allocator_default(),
         };
 }
 
+struct cgs_vector
+cgs_vector_new_small(size_t size)
+{
+        struct cgs_vector v = cgs_vector_new(size);
+        if (size > 0 && size <= CGS_VECTOR_INLINE_SIZE)
+                v.capacity = CGS_VECTOR_INLINE_SIZE / size;
+        return v;
+}
+
+struct cgs_vector
+cgs_vector_new_with(size_t size, const struct cgs_allocator* a)
+{
+        struct cgs_vector v = cgs_vector_new(size);
+        v.alloc = a;
+        return v;
+}
+
 void*
 cgs_vector_copy(const struct cgs_vector* src, struct cgs_vector* dst)
 {
-        char* p = malloc(src->length * src->element_size);
+        char* p = cgs_alloc(src->alloc, src->length * src->element_size);
         if (!p)
                 return NULL;
 
-        memcpy(p, src->data, src->length * src->element_size);
+        memcpy(p, cgs_vector_data(src), src->length * src->element_size);
         dst->length = src->length;
         dst->capacity = src->length;
         dst->element_size = src->element_size;
         dst->data = p;
+        dst->growth = src->growth;
+        dst->alloc = src->alloc;
 
         return dst;
 }
@@ -96,15 +199,18 @@ void*
 cgs_vector_copy_with(const struct cgs_vector* src, struct cgs_vector* dst,
                 CgsCopyFunc f)
 {
-        // calloc called to set all "members" of empty elements to zero
-        char* p = calloc(src->length, src->element_size);
+        // zero all "members" of empty elements
+        char* p = cgs_alloc(src->alloc, src->length * src->element_size);
         if (!p)
                 return NULL;
+        memset(p, 0, src->length * src->element_size);
 
         dst->length = src->length;
         dst->capacity = src->length;
         dst->element_size = src->element_size;
         dst->data = p;
+        dst->growth = src->growth;
+        dst->alloc = src->alloc;
 
         for (size_t i = 0; i < cgs_vector_length(src); ++i) {
                 const void* t1 = cgs_vector_get(src, i);
@@ -119,7 +225,8 @@ void*
 cgs_vector_from_array(const void* arr, size_t len, size_t size,
                 struct cgs_vector* v)
 {
-        char* p = malloc(len * size);
+        const struct cgs_allocator* a = cgs_allocator_default();
+        char* p = cgs_alloc(a, len * size);
         if (!p)
                 return NULL;
 
@@ -128,6 +235,8 @@ cgs_vector_from_array(const void* arr, size_t len, size_t size,
         v->capacity = len;
         v->element_size = size;
         v->data = p;
+        v->growth = NULL;
+        v->alloc = a;
 
         return v;
 }
@@ -135,40 +244,99 @@ cgs_vector_from_array(const void* arr, size_t len, size_t size,
 void
 cgs_vector_free(struct cgs_vector* v)
 {
-        free(v->data);
+        cgs_free(v->alloc, v->data, v->capacity * v->element_size);
 }
 
 void
 cgs_vector_free_all(struct cgs_vector* v)
 {
-	if (v->data) {
-		for (size_t i = 0, l = v->length; i < l; ++i)
-			free(*(void**)cgs_vector_get(v, i));
-		free(v->data);
-	}
+        for (size_t i = 0, l = v->length; i < l; ++i)
+                free(*(void**)cgs_vector_get(v, i));
+        cgs_vector_free(v);
 }
 
 void
 cgs_vector_free_all_with(struct cgs_vector* v, CgsFreeFunc ff)
 {
-        if (v->data) {
-                for (size_t i = 0, l = v->length; i < l; ++i)
-                        ff(cgs_vector_get_mut(v, i));
-                free(v->data);
-        }
+        for (size_t i = 0, l = v->length; i < l; ++i)
+                ff(cgs_vector_get_mut(v, i));
+        cgs_vector_free(v);
 }
 
 void*
 cgs_vector_xfer(struct cgs_vector* v, size_t* len)
 {
+        if (v->length == 0) {                   // nothing to hand out
+                if (v->data)
+                        cgs_vector_free(v);
+        } else if ((cgs_vector_is_local(v) || v->length < v->capacity)
+                        && !cgs_vector_alloc(v, v->length)) {
+                // exact size so the block is freed with the size callers
+                // can work out
+                return NULL;
+        }
+
 	void* p = v->data;
 	if (len)
 		*len = v->length;
 
+        const struct cgs_allocator* a = v->alloc;
         memset(v, 0, sizeof(struct cgs_vector));
+        v->alloc = a;
 	return p;
 }
 
+void*
+cgs_vector_reserve(struct cgs_vector* v, size_t n)
+{
+        if (n <= v->capacity)
+                return v;
+        return cgs_vector_alloc(v, n);
+}
+
+void*
+cgs_vector_resize(struct cgs_vector* v, size_t n)
+{
+        if (n > v->capacity && !cgs_vector_grow_len(v, n))
+                return NULL;
+
+        if (n > v->length)
+                memset(cgs_vector_get_mut(v, v->length), 0,
+                                (n - v->length) * v->element_size);
+        v->length = n;
+        return v;
+}
+
+void*
+cgs_vector_shrink(struct cgs_vector* v)
+{
+        if (v->length == v->capacity || cgs_vector_is_local(v))
+                return v;
+
+        if (v->length == 0) {
+                cgs_vector_free(v);
+                v->data = NULL;
+                v->capacity = 0;
+                return v;
+        }
+        return cgs_vector_alloc(v, v->length);
+}
+
+void
+cgs_vector_set_growth(struct cgs_vector* v, CgsGrowthFunc f)
+{
+        v->growth = f;
+}
+
+void*
+cgs_vector_set_allocator(struct cgs_vector* v, const struct cgs_allocator* a)
+{
+        if (v->data)
+                return NULL;
+        v->alloc = a;
+        return v;
+}
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
  * Vector Inline Getter Symbols
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
@@ -238,7 +406,7 @@ cgs_vector_pop(struct cgs_vector* v, void* p)
                 return NULL;
 
         --v->length;
-        memcpy(p, &v->data[v->element_size * v->length], v->element_size);
+        memcpy(p, cgs_vector_get(v, v->length), v->element_size);
         return p;
 }
 
@@ -246,18 +414,74 @@ void
 cgs_vector_remove(struct cgs_vector* v, size_t i)
 {
         const size_t sz = v->element_size;
+        char* buf = cgs_vector_data_mut(v);
 
         --v->length;
-        memmove(&v->data[i * sz], &v->data[(i+1) * sz], (v->length - i) * sz);
+        memmove(&buf[i * sz], &buf[(i+1) * sz], (v->length - i) * sz);
 }
 
 void
 cgs_vector_remove_fast(struct cgs_vector* v, size_t i)
 {
         const size_t sz = v->element_size;
+        char* buf = cgs_vector_data_mut(v);
 
         --v->length;
-        memcpy(&v->data[i * sz], &v->data[v->length * sz], sz);
+        memcpy(&buf[i * sz], &buf[v->length * sz], sz);
+}
+
+void*
+cgs_vector_extend(struct cgs_vector* v, const void* arr, size_t len)
+{
+        const size_t new_len = v->length + len;
+        if (new_len > v->capacity && !cgs_vector_grow_len(v, new_len))
+                return NULL;
+
+        if (len > 0)
+                memcpy(cgs_vector_get_mut(v, v->length), arr,
+                                len * v->element_size);
+        v->length = new_len;
+        return v;
+}
+
+void*
+cgs_vector_extend_vec(struct cgs_vector* dst, const struct cgs_vector* src)
+{
+        if (dst->element_size != src->element_size)
+                return NULL;
+        return cgs_vector_extend(dst, cgs_vector_data(src), src->length);
+}
+
+void*
+cgs_vector_insert_range(struct cgs_vector* v, size_t i, const void* arr,
+                size_t len)
+{
+        const size_t sz = v->element_size;
+        const size_t new_len = v->length + len;
+        if (new_len > v->capacity && !cgs_vector_grow_len(v, new_len))
+                return NULL;
+
+        if (len > 0) {
+                char* buf = cgs_vector_data_mut(v);
+                memmove(&buf[(i + len) * sz], &buf[i * sz],
+                                (v->length - i) * sz);
+                memcpy(&buf[i * sz], arr, len * sz);
+        }
+        v->length = new_len;
+        return v;
+}
+
+size_t
+cgs_vector_remove_if(struct cgs_vector* v, CgsPredicate pred,
+                const void* data)
+{
+        return cgs_vector_compact(v, pred, data, CGS_TRUE);
+}
+
+size_t
+cgs_vector_retain(struct cgs_vector* v, CgsPredicate pred, const void* data)
+{
+        return cgs_vector_compact(v, pred, data, CGS_FALSE);
 }
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
@@ -267,7 +491,7 @@ cgs_vector_remove_fast(struct cgs_vector* v, size_t i)
 void
 cgs_vector_sort(struct cgs_vector* v, CgsCmp3Way cmp)
 {
-	qsort(v->data, v->length, v->element_size, cmp);
+	qsort(cgs_vector_data_mut(v), v->length, v->element_size, cmp);
 }
 
 void*
@@ -293,15 +517,142 @@ cgs_vector_transform(struct cgs_vector* v, CgsUnaryOpMut f, void* data)
                 f(cgs_vector_get_mut(v, i), i, data);
 }
 
+/**
+ * struct cgs_vector_parallel
+ *
+ * The state shared by the chunks of a parallel foreach or transform. Only
+ * one of 'f' and 'f_mut' is set.
+ */
+struct cgs_vector_parallel {
+        struct cgs_vector* v;
+        CgsUnaryOp f;
+        CgsUnaryOpMut f_mut;
+        void* data;
+};
+
+static void
+cgs_vector_parallel_chunk(size_t begin, size_t end, size_t id, void* data)
+{
+        (void)id;
+        struct cgs_vector_parallel* job = data;
+        if (job->f_mut)
+                for (size_t i = begin; i < end; ++i)
+                        job->f_mut(cgs_vector_get_mut(job->v, i), i,
+                                        job->data);
+        else
+                for (size_t i = begin; i < end; ++i)
+                        job->f(cgs_vector_get(job->v, i), i, job->data);
+}
+
+static void
+cgs_vector_parallel_run(struct cgs_vector_parallel* job,
+                const struct cgs_parallel_opts* opts)
+{
+        size_t threads = cgs_parallel_threads(opts);
+        size_t chunk = cgs_parallel_chunk(job->v->length,
+                        job->v->element_size, threads, opts);
+        cgs_parallel_for(job->v->length, chunk, threads,
+                        cgs_vector_parallel_chunk, job);
+}
+
+void
+cgs_vector_foreach_parallel(const struct cgs_vector* v, CgsUnaryOp f,
+                void* data, const struct cgs_parallel_opts* opts)
+{
+        // Only read through 'f', the cast just lets both paths share a job
+        struct cgs_vector_parallel job = {
+                .v = (struct cgs_vector*)v,
+                .f = f,
+                .data = data,
+        };
+        cgs_vector_parallel_run(&job, opts);
+}
+
+void
+cgs_vector_transform_parallel(struct cgs_vector* v, CgsUnaryOpMut f,
+                void* data, const struct cgs_parallel_opts* opts)
+{
+        struct cgs_vector_parallel job = { .v = v, .f_mut = f, .data = data };
+        cgs_vector_parallel_run(&job, opts);
+}
+
+/**
+ * struct cgs_vector_reduction
+ *
+ * The state shared by the chunks of a parallel reduction. Partial results
+ * start on a cache line boundary and are padded to whole lines so workers
+ * never share one.
+ */
+struct cgs_vector_reduction {
+        const struct cgs_vector* v;
+        CgsReduceOp f;
+        char* parts;
+        size_t stride;
+        size_t chunk;
+        int ordered;
+};
+
+static void
+cgs_vector_reduce_chunk(size_t begin, size_t end, size_t id, void* data)
+{
+        struct cgs_vector_reduction* r = data;
+        size_t part = r->ordered ? begin / r->chunk : id;
+        void* acc = &r->parts[part * r->stride];
+        for (size_t i = begin; i < end; ++i)
+                r->f(acc, cgs_vector_get(r->v, i));
+}
+
+void*
+cgs_vector_reduce_parallel(const struct cgs_vector* v, void* acc,
+                size_t acc_size, CgsReduceOp f, CgsCombineOp combine,
+                const struct cgs_parallel_opts* opts)
+{
+        if (v->length == 0)
+                return acc;
+
+        size_t threads = cgs_parallel_threads(opts);
+        size_t chunk = cgs_parallel_chunk(v->length, v->element_size,
+                        threads, opts);
+        int ordered = opts && opts->ordered;
+        size_t nparts = ordered ? (v->length + chunk - 1) / chunk : threads;
+
+        struct cgs_vector_reduction r = {
+                .v = v,
+                .f = f,
+                .stride = (acc_size + CGS_PARALLEL_CACHE_LINE - 1)
+                        / CGS_PARALLEL_CACHE_LINE * CGS_PARALLEL_CACHE_LINE,
+                .chunk = chunk,
+                .ordered = ordered,
+        };
+        // over-allocated by a line less a byte so the partials can start
+        // on a line boundary whatever alignment the allocator gives
+        size_t bytes = nparts * r.stride + CGS_PARALLEL_CACHE_LINE - 1;
+        char* block = cgs_alloc(v->alloc, bytes);
+        if (!block)
+                return NULL;
+        r.parts = block + (-(uintptr_t)block & (CGS_PARALLEL_CACHE_LINE - 1));
+        for (size_t i = 0; i < nparts; ++i)
+                memcpy(&r.parts[i * r.stride], acc, acc_size);
+
+        cgs_parallel_for(v->length, chunk, threads, cgs_vector_reduce_chunk,
+                        &r);
+
+        for (size_t i = 0; i < nparts; ++i)
+                combine(acc, &r.parts[i * r.stride]);
+
+        cgs_free(v->alloc, block, bytes);
+        return acc;
+}
+
 const void*
 cgs_vector_min(const struct cgs_vector* v, CgsCmp3Way cmp)
 {
         if (v->length == 0)
                 return NULL;
 
-        const void* min = &v->data[0];
+        const void* min = cgs_vector_get(v, 0);
         for (size_t i = 1; i < v->length; ++i) {
-                const void* p = &v->data[i * v->element_size];
+                const void* p = cgs_vector_get(v, i);
                 if (cmp(min, p) > 0)    // min is greater than this element
                         min = p;
         }
@@ -315,9 +666,9 @@ cgs_vector_max(const struct cgs_vector* v, CgsCmp3Way cmp)
         if (v->length == 0)
                 return NULL;
 
-        const void* max = &v->data[0];
+        const void* max = cgs_vector_get(v, 0);
         for (size_t i = 1; i < v->length; ++i) {
-                const void* p1 = &v->data[i * v->element_size];
+                const void* p1 = cgs_vector_get(v, i);
                 if (cmp(max, p1) < 0)    // max is lesser than this element
                         max = p1;
         }
@@ -39,6 +39,47 @@ enum cgs_vector_constants {
  * Private Vector Functions
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
 
+/**
+ * cgs_vector_is_local
+ *
+ * Check whether a vector is currently storing its elements inline.
+ *
+ * @param v     The vector.
+ *
+ * @return      A boolean integer indicating true(1) or false(0).
+ */
+inline int
+cgs_vector_is_local(const struct cgs_vector* v)
+{
+        return !v->data && v->capacity > 0;
+}
+
+/**
+ * cgs_vector_alloc
+ *
+ * Set the allocation size (capacity) of the provided vector to exactly 'cap'
+ * elements. The length is not checked against the new capacity.
+ *
+ * @param v     The vector to allocate for.
+ * @param cap   The new capacity in elements.
+ *
+ * @return      A pointer back to the vector on success, NULL on failure.
+ */
+void*
+cgs_vector_alloc(struct cgs_vector* v, size_t cap);
+
+/**
+ * cgs_vector_new_capacity
+ *
+ * Calculate the next capacity of a vector using its growth policy.
+ *
+ * @param v     The vector.
+ *
+ * @return      The capacity to grow to.
+ */
+size_t
+cgs_vector_new_capacity(const struct cgs_vector* v);
+
 /**
  * cgs_vector_grow
  *
@@ -50,3 +91,18 @@ enum cgs_vector_constants {
  */
 void*
 cgs_vector_grow(struct cgs_vector* v);
+
+/**
+ * cgs_vector_grow_len
+ *
+ * Increases the allocation size (capacity) of the provided vector to hold at
+ * least 'len' elements. Follows the growth policy when it would provide more
+ * room than requested so that repeated calls remain amortized.
+ *
+ * @param v     The vector to grow.
+ * @param len   The number of elements that must fit.
+ *
+ * @return      A pointer back to the vector on success, NULL on failure.
+ */
+void*
+cgs_vector_grow_len(struct cgs_vector* v, size_t len);
@@ -0,0 +1,258 @@
+#include "cmocka_headers.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "cgs_alloc.h"
+#include "cgs_vector.h"
+#include "cgs_string.h"
+#include "cgs_hashtab.h"
+#include "cgs_heap.h"
+#include "cgs_rbt.h"
+#include "cgs_bst.h"
+#include "cgs_deque.h"
+#include "cgs_segvec.h"
+#include "cgs_compare.h"
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Counting allocator
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+struct counter {
+        size_t allocs;
+        size_t live;
+};
+
+static void*
+counter_alloc(void* ctx, size_t size)
+{
+        struct counter* c = ctx;
+        ++c->allocs;
+        c->live += size;
+        return malloc(size);
+}
+
+static void*
+counter_realloc(void* ctx, void* p, size_t old, size_t size)
+{
+        struct counter* c = ctx;
+        void* q = realloc(p, size);
+        if (q) {
+                ++c->allocs;
+                c->live += size - old;
+        }
+        return q;
+}
+
+static void
+counter_free(void* ctx, void* p, size_t size)
+{
+        struct counter* c = ctx;
+        c->live -= size;
+        free(p);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Tests
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
+
+static void
+alloc_default_test(void** state)
+{
+        (void)state;
+
+        struct counter c = { 0 };
+        struct cgs_allocator a = {
+                counter_alloc, counter_realloc, counter_free, &c,
+        };
+
+        assert_null(cgs_allocator_default());
+        assert_null(cgs_allocator_set_default(&a));
+        assert_ptr_equal(cgs_allocator_default(), &a);
+
+        struct cgs_vector v = cgs_vector_new(sizeof(int));
+        assert_ptr_equal(v.alloc, &a);
+        assert_ptr_equal(cgs_allocator_set_default(NULL), &a);
+
+        // existing containers keep their allocator
+        for (int i = 0; i < 100; ++i)
+                cgs_vector_push(&v, &i);
+        assert_true(c.allocs > 0);
+        assert_int_equal(c.live, v.capacity * sizeof(int));
+
+        cgs_vector_free(&v);
+        assert_int_equal(c.live, 0);
+}
+
+static void
+alloc_containers_test(void** state)
+{
+        (void)state;
+
+        struct counter c = { 0 };
+        struct cgs_allocator a = {
+                counter_alloc, counter_realloc, counter_free, &c,
+        };
+        const struct cgs_allocator* prev = cgs_allocator_set_default(&a);
+
+        struct cgs_string s = cgs_string_new();
+        struct cgs_hashtab ht = cgs_hashtab_new(NULL);
+        struct cgs_heap h = cgs_heap_new(sizeof(int), cgs_int_cmp);
+        struct cgs_rbt rbt = cgs_rbt_new(cgs_int_cmp, NULL);
+        struct cgs_bst bst = cgs_bst_new(cgs_int_cmp, NULL);
+        struct cgs_deque dq = cgs_deque_new(sizeof(int));
+        struct cgs_segvec sv = cgs_segvec_new(sizeof(int));
+
+        cgs_allocator_set_default(prev);
+
+        char key[] = "key00";
+        for (int i = 0; i < 50; ++i) {
+                struct cgs_variant var = { 0 };
+                cgs_variant_set_int(&var, i);
+                key[4] = (char)('0' + i % 10);
+                key[3] = (char)('a' + i / 10);
+
+                assert_non_null(cgs_string_push(&s, 'a' + i % 26));
+                assert_non_null(cgs_hashtab_insert(&ht, key, &var));
+                assert_non_null(cgs_heap_push(&h, &i));
+                assert_non_null(cgs_rbt_insert(&rbt, &var));
+                assert_non_null(cgs_bst_insert(&bst, &var));
+                assert_non_null(cgs_deque_push_front(&dq, &i));
+                assert_non_null(cgs_segvec_push(&sv, &i));
+        }
+        cgs_hashtab_remove(&ht, "keya0");
+        cgs_hashtab_remove(&ht, "missing");
+        assert_true(c.live > 0);
+
+        assert_null(cgs_string_set_allocator(&s, NULL));
+        assert_null(cgs_hashtab_set_allocator(&ht, NULL));
+        assert_null(cgs_heap_set_allocator(&h, NULL));
+        assert_null(cgs_rbt_set_allocator(&rbt, NULL));
+        assert_null(cgs_bst_set_allocator(&bst, NULL));
+        assert_null(cgs_deque_set_allocator(&dq, NULL));
+
+        cgs_string_free(&s);
+        cgs_hashtab_free(&ht);
+        cgs_heap_free(&h);
+        cgs_rbt_free(&rbt);
+        cgs_bst_free(&bst);
+        cgs_deque_free(&dq);
+        cgs_segvec_free(&sv);
+        assert_int_equal(c.live, 0);
+}
+
+static void
+alloc_no_realloc_test(void** state)
+{
+        (void)state;
+
+        // without a realloc hook memory is moved by alloc, copy, free
+        struct counter c = { 0 };
+        struct cgs_allocator a = {
+                counter_alloc, NULL, counter_free, &c,
+        };
+
+        struct cgs_vector v = cgs_vector_new_small(sizeof(int));
+        assert_non_null(cgs_vector_set_allocator(&v, &a));
+        for (int i = 0; i < 100; ++i)
+                cgs_vector_push(&v, &i);
+        assert_null(cgs_vector_set_allocator(&v, NULL));
+        for (int i = 0; i < 100; ++i)
+                assert_int_equal(*(const int*)cgs_vector_get(&v, i), i);
+
+        struct cgs_vector cp = cgs_vector_new(0);
+        assert_non_null(cgs_vector_copy(&v, &cp));
+        assert_ptr_equal(cp.alloc, &a);
+
+        struct cgs_deque dq = cgs_deque_new(0);
+        assert_non_null(cgs_deque_from_vector(&v, &dq));
+        assert_ptr_equal(dq.alloc, &a);
+        assert_int_equal(*(const int*)cgs_deque_back(&dq), 99);
+
+        cgs_vector_free(&cp);
+        cgs_deque_free(&dq);
+        assert_int_equal(c.live, 0);
+}
+
+static void
+alloc_aligned_huge_test(void** state)
+{
+        (void)state;
+
+        struct cgs_vector v = cgs_vector_new_with(sizeof(int),
+                        cgs_allocator_aligned());
+        for (int i = 0; i < 1000; ++i) {
+                assert_non_null(cgs_vector_push(&v, &i));
+                assert_int_equal((uintptr_t)cgs_vector_data(&v)
+                                % CGS_ALLOC_ALIGN, 0);
+        }
+        assert_int_equal(*(const int*)cgs_vector_get(&v, 999), 999);
+        cgs_vector_free(&v);
+
+        // grow across the huge page threshold and back under it
+        const size_t n = CGS_ALLOC_HUGE_PAGE / sizeof(int) + 1000;
+        struct cgs_vector h = cgs_vector_new_with(sizeof(int),
+                        cgs_allocator_huge());
+        assert_ptr_equal(h.alloc, cgs_allocator_huge());
+        for (size_t i = 0; i < n; ++i)
+                assert_non_null(cgs_vector_push(&h, &(int){ (int)i }));
+        assert_int_equal((uintptr_t)cgs_vector_data(&h) % CGS_ALLOC_ALIGN, 0);
+        assert_int_equal(*(const int*)cgs_vector_get(&h, n - 1), (int)n - 1);
+
+        assert_non_null(cgs_vector_resize(&h, 10));
+        assert_non_null(cgs_vector_shrink(&h));
+        assert_int_equal(*(const int*)cgs_vector_get(&h, 9), 9);
+        cgs_vector_free(&h);
+
+        struct cgs_string s = cgs_string_new_with(cgs_allocator_huge());
+        assert_non_null(cgs_string_from("huge", &s));
+        assert_string_equal(cgs_string_data(&s), "huge");
+        cgs_string_free(&s);
+}
+
+static void
+alloc_huge_xfer_test(void** state)
+{
+        (void)state;
+        const struct cgs_allocator* a = cgs_allocator_huge();
+
+        // capacity over the huge page threshold, length under it, so the
+        // handed out block must be freed with its length
+        struct cgs_vector v = cgs_vector_new_with(sizeof(int), a);
+        assert_non_null(cgs_vector_reserve(&v,
+                                CGS_ALLOC_HUGE_PAGE / sizeof(int) + 1));
+        for (int i = 0; i < 100; ++i)
+                assert_non_null(cgs_vector_push(&v, &i));
+
+        size_t len = 0;
+        int* p = cgs_vector_xfer(&v, &len);
+        assert_non_null(p);
+        assert_int_equal(len, 100);
+        assert_int_equal(p[99], 99);
+        cgs_free(a, p, len * sizeof(int));
+
+        struct cgs_string s = cgs_string_new_with(a);
+        for (size_t i = 0; i < CGS_ALLOC_HUGE_PAGE; ++i)
+                assert_non_null(cgs_string_push(&s, 'x'));
+        cgs_string_clear(&s);
+        for (const char* c = "huge"; *c; ++c)
+                assert_non_null(cgs_string_push(&s, *c));
+        assert_true(s.capacity > CGS_ALLOC_HUGE_PAGE);
+        char* str = cgs_string_xfer(&s);
+        assert_non_null(str);
+        assert_string_equal(str, "huge");
+        cgs_free(a, str, strlen(str) + 1);
+}
+
+int main(void)
+{
+        const struct CMUnitTest tests[] = {
+                cmocka_unit_test(alloc_default_test),
+                cmocka_unit_test(alloc_containers_test),
+                cmocka_unit_test(alloc_no_realloc_test),
+                cmocka_unit_test(alloc_aligned_huge_test),
+                cmocka_unit_test(alloc_huge_xfer_test),
+        };
+
+        return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,131 @@
+#include "cmocka_headers.h"
+
+#include "cgs_arena.h"
+#include "cgs_string.h"
+#include "cgs_vector.h"
+
+static void
+arena_alloc_test(void** state)
+{
+        (void)state;
+
+        struct cgs_arena a = cgs_arena_new(256);
+        struct cgs_arena_stats st = cgs_arena_stats(&a);
+        assert_int_equal(st.chunks, 0);
+
+        char* p1 = cgs_arena_alloc(&a, 10);
+        char* p2 = cgs_arena_alloc(&a, 10);
+        assert_non_null(p1);
+        assert_non_null(p2);
+        assert_int_equal((uintptr_t)p1 % CGS_ARENA_ALIGN, 0);
+        assert_int_equal((uintptr_t)p2 % CGS_ARENA_ALIGN, 0);
+        assert_true(p2 >= p1 + 10);
+
+        char* p3 = cgs_arena_alloc_aligned(&a, 8, 64);
+        assert_int_equal((uintptr_t)p3 % 64, 0);
+
+        // larger than a chunk gets a chunk of its own
+        size_t first = cgs_arena_stats(&a).reserved;
+        assert_true(first >= 256);
+        char* big = cgs_arena_alloc(&a, first + 1);
+        assert_non_null(big);
+        memset(big, 0xAB, first + 1);
+
+        st = cgs_arena_stats(&a);
+        assert_int_equal(st.chunks, 2);
+        assert_int_equal(st.chunks_used, 2);
+        assert_true(st.used >= first + 29);
+        assert_true(st.reserved >= 2 * first + 1);
+
+        char* s = cgs_arena_strdup(&a, "arena");
+        assert_string_equal(s, "arena");
+
+        cgs_arena_free(&a);
+        st = cgs_arena_stats(&a);
+        assert_int_equal(st.chunks, 0);
+}
+
+static void
+arena_mark_rewind_test(void** state)
+{
+        (void)state;
+
+        struct cgs_arena a = cgs_arena_new(128);
+        char* keep = cgs_arena_alloc(&a, 16);
+        strcpy(keep, "keep");
+
+        struct cgs_arena_mark outer = cgs_arena_mark(&a);
+        char* p1 = cgs_arena_alloc(&a, 64);
+
+        struct cgs_arena_mark inner = cgs_arena_mark(&a);
+        for (int i = 0; i < 20; ++i)
+                assert_non_null(cgs_arena_alloc(&a, 100));
+        size_t chunks = cgs_arena_stats(&a).chunks;
+
+        cgs_arena_rewind(&a, inner);
+        assert_ptr_equal(cgs_arena_alloc(&a, 8), p1 + 64);
+
+        cgs_arena_rewind(&a, outer);
+        assert_ptr_equal(cgs_arena_alloc(&a, 64), p1);
+        assert_string_equal(keep, "keep");
+
+        // spare chunks are reused rather than reallocated
+        for (int i = 0; i < 20; ++i)
+                assert_non_null(cgs_arena_alloc(&a, 100));
+        assert_int_equal(cgs_arena_stats(&a).chunks, chunks);
+
+        cgs_arena_reset(&a);
+        struct cgs_arena_stats st = cgs_arena_stats(&a);
+        assert_int_equal(st.used, 0);
+        assert_int_equal(st.chunks_used, 1);
+        assert_int_equal(st.chunks, chunks);
+        assert_ptr_equal(cgs_arena_alloc(&a, 16), keep);
+
+        cgs_arena_free(&a);
+}
+
+static void
+arena_containers_test(void** state)
+{
+        (void)state;
+
+        struct cgs_arena a = cgs_arena_new(0);
+        const struct cgs_allocator* prev =
+                cgs_allocator_set_default(cgs_arena_allocator(&a));
+
+        struct cgs_string s = cgs_string_new();
+        for (int i = 0; i < 1000; ++i)
+                assert_non_null(cgs_string_push(&s, 'a' + i % 26));
+
+        // the string grew in place at the end of the arena
+        assert_int_equal(cgs_arena_stats(&a).used, s.capacity);
+
+        struct cgs_vector v = cgs_vector_new(sizeof(int));
+        for (int i = 0; i < 1000; ++i)
+                assert_non_null(cgs_vector_push(&v, &i));
+
+        struct cgs_strsub ss = cgs_strsub_new(cgs_string_data(&s), 5);
+        char* p = cgs_strsub_to_str(&ss);
+        assert_string_equal(p, "abcde");
+
+        cgs_allocator_set_default(prev);
+
+        assert_int_equal(cgs_string_char(&s, 27), 'b');
+        assert_int_equal(*(const int*)cgs_vector_get(&v, 999), 999);
+
+        // individual frees are no-ops, the arena releases everything
+        cgs_string_free(&s);
+        cgs_vector_free(&v);
+        cgs_arena_free(&a);
+}
+
+int main(void)
+{
+        const struct CMUnitTest tests[] = {
+                cmocka_unit_test(arena_alloc_test),
+                cmocka_unit_test(arena_mark_rewind_test),
+                cmocka_unit_test(arena_containers_test),
+        };
+
+        return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -93,6 +93,20 @@ static void compare_str_test(void** state)
 	assert_true(cgs_str_cmp(&e, &f) > 0);
 }
 
+static void compare_str_nocase_test(void** state)
+{
+	(void)state;
+
+	const char* a = "Howdy";
+	const char* b = "hOWDY";
+	const char* c = "Less";
+	const char* d = "more";
+
+	assert_true(cgs_str_cmp_nocase(&a, &b) == 0);
+	assert_true(cgs_str_cmp_nocase(&c, &d) < 0);
+	assert_true(cgs_str_cmp_nocase(&d, &c) > 0);
+}
+
 int main(void)
 {
 	const struct CMUnitTest tests[] = {
@@ -100,6 +114,7 @@ int main(void)
 		cmocka_unit_test(compare_int_rev_test),
 		cmocka_unit_test(compare_char_test),
 		cmocka_unit_test(compare_str_test),
+		cmocka_unit_test(compare_str_nocase_test),
 	};
 
 	return cmocka_run_group_tests(tests, NULL, NULL);
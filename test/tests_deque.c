@@ -0,0 +1,192 @@
+#include "cmocka_headers.h"
+
+#include "cgs_deque.h"
+#include "cgs_vector.h"
+
+static void
+deque_new_test(void** state)
+{
+        (void)state;
+
+        struct cgs_deque dq = cgs_deque_new(sizeof(int));
+        assert_int_equal(cgs_deque_length(&dq), 0);
+        assert_int_equal(dq.capacity, 0);
+        assert_null(dq.data);
+
+        assert_non_null(cgs_deque_reserve(&dq, 20));
+        assert_int_equal(dq.capacity, 32);
+
+        cgs_deque_free(&dq);
+}
+
+static void
+deque_push_pop_test(void** state)
+{
+        (void)state;
+
+        struct cgs_deque dq = cgs_deque_new(sizeof(int));
+        for (int i = 0; i < 10; ++i)
+                assert_non_null(cgs_deque_push_back(&dq, &i));
+        for (int i = -1; i >= -10; --i)
+                assert_non_null(cgs_deque_push_front(&dq, &i));
+
+        assert_int_equal(cgs_deque_length(&dq), 20);
+        assert_int_equal(*(const int*)cgs_deque_front(&dq), -10);
+        assert_int_equal(*(const int*)cgs_deque_back(&dq), 9);
+        for (int i = 0; i < 20; ++i)
+                assert_int_equal(*(const int*)cgs_deque_get(&dq, i), i - 10);
+
+        int x = 0;
+        assert_non_null(cgs_deque_pop_front(&dq, &x));
+        assert_int_equal(x, -10);
+        assert_non_null(cgs_deque_pop_back(&dq, &x));
+        assert_int_equal(x, 9);
+        assert_non_null(cgs_deque_pop_back(&dq, NULL));
+        assert_int_equal(cgs_deque_length(&dq), 17);
+
+        cgs_deque_clear(&dq);
+        assert_null(cgs_deque_pop_front(&dq, &x));
+        assert_null(cgs_deque_pop_back(&dq, &x));
+
+        cgs_deque_free(&dq);
+}
+
+static void
+deque_fifo_wrap_test(void** state)
+{
+        (void)state;
+
+        // keep the ring partially full while the head laps the buffer
+        struct cgs_deque dq = cgs_deque_new(sizeof(int));
+        int next_in = 0;
+        int next_out = 0;
+        for (int round = 0; round < 100; ++round) {
+                for (int i = 0; i < 5; ++i, ++next_in)
+                        cgs_deque_push_back(&dq, &next_in);
+                for (int i = 0; i < 4; ++i, ++next_out) {
+                        int x = -1;
+                        cgs_deque_pop_front(&dq, &x);
+                        assert_int_equal(x, next_out);
+                }
+        }
+        assert_int_equal(cgs_deque_length(&dq), 100);
+        for (size_t i = 0; i < 100; ++i)
+                assert_int_equal(*(const int*)cgs_deque_get(&dq, i),
+                                next_out + (int)i);
+
+        cgs_deque_free(&dq);
+}
+
+static void
+deque_bulk_test(void** state)
+{
+        (void)state;
+
+        const int arr[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+        struct cgs_deque dq = cgs_deque_new(sizeof(int));
+        assert_non_null(cgs_deque_reserve(&dq, 16));
+
+        // force a wrap: head near the end of the buffer
+        assert_non_null(cgs_deque_push_back_n(&dq, arr, 10));
+        assert_non_null(cgs_deque_pop_front_n(&dq, NULL, 10));
+        assert_int_equal(dq.head, 10);
+
+        assert_non_null(cgs_deque_push_back_n(&dq, arr, 10));
+        assert_non_null(cgs_deque_push_front_n(&dq, arr, 5));
+        assert_int_equal(cgs_deque_length(&dq), 15);
+        assert_int_equal(dq.capacity, 16);
+
+        const int expect[] = { 0, 1, 2, 3, 4, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+        for (size_t i = 0; i < CGS_ARRAY_LENGTH(expect); ++i)
+                assert_int_equal(*(const int*)cgs_deque_get(&dq, i),
+                                expect[i]);
+
+        int out[8] = { 0 };
+        assert_non_null(cgs_deque_pop_back_n(&dq, out, 3));
+        assert_int_equal(out[0], 7);
+        assert_int_equal(out[2], 9);
+        assert_non_null(cgs_deque_pop_front_n(&dq, out, 7));
+        assert_memory_equal(out, expect, 7 * sizeof(int));
+        assert_null(cgs_deque_pop_front_n(&dq, out, 6));
+        assert_int_equal(cgs_deque_length(&dq), 5);
+
+        // growth unrolls the ring
+        assert_non_null(cgs_deque_push_back_n(&dq, arr, 10));
+        assert_int_equal(dq.capacity, 16);
+        assert_non_null(cgs_deque_push_back_n(&dq, arr, 10));
+        assert_int_equal(dq.capacity, 32);
+        assert_int_equal(dq.head, 0);
+        assert_int_equal(*(const int*)cgs_deque_front(&dq), 2);
+        assert_int_equal(*(const int*)cgs_deque_back(&dq), 9);
+
+        cgs_deque_free(&dq);
+}
+
+static void
+accum_int(const void* p, size_t i, void* data)
+{
+        *(long*)data += *(const int*)p * (long)i;
+}
+
+static void
+deque_foreach_test(void** state)
+{
+        (void)state;
+
+        struct cgs_deque dq = cgs_deque_new(sizeof(int));
+        for (int i = 0; i < 6; ++i)
+                cgs_deque_push_front(&dq, &i);
+
+        long sum = 0;
+        cgs_deque_foreach(&dq, accum_int, &sum);
+        // elements are 5..0 at indices 0..5
+        assert_int_equal(sum, 0*5 + 1*4 + 2*3 + 3*2 + 4*1 + 5*0);
+
+        cgs_deque_free(&dq);
+}
+
+static void
+deque_from_vector_test(void** state)
+{
+        (void)state;
+
+        const int arr[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+        struct cgs_vector v = cgs_vector_new(0);
+        assert_non_null(cgs_vector_from_array(arr, 12, sizeof(int), &v));
+
+        struct cgs_deque dq = cgs_deque_new(0);
+        assert_non_null(cgs_deque_from_vector(&v, &dq));
+        assert_int_equal(cgs_vector_length(&v), 0);
+        assert_int_equal(cgs_deque_length(&dq), 12);
+        assert_int_equal(dq.capacity, 16);
+        assert_int_equal(*(const int*)cgs_deque_back(&dq), 12);
+
+        int x = 0;
+        cgs_deque_push_front(&dq, &x);
+        assert_int_equal(*(const int*)cgs_deque_get(&dq, 1), 1);
+        cgs_deque_free(&dq);
+
+        struct cgs_vector sv = cgs_vector_new_small(sizeof(int));
+        cgs_vector_push(&sv, &arr[0]);
+        cgs_vector_push(&sv, &arr[1]);
+        assert_non_null(cgs_deque_from_vector(&sv, &dq));
+        assert_int_equal(cgs_deque_length(&dq), 2);
+        assert_int_equal(dq.capacity, 8);
+        assert_int_equal(*(const int*)cgs_deque_back(&dq), 2);
+        cgs_vector_free(&sv);
+        cgs_deque_free(&dq);
+}
+
+int main(void)
+{
+        const struct CMUnitTest tests[] = {
+                cmocka_unit_test(deque_new_test),
+                cmocka_unit_test(deque_push_pop_test),
+                cmocka_unit_test(deque_fifo_wrap_test),
+                cmocka_unit_test(deque_bulk_test),
+                cmocka_unit_test(deque_foreach_test),
+                cmocka_unit_test(deque_from_vector_test),
+        };
+
+        return cmocka_run_group_tests(tests, NULL, NULL);
+}
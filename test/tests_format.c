@@ -0,0 +1,135 @@
+#include "cmocka_headers.h"
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cgs_format.h"
+
+static void
+format_int_test(void** state)
+{
+        (void)state;
+
+        char buf[CGS_FORMAT_INT_SIZE];
+        char expect[32];
+
+        assert_int_equal(cgs_format_u64(buf, 0), 1);
+        assert_string_equal(buf, "0");
+        assert_int_equal(cgs_format_u64(buf, UINT64_MAX), 20);
+        assert_string_equal(buf, "18446744073709551615");
+        assert_int_equal(cgs_format_i64(buf, INT64_MIN), 20);
+        assert_string_equal(buf, "-9223372036854775808");
+        assert_int_equal(cgs_format_i64(buf, -7), 2);
+        assert_string_equal(buf, "-7");
+
+        // every length, and the values either side of each power of ten
+        for (uint64_t p = 10, i = 0; i < 19; ++i, p *= 10) {
+                for (uint64_t n = p - 1; n <= p; ++n) {
+                        size_t len = cgs_format_u64(buf, n);
+                        snprintf(expect, sizeof(expect), "%" PRIu64, n);
+                        assert_int_equal(len, strlen(expect));
+                        assert_string_equal(buf, expect);
+                }
+        }
+}
+
+static void
+format_double_test(void** state)
+{
+        (void)state;
+
+        const double vals[] = { 0.0, -0.0, 1.0, 100.0, 0.1, -0.001, 1e-5,
+                123456789.0, 1e16, 1e17, 5e-324, 2.2250738585072014e-308,
+                1.7976931348623157e308, 9007199254740993.0, 0.1 + 0.2,
+                1.0 / 0.0, -1.0 / 0.0,
+        };
+        const char* expect[] = { "0", "-0", "1", "100", "0.1", "-0.001",
+                "1e-05", "123456789", "10000000000000000",
+                "1e+17", "5e-324", "2.2250738585072014e-308",
+                "1.7976931348623157e+308", "9007199254740992",
+                "0.30000000000000004", "inf", "-inf",
+        };
+
+        char buf[CGS_FORMAT_DOUBLE_SIZE];
+        for (size_t i = 0; i < sizeof(vals) / sizeof(vals[0]); ++i) {
+                size_t len = cgs_format_double(buf, vals[i]);
+                assert_int_equal(len, strlen(buf));
+                assert_string_equal(buf, expect[i]);
+        }
+}
+
+/**
+ * shortest_digits
+ *
+ * The fewest significant digits that round-trip, by brute force.
+ */
+static int
+shortest_digits(double d)
+{
+        char tmp[64];
+        for (int prec = 1; ; ++prec) {
+                snprintf(tmp, sizeof(tmp), "%.*e", prec - 1, d);
+                if (strtod(tmp, NULL) == d)
+                        return prec;
+        }
+}
+
+static int
+count_digits(const char* s)
+{
+        // significant digits before any exponent
+        int count = 0, seen = 0, zeros = 0;
+        for ( ; *s && *s != 'e'; ++s) {
+                if (*s < '0' || *s > '9')
+                        continue;
+                if (*s == '0') {
+                        if (seen)
+                                ++zeros;
+                        continue;
+                }
+                count += seen ? zeros + 1 : 1;
+                seen = 1;
+                zeros = 0;
+        }
+        return count ? count : 1;
+}
+
+static void
+format_double_random_test(void** state)
+{
+        (void)state;
+
+        char buf[CGS_FORMAT_DOUBLE_SIZE];
+        uint64_t x = 1;
+        for (int i = 0; i < 100000; ++i) {
+                x = x * 6364136223846793005u + 1442695040888963407u;
+                uint64_t bits = x;
+                if (i % 4 == 0)                 // short decimals too
+                        bits = 0;
+                double d;
+                memcpy(&d, &bits, sizeof(d));
+                if (i % 4 == 0)
+                        d = (double)(x >> 40) / 1000.0;
+                if (d != d || d - d != 0.0)     // skip nan and inf
+                        continue;
+
+                size_t len = cgs_format_double(buf, d);
+                assert_true(len < CGS_FORMAT_DOUBLE_SIZE);
+                assert_true(strtod(buf, NULL) == d);
+                assert_int_equal(count_digits(buf), shortest_digits(d));
+        }
+}
+
+int main(void)
+{
+        const struct CMUnitTest tests[] = {
+                cmocka_unit_test(format_int_test),
+                cmocka_unit_test(format_double_test),
+                cmocka_unit_test(format_double_random_test),
+        };
+
+        return cmocka_run_group_tests(tests, NULL, NULL);
+}
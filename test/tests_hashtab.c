@@ -1,6 +1,7 @@
 #include "cmocka_headers.h"
 #include <stdio.h>
 
+#include "cgs_compare.h"
 #include "cgs_hashtab.h"
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * 
@@ -294,6 +295,37 @@ hashtab_iter_test(void** state)
         cgs_hashtab_free(&legtab);
 }
 
+static void
+hashtab_nocase_test(void** state)
+{
+        (void)state;
+        struct cgs_hashtab h = cgs_hashtab_new(NULL);
+        h.hash = cgs_hash_str_nocase;
+        h.cmp = cgs_str_cmp_nocase;
+
+        for (size_t i = 0; i < top_scorers_len; ++i) {
+                const struct goal_scorer* gs = &top_scorers[i];
+                struct cgs_variant* pv = cgs_hashtab_get(&h, gs->name);
+                cgs_variant_set_int(pv, gs->goals);
+        }
+
+        const int* g = cgs_hashtab_lookup(&h, "JOE SAKIC");
+        assert_non_null(g);
+        assert_int_equal(*g, 625);
+
+        g = cgs_hashtab_lookup(&h, "teemu selanne");
+        assert_non_null(g);
+        assert_int_equal(*g, 684);
+
+        assert_null(cgs_hashtab_insert(&h, "wAYNE gRETZKY", NULL));
+        assert_int_equal(cgs_hashtab_length(&h), top_scorers_len);
+
+        assert_int_equal(cgs_hash_str_nocase("Mixed Case", 1009),
+                        cgs_hash_str("mixed case", 1009));
+
+        cgs_hashtab_free(&h);
+}
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
  * Main
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
@@ -309,6 +341,7 @@ int main(void)
                 cmocka_unit_test(hashtab_current_load_test),
                 cmocka_unit_test(hashtab_rehash_test),
                 cmocka_unit_test(hashtab_iter_test),
+                cmocka_unit_test(hashtab_nocase_test),
 	};
 
 	return cmocka_run_group_tests(tests, NULL, NULL);
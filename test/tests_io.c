@@ -2,7 +2,10 @@
 
 #include "cgs_io.h"
 
+#include <fcntl.h>
 #include <stdlib.h>	// free
+#include <string.h>
+#include <unistd.h>
 
 const char* const data_path = "io_test_data.txt";
 
@@ -139,10 +142,129 @@ readfile_test(void** state)
 
         assert_non_null(cgs_io_readfile(data_path, &buff1));
         assert_int_equal(cgs_string_length(&buff1), 45);
+        assert_string_equal(cgs_string_data(&buff1),
+                        "Birthday\nChristmas\nTuesday\nBooks for reading\n");
+
+        // appends
+        assert_non_null(cgs_io_readfile(data_path, &buff1));
+        assert_int_equal(cgs_string_length(&buff1), 90);
+        assert_int_equal(strlen(cgs_string_data(&buff1)), 90);
+
+        assert_null(cgs_io_readfile("no_such_file.txt", &buff1));
 
         cgs_string_free(&buff1);
 }
 
+static void
+readfile_unsized_test(void** state)
+{
+        (void)state;
+        // reports a size of 0 so it takes the chunked path
+        const char* path = "/proc/self/status";
+        if (access(path, R_OK) != 0)
+                skip();
+
+        struct cgs_string buff = cgs_string_new();
+        assert_non_null(cgs_io_readfile(path, &buff));
+        assert_true(cgs_string_length(&buff) > 0);
+        assert_int_equal(strlen(cgs_string_data(&buff)),
+                        cgs_string_length(&buff));
+        assert_memory_equal(cgs_string_data(&buff), "Name:", 5);
+
+        cgs_string_free(&buff);
+}
+
+static void
+map_test(void** state)
+{
+        (void)state;
+        struct cgs_io_mapping map;
+        assert_non_null(cgs_io_map(data_path, &map));
+        struct cgs_strsub ss = cgs_io_mapping_strsub(&map);
+        assert_true(cgs_strsub_eq_str(&ss,
+                        "Birthday\nChristmas\nTuesday\nBooks for reading\n"));
+        cgs_io_unmap(&map);
+        assert_null(map.data);
+        assert_int_equal(map.length, 0);
+
+        const char* empty_path = "io_test_empty.txt";
+        FILE* file = fopen(empty_path, "w");
+        assert_non_null(file);
+        fclose(file);
+        assert_non_null(cgs_io_map(empty_path, &map));
+        assert_int_equal(map.length, 0);
+        cgs_io_unmap(&map);
+        remove(empty_path);
+
+        assert_null(cgs_io_map("no_such_file.txt", &map));
+}
+
+static void
+reader_fd_test(void** state)
+{
+        (void)state;
+        int fd = open(data_path, O_RDONLY);
+        assert_true(fd >= 0);
+
+        struct cgs_reader r = cgs_reader_new_fd(fd);
+        struct cgs_strsub line;
+        const char* const expect[] = {
+                "Birthday", "Christmas", "Tuesday", "Books for reading",
+        };
+        for (size_t i = 0; i < 4; ++i) {
+                assert_non_null(cgs_reader_getline(&r, &line));
+                assert_true(cgs_strsub_eq_str(&line, expect[i]));
+        }
+        assert_null(cgs_reader_getline(&r, &line));
+        assert_int_equal(cgs_reader_error(&r), 0);
+
+        cgs_reader_free(&r);
+        close(fd);
+}
+
+static void
+reader_file_test(void** state)
+{
+        (void)state;
+
+        // empty lines, a line longer than the buffer, no final newline
+        enum { LONG = CGS_READER_BUFFER_SIZE * 2 + 123 };
+        char* big = malloc(LONG);
+        assert_non_null(big);
+        for (size_t i = 0; i < LONG; ++i)
+                big[i] = 'a' + i % 26;
+
+        FILE* file = tmpfile();
+        assert_non_null(file);
+        fputs("first\n\n", file);
+        fwrite(big, 1, LONG, file);
+        fputs("\nlast;with;fields", file);
+        rewind(file);
+
+        struct cgs_reader r = cgs_reader_new_file(file);
+        struct cgs_strsub line;
+        assert_non_null(cgs_reader_getline(&r, &line));
+        assert_true(cgs_strsub_eq_str(&line, "first"));
+        assert_non_null(cgs_reader_getline(&r, &line));
+        assert_int_equal(line.length, 0);
+        assert_non_null(cgs_reader_getline(&r, &line));
+        assert_int_equal(line.length, LONG);
+        assert_memory_equal(line.data, big, LONG);
+
+        assert_non_null(cgs_reader_getdelim(&r, ';', &line));
+        assert_true(cgs_strsub_eq_str(&line, "last"));
+        assert_non_null(cgs_reader_getdelim(&r, ';', &line));
+        assert_true(cgs_strsub_eq_str(&line, "with"));
+        assert_non_null(cgs_reader_getdelim(&r, ';', &line));
+        assert_true(cgs_strsub_eq_str(&line, "fields"));
+        assert_null(cgs_reader_getdelim(&r, ';', &line));
+        assert_int_equal(cgs_reader_error(&r), 0);
+
+        cgs_reader_free(&r);
+        fclose(file);
+        free(big);
+}
+
 int main(void)
 {
 	const struct CMUnitTest tests[] = {
@@ -153,6 +275,10 @@ int main(void)
 		cmocka_unit_test_setup_teardown(io_readlines_test,
 				setup_file_read, teardown_file_read),
                 cmocka_unit_test(readfile_test),
+                cmocka_unit_test(readfile_unsized_test),
+                cmocka_unit_test(map_test),
+                cmocka_unit_test(reader_fd_test),
+                cmocka_unit_test(reader_file_test),
 	};
 
 	return cmocka_run_group_tests(tests, setup_file_content, NULL);
@@ -0,0 +1,167 @@
+/* tests_multimatch.c
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "cmocka_headers.h"
+
+#include "cgs_multimatch.h"
+
+#include <string.h>
+
+static void
+add_patterns(struct cgs_multimatch* mm, const char** pats, size_t n)
+{
+        for (size_t i = 0; i < n; ++i) {
+                struct cgs_strsub ss = cgs_strsub_from_str(pats[i]);
+                assert_non_null(cgs_multimatch_add(mm, &ss));
+        }
+        assert_non_null(cgs_multimatch_compile(mm));
+}
+
+static void
+multimatch_classic_test(void** state)
+{
+        (void)state;
+        const char* pats[] = { "he", "she", "his", "hers" };
+
+        struct cgs_multimatch mm = cgs_multimatch_new();
+        add_patterns(&mm, pats, 4);
+        assert_int_equal(cgs_multimatch_count(&mm), 4);
+
+        // every match, overlapping ones included, ordered by end position
+        struct cgs_strsub text = cgs_strsub_from_str("ushers");
+        struct cgs_vector hits = cgs_vector_new(
+                        sizeof(struct cgs_multimatch_hit));
+        assert_non_null(cgs_multimatch_find_all(&mm, &text, &hits));
+        assert_int_equal(cgs_vector_length(&hits), 3);
+
+        const struct cgs_multimatch_hit* h = cgs_vector_data(&hits);
+        assert_int_equal(h[0].id, 1);           // "she" at 1
+        assert_int_equal(h[0].offset, 1);
+        assert_int_equal(h[1].id, 0);           // "he" at 2
+        assert_int_equal(h[1].offset, 2);
+        assert_int_equal(h[2].id, 3);           // "hers" at 2
+        assert_int_equal(h[2].offset, 2);
+
+        cgs_vector_free(&hits);
+        cgs_multimatch_free(&mm);
+}
+
+static void
+count_hits(const void* hit, size_t i, void* data)
+{
+        const struct cgs_multimatch_hit* h = hit;
+        size_t* counts = data;
+        (void)i;
+        ++counts[h->id];
+}
+
+static void
+multimatch_scan_test(void** state)
+{
+        (void)state;
+        // nested, duplicate and binary patterns
+        const char* pats[] = { "a", "aa", "aaa", "aa", "b\xff" };
+
+        struct cgs_multimatch mm = cgs_multimatch_new();
+        add_patterns(&mm, pats, 5);
+
+        struct cgs_string s = cgs_string_new();
+        cgs_string_from("aaaa b\xff b", &s);
+
+        size_t counts[5] = { 0 };
+        size_t n = cgs_multimatch_scan_string(&mm, &s, count_hits, counts);
+        assert_int_equal(counts[0], 4);
+        assert_int_equal(counts[1], 3);
+        assert_int_equal(counts[2], 2);
+        assert_int_equal(counts[3], 3);
+        assert_int_equal(counts[4], 1);
+        assert_int_equal(n, 13);
+
+        // adding a pattern requires compiling again
+        struct cgs_strsub sp = cgs_strsub_from_str(" ");
+        assert_non_null(cgs_multimatch_add(&mm, &sp));
+        assert_int_equal(cgs_multimatch_scan_string(&mm, &s, count_hits,
+                                counts), 0);
+        assert_non_null(cgs_multimatch_compile(&mm));
+
+        size_t more[6] = { 0 };
+        cgs_multimatch_scan_string(&mm, &s, count_hits, more);
+        assert_int_equal(more[5], 2);
+
+        // empty patterns are refused
+        struct cgs_strsub empty = cgs_strsub_new("", 0);
+        assert_null(cgs_multimatch_add(&mm, &empty));
+
+        cgs_string_free(&s);
+        cgs_multimatch_free(&mm);
+}
+
+static void
+multimatch_reference_test(void** state)
+{
+        (void)state;
+        enum { LEN = 2000, PATS = 40 };
+
+        char text[LEN];
+        unsigned x = 3;
+        for (size_t i = 0; i < LEN; ++i) {
+                x = x * 1103515245u + 12345u;
+                text[i] = "abcd"[(x >> 16) % 4];
+        }
+
+        // patterns cut from the text itself so that they all occur
+        struct cgs_multimatch mm = cgs_multimatch_new();
+        struct cgs_strsub pats[PATS];
+        for (size_t i = 0; i < PATS; ++i) {
+                pats[i] = cgs_strsub_new(&text[i * 37], 1 + i % 7);
+                assert_non_null(cgs_multimatch_add(&mm, &pats[i]));
+        }
+        assert_non_null(cgs_multimatch_compile(&mm));
+
+        size_t counts[PATS] = { 0 };
+        struct cgs_strsub t = cgs_strsub_new(text, LEN);
+        cgs_multimatch_scan(&mm, &t, count_hits, counts);
+
+        for (size_t i = 0; i < PATS; ++i) {
+                size_t expect = 0;
+                for (size_t j = 0; j + pats[i].length <= LEN; ++j)
+                        if (memcmp(&text[j], pats[i].data,
+                                                pats[i].length) == 0)
+                                ++expect;
+                assert_int_equal(counts[i], expect);
+        }
+
+        cgs_multimatch_free(&mm);
+}
+
+int main(void)
+{
+        const struct CMUnitTest tests[] = {
+                cmocka_unit_test(multimatch_classic_test),
+                cmocka_unit_test(multimatch_scan_test),
+                cmocka_unit_test(multimatch_reference_test),
+        };
+
+        return cmocka_run_group_tests(tests, NULL, NULL);
+}
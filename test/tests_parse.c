@@ -0,0 +1,203 @@
+#include "cmocka_headers.h"
+
+#include <locale.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cgs_parse.h"
+
+static void
+parse_u64_test(void** state)
+{
+        (void)state;
+
+        uint64_t u = 0;
+        const char* s = "  12345678901234567890,";
+        const char* p = cgs_parse_u64(s, strlen(s), 10, &u);
+        assert_ptr_equal(p, s + 22);
+        assert_true(u == 12345678901234567890u);
+
+        s = "18446744073709551615";
+        assert_non_null(cgs_parse_u64(s, strlen(s), 10, &u));
+        assert_true(u == UINT64_MAX);
+
+        // one past the maximum, and one digit too many
+        s = "18446744073709551616";
+        assert_null(cgs_parse_u64(s, strlen(s), 10, &u));
+        s = "184467440737095516150";
+        assert_null(cgs_parse_u64(s, strlen(s), 10, &u));
+
+        // leading zeros do not count towards overflow
+        s = "0000000000000000000000042";
+        assert_non_null(cgs_parse_u64(s, strlen(s), 10, &u));
+        assert_true(u == 42);
+
+        assert_null(cgs_parse_u64("-1", 2, 10, &u));
+        assert_non_null(cgs_parse_u64("-0", 2, 10, &u));
+        assert_null(cgs_parse_u64("", 0, 10, &u));
+        assert_null(cgs_parse_u64("x", 1, 10, &u));
+        assert_null(cgs_parse_u64("1", 1, 8, &u));
+
+        // only the given length is read
+        s = "123456";
+        assert_ptr_equal(cgs_parse_u64(s, 3, 10, &u), s + 3);
+        assert_true(u == 123);
+}
+
+static void
+parse_hex_test(void** state)
+{
+        (void)state;
+
+        uint64_t u = 0;
+        const char* s = "0xDeadBeef!";
+        assert_ptr_equal(cgs_parse_u64(s, strlen(s), 0, &u), s + 10);
+        assert_true(u == 0xdeadbeef);
+        assert_ptr_equal(cgs_parse_u64(s, strlen(s), 16, &u), s + 10);
+
+        // decimal without the prefix in base 0, a bare "0x" is just zero
+        assert_non_null(cgs_parse_u64("ff", 2, 16, &u));
+        assert_true(u == 0xff);
+        assert_null(cgs_parse_u64("ff", 2, 0, &u));
+        s = "0xg";
+        assert_ptr_equal(cgs_parse_u64(s, 3, 0, &u), s + 1);
+        assert_true(u == 0);
+
+        s = "0xffffffffffffffff";
+        assert_non_null(cgs_parse_u64(s, strlen(s), 0, &u));
+        assert_true(u == UINT64_MAX);
+        s = "0x1ffffffffffffffff";
+        assert_null(cgs_parse_u64(s, strlen(s), 0, &u));
+
+        int32_t i = 0;
+        assert_non_null(cgs_parse_i32("-0x10", 5, 0, &i));
+        assert_int_equal(i, -16);
+}
+
+static void
+parse_signed_test(void** state)
+{
+        (void)state;
+
+        int64_t l = 0;
+        const char* s = "-9223372036854775808";
+        assert_non_null(cgs_parse_i64(s, strlen(s), 10, &l));
+        assert_true(l == INT64_MIN);
+        s = "9223372036854775807";
+        assert_non_null(cgs_parse_i64(s, strlen(s), 10, &l));
+        assert_true(l == INT64_MAX);
+        s = "9223372036854775808";
+        assert_null(cgs_parse_i64(s, strlen(s), 10, &l));
+
+        int32_t i = 0;
+        assert_non_null(cgs_parse_i32("-2147483648", 11, 10, &i));
+        assert_true(i == INT32_MIN);
+        assert_non_null(cgs_parse_i32("+2147483647", 11, 10, &i));
+        assert_true(i == INT32_MAX);
+        assert_null(cgs_parse_i32("2147483648", 10, 10, &i));
+        assert_null(cgs_parse_i32("-", 1, 10, &i));
+
+        struct cgs_strsub ss = cgs_strsub_from_str("\t-37\n");
+        assert_ptr_equal(cgs_strsub_parse_i32(&ss, 10, &i), ss.data + 4);
+        assert_int_equal(i, -37);
+}
+
+static void
+parse_double_test(void** state)
+{
+        (void)state;
+
+        const char* good[] = {
+                "0", "-0", "1", "-1.5", "3.14159", ".5", "5.", "1e10",
+                "1E-5", "2.5e+3", "123456789012345678", "0.1", "0.3",
+                "1e22", "1e23", "9007199254740993", "1.7976931348623157e308",
+                "2.2250738585072014e-308", "4.9e-324", "1e-400", "1e400",
+                "0.000000000000000000000000000001234",
+                "123456789012345678901234567890.5",
+                "3.141592653589793238462643383279502884197",
+                "000000000000000000000000001.25", "1.00000000000000000000001",
+        };
+        for (size_t i = 0; i < sizeof(good) / sizeof(good[0]); ++i) {
+                double d = 42.0;
+                const char* p = cgs_parse_double(good[i], strlen(good[i]),
+                                &d);
+                assert_ptr_equal(p, good[i] + strlen(good[i]));
+
+                // bit-for-bit the same as strtod
+                double e = strtod(good[i], NULL);
+                assert_memory_equal(&d, &e, sizeof(double));
+        }
+
+        double d = 0.0;
+        const char* s = "1.5e";
+        assert_ptr_equal(cgs_parse_double(s, strlen(s), &d), s + 3);
+        s = "-2e+x";
+        assert_ptr_equal(cgs_parse_double(s, strlen(s), &d), s + 2);
+        assert_true(d == -2.0);
+
+        assert_null(cgs_parse_double("", 0, &d));
+        assert_null(cgs_parse_double(".", 1, &d));
+        assert_null(cgs_parse_double("-.e5", 4, &d));
+        assert_null(cgs_parse_double("nan", 3, &d));
+}
+
+static void
+parse_double_random_test(void** state)
+{
+        (void)state;
+
+        // round trips of printed doubles take both paths
+        srand(7);
+        char buf[64];
+        for (int i = 0; i < 10000; ++i) {
+                double x = (double)rand() / RAND_MAX * (rand() % 2 ? 1e6 : 1);
+                int prec = 1 + rand() % 17;
+                int len = snprintf(buf, sizeof(buf), i % 2 ? "%.*g" : "%.*f",
+                                prec, x);
+
+                double d = 0.0;
+                double e = strtod(buf, NULL);
+                assert_ptr_equal(cgs_parse_double(buf, len, &d), buf + len);
+                assert_memory_equal(&d, &e, sizeof(double));
+        }
+}
+
+static void
+parse_double_locale_test(void** state)
+{
+        (void)state;
+
+        // the slow path must not pick up a comma decimal point
+        const char* names[] = {
+                "de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "fr_FR.utf8",
+                "de_DE", "fr_FR",
+        };
+        const char* set = NULL;
+        for (size_t i = 0; !set && i < sizeof(names) / sizeof(names[0]); ++i)
+                set = setlocale(LC_NUMERIC, names[i]);
+        if (!set)
+                skip();
+
+        const char* s = "1.5e300";
+        double d = 0.0;
+        const char* p = cgs_parse_double(s, strlen(s), &d);
+        setlocale(LC_NUMERIC, "C");
+        assert_ptr_equal(p, s + strlen(s));
+        assert_true(d == 1.5e300);
+}
+
+int main(void)
+{
+        const struct CMUnitTest tests[] = {
+                cmocka_unit_test(parse_u64_test),
+                cmocka_unit_test(parse_hex_test),
+                cmocka_unit_test(parse_signed_test),
+                cmocka_unit_test(parse_double_test),
+                cmocka_unit_test(parse_double_random_test),
+                cmocka_unit_test(parse_double_locale_test),
+        };
+
+        return cmocka_run_group_tests(tests, NULL, NULL);
+}
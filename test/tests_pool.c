@@ -0,0 +1,192 @@
+/* tests_pool.c
+ *
+ * MIT License
+ * 
+ * Copyright (c) 2022 Chris Schick
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "cmocka_headers.h"
+
+#include "cgs_pool.h"
+#include "cgs_bst.h"
+#include "cgs_compare.h"
+#include "cgs_hashtab.h"
+#include "cgs_rbt.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+static void
+pool_alloc_release_test(void** state)
+{
+        (void)state;
+        enum { NUM = 100 };
+
+        struct cgs_pool pool = cgs_pool_new(20, 16);
+        assert_int_equal(pool.block_size, 32);
+        assert_null(pool.slabs);
+
+        char* blocks[NUM];
+        for (int i = 0; i < NUM; ++i) {
+                blocks[i] = cgs_pool_alloc(&pool);
+                assert_non_null(blocks[i]);
+                assert_int_equal((uintptr_t)blocks[i] % CGS_POOL_ALIGN, 0);
+                memset(blocks[i], i, pool.block_size);
+        }
+        assert_int_equal(pool.in_use, NUM);
+
+        // blocks of a slab are handed out in address order
+        assert_ptr_equal(blocks[1], blocks[0] + pool.block_size);
+        assert_int_equal((uintptr_t)blocks[0] % CGS_POOL_SLAB_ALIGN, 0);
+
+        for (int i = 0; i < NUM; ++i)
+                assert_int_equal(blocks[i][pool.block_size - 1], (char)i);
+
+        // released blocks are reused first
+        cgs_pool_release(&pool, blocks[42]);
+        assert_int_equal(pool.in_use, NUM - 1);
+        assert_ptr_equal(cgs_pool_alloc(&pool), blocks[42]);
+
+        cgs_pool_free(&pool);
+        assert_int_equal(pool.in_use, 0);
+}
+
+static void
+pool_allocator_test(void** state)
+{
+        (void)state;
+
+        struct cgs_pool pool = cgs_pool_new(sizeof(double), 0);
+        assert_non_null(cgs_pool_reserve(&pool, CGS_POOL_SLAB_BLOCKS + 1));
+
+        const struct cgs_allocator* a = cgs_pool_allocator(&pool);
+        char* small = cgs_alloc(a, 8);
+        assert_non_null(small);
+        assert_int_equal(pool.in_use, 1);
+
+        // large requests fall through to the C library
+        char* big = cgs_alloc(a, 4096);
+        assert_non_null(big);
+        assert_int_equal(pool.in_use, 1);
+
+        // growing past a block moves out of the pool
+        strcpy(small, "pool");
+        small = cgs_realloc(a, small, 8, 64);
+        assert_string_equal(small, "pool");
+        assert_int_equal(pool.in_use, 0);
+
+        cgs_free(a, small, 64);
+        cgs_free(a, big, 4096);
+        cgs_pool_free(&pool);
+}
+
+static void
+collect_int(const void* e, size_t i, void* data)
+{
+        int* out = data;
+        out[i] = *(const int*)e;
+}
+
+static void
+pool_rbt_bst_test(void** state)
+{
+        (void)state;
+        enum { NUM = 500 };
+
+        struct cgs_pool pool = cgs_pool_new(cgs_rbt_node_size(), 64);
+        struct cgs_rbt rbt = cgs_rbt_new(cgs_int_cmp, NULL);
+        struct cgs_bst bst = cgs_bst_new(cgs_int_cmp, NULL);
+        assert_non_null(cgs_rbt_use_pool(&rbt, &pool));
+        assert_non_null(cgs_bst_use_pool(&bst, &pool));
+
+        struct cgs_variant var = { 0 };
+        for (int i = 0; i < NUM; ++i) {
+                cgs_variant_set_int(&var, (i * 7919) % NUM);
+                assert_non_null(cgs_rbt_insert(&rbt, &var));
+                assert_non_null(cgs_bst_insert(&bst, &var));
+        }
+        assert_int_equal(pool.in_use, 2 * NUM);
+
+        // a tree with nodes cannot switch allocators
+        assert_null(cgs_rbt_use_pool(&rbt, &pool));
+
+        int out[NUM] = { 0 };
+        cgs_rbt_foreach(&rbt, collect_int, out);
+        for (int i = 0; i < NUM; ++i)
+                assert_int_equal(out[i], i);
+
+        memset(out, 0, sizeof(out));
+        cgs_bst_foreach(&bst, collect_int, out);
+        for (int i = 0; i < NUM; ++i)
+                assert_int_equal(out[i], i);
+
+        cgs_rbt_free(&rbt);
+        cgs_bst_free(&bst);
+        assert_int_equal(pool.in_use, 0);
+
+        // blocks too small for the nodes are refused
+        struct cgs_pool tiny = cgs_pool_new(1, 0);
+        struct cgs_rbt t = cgs_rbt_new(cgs_int_cmp, NULL);
+        assert_null(cgs_rbt_use_pool(&t, &tiny));
+
+        cgs_pool_free(&pool);
+}
+
+static void
+pool_hashtab_test(void** state)
+{
+        (void)state;
+
+        struct cgs_pool pool = cgs_pool_new(cgs_hashtab_bucket_size(), 0);
+        struct cgs_hashtab ht = cgs_hashtab_new(NULL);
+        assert_non_null(cgs_hashtab_use_pool(&ht, &pool));
+
+        char key[16];
+        struct cgs_variant var = { 0 };
+        for (int i = 0; i < 200; ++i) {
+                sprintf(key, "key%d", i);
+                cgs_variant_set_int(&var, i);
+                assert_non_null(cgs_hashtab_insert(&ht, key, &var));
+        }
+        assert_true(pool.in_use >= 200);
+
+        for (int i = 0; i < 200; ++i) {
+                sprintf(key, "key%d", i);
+                const int* p = cgs_hashtab_lookup(&ht, key);
+                assert_non_null(p);
+                assert_int_equal(*p, i);
+        }
+
+        cgs_hashtab_free(&ht);
+        assert_int_equal(pool.in_use, 0);
+        cgs_pool_free(&pool);
+}
+
+int main(void)
+{
+        const struct CMUnitTest tests[] = {
+                cmocka_unit_test(pool_alloc_release_test),
+                cmocka_unit_test(pool_allocator_test),
+                cmocka_unit_test(pool_rbt_bst_test),
+                cmocka_unit_test(pool_hashtab_test),
+        };
+
+        return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -87,13 +87,13 @@ void set_children(struct cgs_rbt_node* node, struct node_data arr[NUMCHILDREN])
 	struct cgs_variant v = { 0 };
 	if (arr[LEFT].flag == ADD) {
 		cgs_variant_set_int(&v, arr[LEFT].val);
-		node->left = cgs_rbt_node_new(&v);
+		node->left = cgs_rbt_node_new(NULL, &v);
 		node->left->color = arr[LEFT].color;
 		node->left->parent = node;
 	}
 	if (arr[RIGHT].flag == ADD) {
 		cgs_variant_set_int(&v, arr[RIGHT].val);
-		node->right = cgs_rbt_node_new(&v);
+		node->right = cgs_rbt_node_new(NULL, &v);
 		node->right->color = arr[RIGHT].color;
 		node->right->parent = node;
 	}
@@ -120,7 +120,7 @@ static int fake_tree_good_small_setup(void** state)
 	struct cgs_variant v = { 0 };
 	cgs_variant_set_int(&v, 4);
 
-	struct cgs_rbt_node* root = cgs_rbt_node_new(&v);
+	struct cgs_rbt_node* root = cgs_rbt_node_new(NULL, &v);
 	root->color = CGS_RBT_BLACK;
 
 	struct cgs_rbt_node* node = root;
@@ -175,7 +175,7 @@ static int fake_tree_good_large_setup(void** state)
 {
 	struct cgs_variant v = { 0 };
 	cgs_variant_set_int(&v, 26);
-	struct cgs_rbt_node* root = cgs_rbt_node_new(&v);
+	struct cgs_rbt_node* root = cgs_rbt_node_new(NULL, &v);
 	root->color = CGS_RBT_BLACK;
 
 	struct cgs_rbt_node* node = root; // 26
@@ -275,7 +275,7 @@ static int fake_tree_bad_color_setup(void** state)
 	struct cgs_variant v = { 0 };
 	cgs_variant_set_int(&v, 4);
 
-	struct cgs_rbt_node* root = cgs_rbt_node_new(&v);
+	struct cgs_rbt_node* root = cgs_rbt_node_new(NULL, &v);
 	root->color = CGS_RBT_BLACK;
 
 	struct cgs_rbt_node* node = root;
@@ -326,7 +326,7 @@ static int fake_tree_bad_root_setup(void** state)
 	struct cgs_variant v = { 0 };
 	cgs_variant_set_int(&v, 4);
 
-	struct cgs_rbt_node* root = cgs_rbt_node_new(&v);
+	struct cgs_rbt_node* root = cgs_rbt_node_new(NULL, &v);
 	root->color = CGS_RBT_RED;
 
 	struct cgs_rbt_node* node = root;
@@ -378,7 +378,7 @@ static int fake_tree_bad_bh_setup(void** state)
 	struct cgs_variant v = { 0 };
 	cgs_variant_set_int(&v, 4);
 
-	struct cgs_rbt_node* root = cgs_rbt_node_new(&v);
+	struct cgs_rbt_node* root = cgs_rbt_node_new(NULL, &v);
 	root->color = CGS_RBT_BLACK;
 
 	struct cgs_rbt_node* node = root;
@@ -431,7 +431,7 @@ static int fake_tree_bad_rc_setup(void** state)
 	struct cgs_variant v = { 0 };
 	cgs_variant_set_int(&v, 4);
 
-	struct cgs_rbt_node* root = cgs_rbt_node_new(&v);
+	struct cgs_rbt_node* root = cgs_rbt_node_new(NULL, &v);
 	root->color = CGS_RBT_BLACK;
 
 	struct cgs_rbt_node* node = root;
@@ -500,7 +500,7 @@ static int rbt_insert_tree_setup(void** state)
 static int tree_node_teardown(void** state)
 {
 	struct cgs_rbt_node* node = *(struct cgs_rbt_node**)state;
-	cgs_rbt_node_free(node, NULL);
+	cgs_rbt_node_free(NULL, node, NULL);
 	return 0;
 }
 
@@ -0,0 +1,281 @@
+#include "cmocka_headers.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "cgs_rope.h"
+#include "cgs_string.h"
+
+static void
+check_text(const struct cgs_rope* rope, const char* expect, size_t n)
+{
+        struct cgs_string s = cgs_string_new();
+        assert_int_equal(cgs_rope_length(rope), n);
+        assert_non_null(cgs_rope_to_string(rope, &s));
+        assert_int_equal(s.length, n);
+        assert_memory_equal(cgs_string_data(&s), expect, n);
+        cgs_string_free(&s);
+}
+
+static void
+rope_edit_test(void** state)
+{
+        (void)state;
+
+        struct cgs_rope r = cgs_rope_new();
+        check_text(&r, "", 0);
+
+        assert_non_null(cgs_rope_append(&r, "world", 5));
+        assert_non_null(cgs_rope_insert(&r, 0, "hello ", 6));
+        assert_non_null(cgs_rope_append(&r, "!", 1));
+        check_text(&r, "hello world!", 12);
+
+        assert_non_null(cgs_rope_replace(&r, 6, 5, "there", 5));
+        check_text(&r, "hello there!", 12);
+        assert_non_null(cgs_rope_replace(&r, 0, 5, "hi", 2));
+        check_text(&r, "hi there!", 9);
+        assert_non_null(cgs_rope_erase(&r, 2, 100));
+        check_text(&r, "hi", 2);
+        assert_int_equal(cgs_rope_get(&r, 1), 'i');
+
+        assert_null(cgs_rope_insert(&r, 3, "x", 1));
+        assert_null(cgs_rope_erase(&r, 3, 1));
+        assert_null(cgs_rope_replace(&r, 3, 0, "x", 1));
+
+        struct cgs_string s = cgs_string_new();
+        assert_null(cgs_rope_substr(&r, 3, 1, &s));
+        assert_non_null(cgs_rope_substr(&r, 1, 5, &s));
+        assert_string_equal(cgs_string_data(&s), "i");
+
+        cgs_string_free(&s);
+        cgs_rope_free(&r);
+}
+
+/* Neighbouring chunks are coalesced whenever they fit in one 1 KiB node,
+ * so any two of them hold well over half a node of text.
+ */
+enum { MIN_PAIR = 512 };
+
+struct chunk_check {
+        size_t total;
+        size_t count;
+        const char* text;
+        size_t prev;
+};
+
+static void
+check_chunk(const void* e, size_t i, void* data)
+{
+        const struct cgs_strsub* ss = e;
+        struct chunk_check* c = data;
+
+        assert_int_equal(i, c->count++);
+        assert_true(ss->length > 0);
+        assert_memory_equal(ss->data, &c->text[c->total], ss->length);
+        if (i > 0)
+                assert_true(c->prev + ss->length > MIN_PAIR);
+        c->prev = ss->length;
+        c->total += ss->length;
+}
+
+static void
+rope_random_test(void** state)
+{
+        (void)state;
+
+        // apply the same random edits to a rope and a flat buffer
+        enum { CAP = 1 << 20 };
+        char* flat = malloc(CAP);
+        char* text = malloc(CAP);
+        assert_non_null(flat);
+        assert_non_null(text);
+        for (size_t i = 0; i < CAP; ++i)
+                text[i] = 'a' + i % 26;
+
+        struct cgs_rope r = cgs_rope_new();
+        size_t n = 0;
+        srand(3);
+        for (int i = 0; i < 3000; ++i) {
+                size_t pos = n ? (size_t)rand() % (n + 1) : 0;
+                size_t len = rand() % 4 ? rand() % 16 : rand() % 5000;
+                const char* src = &text[rand() % 1000];
+
+                switch (rand() % 3) {
+                case 0:
+                        if (n + len > CAP)
+                                break;
+                        assert_non_null(cgs_rope_insert(&r, pos, src, len));
+                        memmove(&flat[pos + len], &flat[pos], n - pos);
+                        memcpy(&flat[pos], src, len);
+                        n += len;
+                        break;
+                case 1:
+                        if (len > n - pos)
+                                len = n - pos;
+                        assert_non_null(cgs_rope_erase(&r, pos, len));
+                        memmove(&flat[pos], &flat[pos + len], n - pos - len);
+                        n -= len;
+                        break;
+                default: {
+                        size_t count = rand() % 2 ? len : (size_t)rand() % 64;
+                        if (count > n - pos)
+                                count = n - pos;
+                        if (n - count + len > CAP)
+                                break;
+                        assert_non_null(cgs_rope_replace(&r, pos, count,
+                                                src, len));
+                        memmove(&flat[pos + len], &flat[pos + count],
+                                        n - pos - count);
+                        memcpy(&flat[pos], src, len);
+                        n = n - count + len;
+                }
+                }
+                assert_int_equal(cgs_rope_length(&r), n);
+                if (n)
+                        assert_int_equal(cgs_rope_get(&r, pos % n),
+                                        flat[pos % n]);
+        }
+        check_text(&r, flat, n);
+
+        struct chunk_check c = { 0, 0, flat, 0 };
+        cgs_rope_foreach(&r, check_chunk, &c);
+        assert_int_equal(c.total, n);
+
+        struct cgs_string s = cgs_string_new();
+        assert_non_null(cgs_rope_substr(&r, n / 3, n / 2, &s));
+        assert_memory_equal(cgs_string_data(&s), &flat[n / 3], n / 2);
+        cgs_string_free(&s);
+
+        cgs_rope_free(&r);
+        free(flat);
+        free(text);
+}
+
+static void
+rope_coalesce_test(void** state)
+{
+        (void)state;
+
+        enum { N = 1 << 18 };
+        char* flat = malloc(N * 2);
+        assert_non_null(flat);
+        memset(flat, 'x', N);
+
+        // a byte between every byte, then every other byte erased again
+        struct cgs_rope r = cgs_rope_new();
+        assert_non_null(cgs_rope_append(&r, flat, N));
+        for (size_t pos = 0; pos < 2 * N; pos += 2)
+                assert_non_null(cgs_rope_insert(&r, pos, "y", 1));
+        for (size_t i = 0; i < 2 * N; i += 2) {
+                flat[i] = 'y';
+                flat[i + 1] = 'x';
+        }
+        check_text(&r, flat, 2 * N);
+
+        struct chunk_check c = { 0, 0, flat, 0 };
+        cgs_rope_foreach(&r, check_chunk, &c);
+        assert_true(c.count < 2 * N / MIN_PAIR);
+
+        for (size_t pos = 0; pos < cgs_rope_length(&r); ++pos)
+                assert_non_null(cgs_rope_erase(&r, pos, 1));
+        memset(flat, 'x', N);
+        check_text(&r, flat, N);
+
+        c = (struct chunk_check){ 0, 0, flat, 0 };
+        cgs_rope_foreach(&r, check_chunk, &c);
+        assert_true(c.count < N / MIN_PAIR);
+
+        cgs_rope_free(&r);
+        free(flat);
+}
+
+struct budget {
+        size_t left;
+        size_t live;
+};
+
+static void*
+budget_alloc(void* ctx, size_t size)
+{
+        struct budget* b = ctx;
+        if (b->left == 0)
+                return NULL;
+        --b->left;
+        b->live += size;
+        return malloc(size);
+}
+
+static void
+budget_free(void* ctx, void* p, size_t size)
+{
+        struct budget* b = ctx;
+        if (p)
+                b->live -= size;
+        free(p);
+}
+
+static void
+rope_failed_edit_test(void** state)
+{
+        (void)state;
+
+        enum { N = 10000 };
+        char* flat = malloc(2 * N);
+        char* src = malloc(N);
+        assert_non_null(flat);
+        assert_non_null(src);
+        for (size_t i = 0; i < N; ++i) {
+                flat[i] = 'a' + i % 26;
+                src[i] = 'A' + i % 26;
+        }
+
+        struct budget b = { (size_t)-1, 0 };
+        struct cgs_allocator a = { budget_alloc, NULL, budget_free, &b };
+        struct cgs_rope r = cgs_rope_new();
+        assert_non_null(cgs_rope_set_allocator(&r, &a));
+        assert_non_null(cgs_rope_append(&r, flat, N));
+
+        // every edit either succeeds or leaves the rope as it was
+        const struct { size_t pos, count, n; } edits[] = {
+                { 500, 3000, 2500 },    // replace across chunks
+                { 1500, 10, 3000 },     // grow across chunks
+                { 700, 4000, 0 },       // erase across chunks
+                { 3000, 0, 5000 },      // insert mid-chunk
+        };
+        for (size_t e = 0; e < sizeof(edits) / sizeof(edits[0]); ++e) {
+                size_t pos = edits[e].pos;
+                size_t count = edits[e].count;
+                size_t n = edits[e].n;
+                size_t len = cgs_rope_length(&r);
+                for (size_t k = 0; ; ++k) {
+                        size_t live = b.live;
+                        b.left = k;
+                        if (cgs_rope_replace(&r, pos, count, src, n))
+                                break;
+                        assert_int_equal(b.live, live);
+                        check_text(&r, flat, len);
+                }
+                b.left = (size_t)-1;
+
+                memmove(&flat[pos + n], &flat[pos + count], len - pos - count);
+                memcpy(&flat[pos], src, n);
+                check_text(&r, flat, len - count + n);
+        }
+
+        cgs_rope_free(&r);
+        assert_int_equal(b.live, 0);
+        free(flat);
+        free(src);
+}
+
+int main(void)
+{
+        const struct CMUnitTest tests[] = {
+                cmocka_unit_test(rope_edit_test),
+                cmocka_unit_test(rope_random_test),
+                cmocka_unit_test(rope_coalesce_test),
+                cmocka_unit_test(rope_failed_edit_test),
+        };
+
+        return cmocka_run_group_tests(tests, NULL, NULL);
+}
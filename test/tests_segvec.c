@@ -0,0 +1,140 @@
+#include "cmocka_headers.h"
+
+#include "cgs_segvec.h"
+
+static void
+segvec_new_test(void** state)
+{
+        (void)state;
+
+        struct cgs_segvec sv = cgs_segvec_new(sizeof(int));
+        assert_int_equal(cgs_segvec_length(&sv), 0);
+        assert_int_equal(sv.element_size, sizeof(int));
+        for (int i = 0; i < CGS_SEGVEC_MAX_BLOCKS; ++i)
+                assert_null(sv.blocks[i]);
+}
+
+static void
+segvec_block_of_test(void** state)
+{
+        (void)state;
+
+        const size_t f = CGS_SEGVEC_FIRST_BLOCK;
+        assert_int_equal(cgs_segvec_block_of(0), 0);
+        assert_int_equal(cgs_segvec_block_of(f - 1), 0);
+        assert_int_equal(cgs_segvec_block_of(f), 1);
+        assert_int_equal(cgs_segvec_block_of(3 * f - 1), 1);
+        assert_int_equal(cgs_segvec_block_of(3 * f), 2);
+        assert_int_equal(cgs_segvec_block_of(7 * f - 1), 2);
+        assert_int_equal(cgs_segvec_block_of(7 * f), 3);
+
+        assert_int_equal(cgs_segvec_block_start(0), 0);
+        assert_int_equal(cgs_segvec_block_start(1), f);
+        assert_int_equal(cgs_segvec_block_start(2), 3 * f);
+        assert_int_equal(cgs_segvec_block_start(3), 7 * f);
+}
+
+static void
+segvec_push_get_test(void** state)
+{
+        (void)state;
+        enum { NUM = 1000 };
+
+        struct cgs_segvec sv = cgs_segvec_new(sizeof(int));
+        const int* first = NULL;
+        for (int i = 0; i < NUM; ++i) {
+                int* p = cgs_segvec_push(&sv, &i);
+                assert_non_null(p);
+                assert_int_equal(*p, i);
+                if (i == 0)
+                        first = p;
+        }
+        assert_int_equal(cgs_segvec_length(&sv), NUM);
+
+        // elements never move
+        assert_ptr_equal(first, cgs_segvec_get(&sv, 0));
+        assert_int_equal(*first, 0);
+
+        for (int i = 0; i < NUM; ++i)
+                assert_int_equal(*(const int*)cgs_segvec_get(&sv, i), i);
+
+        int* p = cgs_segvec_get_mut(&sv, 500);
+        *p = -500;
+        assert_int_equal(*(const int*)cgs_segvec_get(&sv, 500), -500);
+
+        int x = 0;
+        assert_non_null(cgs_segvec_pop(&sv, &x));
+        assert_int_equal(x, NUM - 1);
+        assert_int_equal(cgs_segvec_length(&sv), NUM - 1);
+
+        cgs_segvec_clear(&sv);
+        assert_null(cgs_segvec_pop(&sv, &x));
+
+        cgs_segvec_free(&sv);
+}
+
+static void
+segvec_claim_test(void** state)
+{
+        (void)state;
+
+        struct cgs_segvec sv = cgs_segvec_new(sizeof(int));
+        size_t a = 0;
+        size_t b = 0;
+        assert_non_null(cgs_segvec_claim(&sv, 10, &a));
+        assert_non_null(cgs_segvec_claim(&sv, 100, &b));
+        assert_int_equal(a, 0);
+        assert_int_equal(b, 10);
+        assert_int_equal(cgs_segvec_length(&sv), 110);
+
+        for (size_t i = 0; i < 100; ++i)
+                *(int*)cgs_segvec_get_mut(&sv, b + i) = (int)i;
+        for (size_t i = 0; i < 10; ++i)
+                *(int*)cgs_segvec_get_mut(&sv, a + i) = -1;
+
+        assert_int_equal(*(const int*)cgs_segvec_get(&sv, 9), -1);
+        assert_int_equal(*(const int*)cgs_segvec_get(&sv, 109), 99);
+
+        cgs_segvec_free(&sv);
+}
+
+static void
+accum_int(const void* p, size_t i, void* data)
+{
+        (void)i;
+        *(long*)data += *(const int*)p;
+}
+
+static void
+segvec_reserve_foreach_test(void** state)
+{
+        (void)state;
+        enum { NUM = 300 };
+
+        struct cgs_segvec sv = cgs_segvec_new(sizeof(int));
+        assert_non_null(cgs_segvec_reserve(&sv, NUM));
+        assert_int_equal(cgs_segvec_length(&sv), 0);
+        assert_non_null(sv.blocks[cgs_segvec_block_of(NUM - 1)]);
+
+        for (int i = 1; i <= NUM; ++i)
+                cgs_segvec_push(&sv, &i);
+
+        long sum = 0;
+        cgs_segvec_foreach(&sv, accum_int, &sum);
+        assert_int_equal(sum, NUM * (NUM + 1) / 2);
+
+        cgs_segvec_free(&sv);
+}
+
+int main(void)
+{
+        const struct CMUnitTest tests[] = {
+                cmocka_unit_test(segvec_new_test),
+                cmocka_unit_test(segvec_block_of_test),
+                cmocka_unit_test(segvec_push_get_test),
+                cmocka_unit_test(segvec_claim_test),
+                cmocka_unit_test(segvec_reserve_foreach_test),
+        };
+
+        return cmocka_run_group_tests(tests, NULL, NULL);
+}
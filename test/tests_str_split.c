@@ -1,4 +1,5 @@
 #include "cmocka_headers.h"
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -140,6 +141,135 @@ string_split_normal(void** state)
         cgs_string_free(&s1);
 }
 
+static void
+strsub_split_any_normal(void** state)
+{
+        struct cgs_vector* v1 = *state;
+        struct cgs_strsub ss = cgs_strsub_from_str("a, b,,c\td ");
+
+        assert_non_null(cgs_strsub_split_any(&ss, " ,\t", 0, v1));
+        assert_int_equal(cgs_vector_length(v1), 4);
+        assert_true(cgs_strsub_eq_str(cgs_vector_get(v1, 0), "a"));
+        assert_true(cgs_strsub_eq_str(cgs_vector_get(v1, 1), "b"));
+        assert_true(cgs_strsub_eq_str(cgs_vector_get(v1, 2), "c"));
+        assert_true(cgs_strsub_eq_str(cgs_vector_get(v1, 3), "d"));
+
+        // 'n' delimiters give 'n + 1' fields when empty ones are kept
+        cgs_vector_clear(v1);
+        assert_non_null(cgs_strsub_split_any(&ss, " ,\t",
+                                CGS_SPLIT_KEEP_EMPTY, v1));
+        assert_int_equal(cgs_vector_length(v1), 7);
+        assert_true(cgs_strsub_eq_str(cgs_vector_get(v1, 1), ""));
+        assert_true(cgs_strsub_eq_str(cgs_vector_get(v1, 2), "b"));
+        assert_true(cgs_strsub_eq_str(cgs_vector_get(v1, 6), ""));
+}
+
+static void
+strsub_split_any_long(void** state)
+{
+        struct cgs_vector* v1 = *state;
+
+        // long enough for the block loop, with fields across block edges
+        char buf[1000];
+        size_t n = 0;
+        for (int i = 0; n + 16 < sizeof(buf); ++i)
+                n += sprintf(&buf[n], "%d%c", i, ",;: "[i % 4]);
+        struct cgs_strsub ss = cgs_strsub_new(buf, n);
+
+        assert_non_null(cgs_strsub_split_any(&ss, ",;: ", 0, v1));
+        for (size_t i = 0; i < cgs_vector_length(v1); ++i) {
+                char num[32];
+                sprintf(num, "%zu", i);
+                assert_true(cgs_strsub_eq_str(cgs_vector_get(v1, i), num));
+        }
+
+        // a set too large for the SIMD compares takes the table path
+        size_t len = cgs_vector_length(v1);
+        cgs_vector_clear(v1);
+        assert_non_null(cgs_strsub_split_any(&ss, ",;: xyzwvu", 0, v1));
+        assert_int_equal(cgs_vector_length(v1), len);
+}
+
+static void
+strsub_split_str_normal(void** state)
+{
+        struct cgs_vector* v1 = *state;
+        struct cgs_strsub ss = cgs_strsub_from_str("<>one<><>two<>");
+        struct cgs_strsub sep = cgs_strsub_from_str("<>");
+
+        assert_non_null(cgs_strsub_split_str(&ss, &sep, 0, v1));
+        assert_int_equal(cgs_vector_length(v1), 2);
+        assert_true(cgs_strsub_eq_str(cgs_vector_get(v1, 0), "one"));
+        assert_true(cgs_strsub_eq_str(cgs_vector_get(v1, 1), "two"));
+
+        cgs_vector_clear(v1);
+        assert_non_null(cgs_strsub_split_str(&ss, &sep,
+                                CGS_SPLIT_KEEP_EMPTY, v1));
+        assert_int_equal(cgs_vector_length(v1), 5);
+        assert_true(cgs_strsub_eq_str(cgs_vector_get(v1, 2), ""));
+        assert_true(cgs_strsub_eq_str(cgs_vector_get(v1, 3), "two"));
+
+        struct cgs_strsub empty = cgs_strsub_from_str("");
+        assert_null(cgs_strsub_split_str(&ss, &empty, 0, v1));
+}
+
+static void
+split_iter_normal(void** state)
+{
+        (void)state;
+
+        const char* expect[] = { "ls", "-l", "--all", "/tmp" };
+        struct cgs_split_iter it = cgs_str_split_iter("  ls -l\t--all  /tmp",
+                        " \t", 0);
+        struct cgs_strsub ss;
+        size_t i = 0;
+        while (cgs_split_iter_next(&it, &ss))
+                assert_true(cgs_strsub_eq_str(&ss, expect[i++]));
+        assert_int_equal(i, 4);
+        assert_null(cgs_split_iter_next(&it, &ss));
+
+        it = cgs_str_split_iter("", ",", 0);
+        assert_null(cgs_split_iter_next(&it, &ss));
+
+        // an empty input is a single empty field when empty fields are kept
+        it = cgs_str_split_iter("", ",", CGS_SPLIT_KEEP_EMPTY);
+        assert_non_null(cgs_split_iter_next(&it, &ss));
+        assert_int_equal(ss.length, 0);
+        assert_null(cgs_split_iter_next(&it, &ss));
+}
+
+static void
+split_iter_skip_collect(void** state)
+{
+        (void)state;
+
+        struct cgs_string s = cgs_string_new();
+        cgs_string_from("id,name,,email,phone", &s);
+
+        // pick out the third field, keeping empty ones
+        struct cgs_split_iter it = cgs_string_split_iter(&s, ",",
+                        CGS_SPLIT_KEEP_EMPTY);
+        struct cgs_strsub ss;
+        assert_int_equal(cgs_split_iter_skip(&it, 2), 2);
+        assert_non_null(cgs_split_iter_next(&it, &ss));
+        assert_int_equal(ss.length, 0);
+
+        struct cgs_strsub arr[8];
+        assert_int_equal(cgs_split_iter_collect(&it, arr, 8), 2);
+        assert_true(cgs_strsub_eq_str(&arr[0], "email"));
+        assert_true(cgs_strsub_eq_str(&arr[1], "phone"));
+        assert_int_equal(cgs_split_iter_skip(&it, 5), 0);
+
+        // collect stops at the array size and the rest stays available
+        it = cgs_string_split_iter(&s, ",", 0);
+        assert_int_equal(cgs_split_iter_collect(&it, arr, 2), 2);
+        assert_true(cgs_strsub_eq_str(&arr[1], "name"));
+        assert_non_null(cgs_split_iter_next(&it, &ss));
+        assert_true(cgs_strsub_eq_str(&ss, "email"));
+
+        cgs_string_free(&s);
+}
+
 int main(void)
 {
         const struct CMUnitTest tests[] = {
@@ -155,9 +285,18 @@ int main(void)
                 // strsub_split
                 cmocka_unit_test_setup_teardown(strsub_split_normal,
                                 su_sub_vec, td_sub_vec),
+                cmocka_unit_test_setup_teardown(strsub_split_any_normal,
+                                su_sub_vec, td_sub_vec),
+                cmocka_unit_test_setup_teardown(strsub_split_any_long,
+                                su_sub_vec, td_sub_vec),
+                cmocka_unit_test_setup_teardown(strsub_split_str_normal,
+                                su_sub_vec, td_sub_vec),
                 // string_split
                 cmocka_unit_test_setup_teardown(string_split_normal,
                                 su_sub_vec, td_sub_vec),
+                // split_iter
+                cmocka_unit_test(split_iter_normal),
+                cmocka_unit_test(split_iter_skip_collect),
         };
 
         return cmocka_run_group_tests(tests, NULL, NULL);
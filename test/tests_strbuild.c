@@ -0,0 +1,144 @@
+#include "cmocka_headers.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cgs_strbuild.h"
+#include "cgs_string.h"
+
+static void
+strbuild_append_test(void** state)
+{
+        (void)state;
+
+        struct cgs_strbuild sb = cgs_strbuild_new();
+        struct cgs_string s = cgs_string_new();
+        assert_non_null(cgs_strbuild_to_string(&sb, &s));
+        assert_int_equal(s.length, 0);
+        assert_string_equal(cgs_string_data(&s), "");
+
+        struct cgs_strsub ss = cgs_strsub_from_str("a swinger");
+        assert_non_null(cgs_strbuild_append_str(&sb, "One could do worse "));
+        assert_non_null(cgs_strbuild_append(&sb, "than be", 7));
+        assert_non_null(cgs_strbuild_push(&sb, ' '));
+        assert_non_null(cgs_strbuild_append_strsub(&sb, &ss));
+        assert_non_null(cgs_strbuild_appendf(&sb, " of %s", "birches"));
+        assert_int_equal(cgs_strbuild_length(&sb), 47);
+
+        assert_non_null(cgs_strbuild_to_string(&sb, &s));
+        assert_string_equal(cgs_string_data(&s),
+                        "One could do worse than be a swinger of birches");
+        assert_int_equal(s.length, 47);
+        assert_int_equal(s.capacity, 48);
+
+        cgs_strbuild_clear(&sb);
+        assert_int_equal(cgs_strbuild_length(&sb), 0);
+        assert_non_null(cgs_strbuild_append_string(&sb, &s));
+        assert_int_equal(cgs_strbuild_length(&sb), 47);
+
+        cgs_string_free(&s);
+        cgs_strbuild_free(&sb);
+}
+
+struct chunk_check {
+        size_t total;
+        size_t count;
+        const char* text;
+};
+
+static void
+check_chunk(const void* e, size_t i, void* data)
+{
+        const struct cgs_strsub* ss = e;
+        struct chunk_check* c = data;
+
+        assert_int_equal(i, c->count++);
+        assert_true(ss->length > 0);
+        assert_memory_equal(ss->data, &c->text[c->total], ss->length);
+        c->total += ss->length;
+}
+
+static void
+strbuild_large_test(void** state)
+{
+        (void)state;
+
+        // mix small, chunk-spanning and formatted appends
+        enum { CAP = 1 << 20 };
+        char* flat = malloc(CAP);
+        assert_non_null(flat);
+        char text[5000];
+        for (size_t i = 0; i < sizeof(text); ++i)
+                text[i] = 'a' + i % 26;
+
+        struct cgs_strbuild sb = cgs_strbuild_new();
+        size_t n = 0;
+        srand(5);
+        while (n < CAP - 6000) {
+                switch (rand() % 3) {
+                case 0: {
+                        size_t len = rand() % 4 ? rand() % 16 : rand() % 5000;
+                        assert_non_null(cgs_strbuild_append(&sb, text, len));
+                        memcpy(&flat[n], text, len);
+                        n += len;
+                        break;
+                }
+                case 1:
+                        assert_non_null(cgs_strbuild_push(&sb, 'x'));
+                        flat[n++] = 'x';
+                        break;
+                default: {
+                        int v = rand();
+                        int w = rand() % 8 ? 4 : 3000;
+                        assert_non_null(cgs_strbuild_appendf(&sb, "%*d,",
+                                                w, v));
+                        n += sprintf(&flat[n], "%*d,", w, v);
+                        break;
+                }
+                }
+        }
+        assert_int_equal(cgs_strbuild_length(&sb), n);
+        assert_true(sb.chunks > 1);
+
+        struct cgs_string s = cgs_string_new();
+        assert_non_null(cgs_strbuild_to_string(&sb, &s));
+        assert_int_equal(s.length, n);
+        assert_int_equal(s.capacity, n + 1);
+        assert_memory_equal(cgs_string_data(&s), flat, n);
+
+        struct chunk_check c = { .text = flat };
+        cgs_strbuild_foreach(&sb, check_chunk, &c);
+        assert_int_equal(c.total, n);
+
+        // the file descriptor path must write every byte in order
+        FILE* fp = tmpfile();
+        assert_non_null(fp);
+        assert_non_null(cgs_strbuild_write_fd(&sb, fileno(fp)));
+        assert_non_null(cgs_strbuild_write(&sb, fp));
+        assert_int_equal(fflush(fp), 0);
+        rewind(fp);
+
+        char* back = malloc(2 * n);
+        assert_non_null(back);
+        assert_int_equal(fread(back, 1, 2 * n, fp), 2 * n);
+        assert_memory_equal(back, flat, n);
+        assert_memory_equal(&back[n], flat, n);
+
+        fclose(fp);
+        free(back);
+        cgs_string_free(&s);
+        cgs_strbuild_free(&sb);
+        free(flat);
+}
+
+int main(void)
+{
+        const struct CMUnitTest tests[] = {
+                cmocka_unit_test(strbuild_append_test),
+                cmocka_unit_test(strbuild_large_test),
+        };
+
+        return cmocka_run_group_tests(tests, NULL, NULL);
+}
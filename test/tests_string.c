@@ -1,5 +1,12 @@
 #include "cmocka_headers.h"
 
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cgs_compare.h"
 #include "cgs_string.h"
 
 static void
@@ -10,8 +17,8 @@ string_new_test(void** state)
         struct cgs_string s = cgs_string_new();
 
 	assert_int_equal(s.length, 0);
-        assert_int_equal(s.capacity, 0);
-        assert_string_equal(s.data, "");
+        assert_int_equal(s.capacity, CGS_STRING_INLINE_SIZE);
+        assert_string_equal(cgs_string_data(&s), "");
 }
 
 static void
@@ -25,7 +32,7 @@ string_copy_test(void** state)
 
         struct cgs_string s2 = cgs_string_new();
         assert_non_null(cgs_string_copy(&s1, &s2));
-        assert_string_equal(s2.data, s0);
+        assert_string_equal(cgs_string_data(&s2), s0);
         assert_int_equal(s1.length, s2.length);
 
         cgs_string_free(&s1);
@@ -44,12 +51,12 @@ string_move_test(void** state)
         struct cgs_string s2 = cgs_string_new();
         cgs_string_move(&s1, &s2);
 
-        assert_string_equal(s2.data, s0);
+        assert_string_equal(cgs_string_data(&s2), s0);
         assert_int_equal(s2.length, 18);
         
-        assert_string_equal(s1.data, "");
+        assert_string_equal(cgs_string_data(&s1), "");
         assert_int_equal(s1.length, 0);
-        assert_int_equal(s1.capacity, 0);
+        assert_int_equal(s1.capacity, CGS_STRING_INLINE_SIZE);
 
         cgs_string_free(&s2);
 
@@ -61,8 +68,8 @@ string_move_test(void** state)
         cgs_string_from("Dirty Dancing", &s4);
 
         cgs_string_move(&s4, &s3);
-        assert_string_equal(s3.data, "Dirty Dancing");
-        assert_string_equal(s4.data, "");
+        assert_string_equal(cgs_string_data(&s3), "Dirty Dancing");
+        assert_string_equal(cgs_string_data(&s4), "");
 
         cgs_string_free(&s3);
 }
@@ -93,23 +100,109 @@ string_from_int_test(void** state)
         // test positive integer
         struct cgs_string s1 = cgs_string_new();
         assert_non_null(cgs_string_from_int(1967, &s1));
-        assert_string_equal(s1.data, "1967");
+        assert_string_equal(cgs_string_data(&s1), "1967");
 
         // test negative integer
         struct cgs_string s2 = cgs_string_new();
         assert_non_null(cgs_string_from_int(-837, &s2));
-        assert_string_equal(s2.data, "-837");
+        assert_string_equal(cgs_string_data(&s2), "-837");
 
         // test zero
         struct cgs_string s3 = cgs_string_new();
         assert_non_null(cgs_string_from_int(0, &s3));
-        assert_string_equal(s3.data, "0");
+        assert_string_equal(cgs_string_data(&s3), "0");
 
         cgs_string_free(&s1);
         cgs_string_free(&s2);
         cgs_string_free(&s3);
 }
 
+static void
+string_append_number_test(void** state)
+{
+        (void)state;
+
+        struct cgs_string s = cgs_string_new();
+        assert_non_null(cgs_string_append_int(&s, INT_MIN));
+        assert_non_null(cgs_string_push(&s, ' '));
+        assert_non_null(cgs_string_append_uint(&s, UINT_MAX));
+        assert_non_null(cgs_string_push(&s, ' '));
+        assert_non_null(cgs_string_append_long(&s, 0));
+        assert_non_null(cgs_string_push(&s, ' '));
+        assert_non_null(cgs_string_append_i64(&s, INT64_MIN));
+        assert_non_null(cgs_string_push(&s, ' '));
+        assert_non_null(cgs_string_append_u64(&s, UINT64_MAX));
+        assert_true(cgs_string_eq_str(&s, "-2147483648 4294967295 0 "
+                        "-9223372036854775808 18446744073709551615"));
+        assert_int_equal(s.length, strlen(cgs_string_data(&s)));
+
+        // every digit count
+        char buf[32];
+        for (uint64_t n = 1, i = 0; i < 20; ++i, n *= 10) {
+                cgs_string_clear(&s);
+                assert_non_null(cgs_string_append_u64(&s, n - 1));
+                snprintf(buf, sizeof(buf), "%" PRIu64, n - 1);
+                assert_string_equal(cgs_string_data(&s), buf);
+        }
+        cgs_string_free(&s);
+}
+
+static void
+string_append_double_test(void** state)
+{
+        (void)state;
+
+        const double vals[] = { 0.0, 1.0, -2.5, 0.1, 0.3, 1.0 / 3.0, 1e22,
+                1e23, 5e-324, 1.7976931348623157e308, 123456.789, 0.1 + 0.2,
+        };
+        const char* expect[] = { "0", "1", "-2.5", "0.1", "0.3",
+                "0.3333333333333333", "1e+22", "1e+23", "5e-324",
+                "1.7976931348623157e+308", "123456.789", "0.30000000000000004",
+        };
+
+        struct cgs_string s = cgs_string_new();
+        for (size_t i = 0; i < sizeof(vals) / sizeof(vals[0]); ++i) {
+                cgs_string_clear(&s);
+                assert_non_null(cgs_string_append_double(&s, vals[i]));
+                assert_int_equal(s.length, strlen(cgs_string_data(&s)));
+                assert_true(strtod(cgs_string_data(&s), NULL) == vals[i]);
+                assert_string_equal(cgs_string_data(&s), expect[i]);
+        }
+        cgs_string_free(&s);
+}
+
+static void
+string_appendf_test(void** state)
+{
+        (void)state;
+
+        struct cgs_string s = cgs_string_new();
+        assert_non_null(cgs_string_appendf(&s, "%s=%d", "x", 42));
+        assert_string_equal(cgs_string_data(&s), "x=42");
+        assert_int_equal(s.length, 4);
+        assert_int_equal(s.capacity, CGS_STRING_INLINE_SIZE);
+
+        // a strsub is not NUL-terminated
+        struct cgs_strsub ss = cgs_strsub_new("key: value", 3);
+        assert_non_null(cgs_string_appendf(&s, " [" CGS_STRSUB_FMT "]",
+                                CGS_STRSUB_ARG(&ss)));
+        assert_string_equal(cgs_string_data(&s), "x=42 [key]");
+
+        // output past the spare capacity grows the string to fit exactly
+        char big[200];
+        memset(big, 'z', sizeof(big) - 1);
+        big[sizeof(big) - 1] = '\0';
+        assert_non_null(cgs_string_appendf(&s, "%s%05.1f", big, 2.25));
+        assert_int_equal(s.length, 10 + 199 + 5);
+        assert_int_equal(s.capacity, s.length + 1);
+        assert_int_equal(strncmp(cgs_string_data(&s), "x=42 [key]zzz", 13), 0);
+        assert_string_equal(cgs_string_data(&s) + s.length - 6, "z002.2");
+
+        assert_non_null(cgs_string_appendf(&s, "%s", ""));
+        assert_int_equal(s.length, 214);
+        cgs_string_free(&s);
+}
+
 /*
 int string_xfer_test(void* data)
 {
@@ -129,6 +222,51 @@ int string_xfer_test(void* data)
 }
 */
 
+static void
+string_inline_test(void** state)
+{
+        (void)state;
+        const char* tok = "twenty-two characters!";         // 22
+        const char* big = "twenty-four characters!!";       // 24, spills
+
+        struct cgs_string s1 = cgs_string_new();
+        assert_non_null(cgs_string_from(tok, &s1));
+        assert_null(s1.data);
+        assert_ptr_equal(cgs_string_data(&s1), s1.local);
+
+        // one more character still fits, the terminator fills the buffer
+        assert_non_null(cgs_string_push(&s1, '?'));
+        assert_null(s1.data);
+        assert_int_equal(cgs_string_length(&s1), CGS_STRING_INLINE_SIZE - 1);
+
+        // inline strings survive being moved by assignment
+        struct cgs_string s2 = s1;
+        assert_string_equal(cgs_string_data(&s2), "twenty-two characters!?");
+
+        assert_non_null(cgs_string_push(&s2, '!'));
+        assert_non_null(s2.data);
+        assert_string_equal(cgs_string_data(&s2), "twenty-two characters!?!");
+
+        // xfer hands out an allocation even for inline strings
+        struct cgs_string s3 = cgs_string_new();
+        cgs_string_from("short", &s3);
+        char* p = cgs_string_xfer(&s3);
+        assert_non_null(p);
+        assert_string_equal(p, "short");
+        assert_int_equal(cgs_string_length(&s3), 0);
+        assert_string_equal(cgs_string_data(&s3), "");
+        free(p);
+
+        struct cgs_string s4 = cgs_string_new();
+        cgs_string_from(big, &s4);
+        assert_non_null(s4.data);
+        p = cgs_string_xfer(&s4);
+        assert_string_equal(p, big);
+        free(p);
+
+        cgs_string_free(&s2);
+}
+
 static void
 string_cmp_test(void** state)
 {
@@ -177,7 +315,7 @@ string_push_test(void** state)
 	assert_non_null(cgs_string_push(&s, 'h'));
 
 	assert_int_equal(s.length, 4);
-	assert_string_equal(s.data, "push");
+	assert_string_equal(cgs_string_data(&s), "push");
 
 	cgs_string_free(&s);
 }
@@ -197,6 +335,10 @@ string_cat_test(void** state)
         assert_string_equal(cgs_string_data(&s2),
                         "than be a swinger of birches");
 
+        assert_non_null(cgs_string_cat(&s2, &s2));      // cat to self
+        assert_string_equal(cgs_string_data(&s2), "than be a swinger of "
+                        "birchesthan be a swinger of birches");
+
         cgs_string_free(&s1);
         cgs_string_free(&s2);
 }
@@ -214,13 +356,13 @@ string_trunc_test(void** state)
         cgs_string_trunc(&s1, 10);
 
         assert_int_equal(s1.length, 10);                // length is shortened
-        assert_string_equal(s1.data, "Think diff");     // string is altered
+        assert_string_equal(cgs_string_data(&s1), "Think diff");     // string is altered
 
         // truncate to length longer than current string
         cgs_string_trunc(&s1, 16);
 
         assert_int_equal(s1.length, 10);                // length is unchanged
-        assert_string_equal(s1.data, "Think diff");     // string is unchanged
+        assert_string_equal(cgs_string_data(&s1), "Think diff");     // string is unchanged
 
         cgs_string_free(&s1);
 }
@@ -234,11 +376,55 @@ string_reverse_test(void** state)
 
         cgs_string_reverse(&s1);
 
-        assert_string_equal(s1.data, "!dlroW ,olleH");
+        assert_string_equal(cgs_string_data(&s1), "!dlroW ,olleH");
 
         cgs_string_free(&s1);
 }
 
+static void
+string_counting_sort_test(void** state)
+{
+        (void)state;
+
+        // both sides of the insertion sort cutoff, with bytes above 0x7f
+        char buf[600];
+        unsigned x = 11;
+        for (size_t n = 0; n < sizeof(buf); n += n < 40 ? 1 : 97) {
+                struct cgs_string s = cgs_string_new();
+                for (size_t i = 0; i < n; ++i) {
+                        x = x * 1103515245u + 12345u;
+                        buf[i] = (char)(1 + (x >> 16) % 255);
+                }
+                assert_non_null(cgs_string_cat_str(&s, buf, n));
+
+                cgs_string_sort(&s);
+                qsort(buf, n, sizeof(char), cgs_char_cmp);
+                assert_int_equal(s.length, n);
+                assert_memory_equal(cgs_string_data(&s), buf, n);
+                assert_int_equal(cgs_string_data(&s)[n], '\0');
+
+                cgs_string_free(&s);
+        }
+}
+
+static void
+string_case_test(void** state)
+{
+        (void)state;
+
+        struct cgs_string s = cgs_string_new();
+        cgs_string_from("Think Different, 1997 \xc3\x89" "dition", &s);
+
+        cgs_string_toupper(&s);
+        assert_string_equal(cgs_string_data(&s),
+                        "THINK DIFFERENT, 1997 \xc3\x89" "DITION");
+        cgs_string_tolower(&s);
+        assert_string_equal(cgs_string_data(&s),
+                        "think different, 1997 \xc3\x89" "dition");
+
+        cgs_string_free(&s);
+}
+
 static void
 replace_test(void** state)
 {
@@ -303,6 +489,25 @@ find_test(void** state)
         assert_int_equal(cgs_string_find(&s1, &s5), s1.length);
         assert_int_equal(cgs_string_find(&s1, &s6), s1.length);
 
+        // Last occurrence and all occurrences
+        struct cgs_string s7 = cgs_string_new();
+        cgs_string_from("ay", &s7);
+        assert_int_equal(cgs_string_rfind(&s1, &s7), 18);
+        assert_int_equal(cgs_string_rfind(&s1, &s6), s1.length);
+
+        struct cgs_vector v = cgs_vector_new(sizeof(size_t));
+        assert_non_null(cgs_string_find_all(&s1, &s7, &v));
+        assert_int_equal(cgs_vector_length(&v), 1);
+        assert_int_equal(*(const size_t*)cgs_vector_get(&v, 0), 18);
+
+        cgs_vector_clear(&v);
+        cgs_string_from("p", &s7);
+        assert_non_null(cgs_string_find_all(&s1, &s7, &v));
+        assert_int_equal(cgs_vector_length(&v), 2);
+        assert_int_equal(*(const size_t*)cgs_vector_get(&v, 1), 6);
+        cgs_vector_free(&v);
+        cgs_string_free(&s7);
+
         cgs_string_free(&s1);
         cgs_string_free(&s2);
         cgs_string_free(&s3);
@@ -456,11 +661,17 @@ int main(void)
                 cmocka_unit_test(string_move_test),
                 cmocka_unit_test(string_from_test),
                 cmocka_unit_test(string_from_int_test),
+                cmocka_unit_test(string_append_number_test),
+                cmocka_unit_test(string_append_double_test),
+                cmocka_unit_test(string_appendf_test),
+                cmocka_unit_test(string_inline_test),
                 cmocka_unit_test(string_cmp_test),
                 cmocka_unit_test(string_push_test),
                 cmocka_unit_test(string_cat_test),
                 cmocka_unit_test(string_trunc_test),
                 cmocka_unit_test(string_reverse_test),
+                cmocka_unit_test(string_counting_sort_test),
+                cmocka_unit_test(string_case_test),
                 cmocka_unit_test(replace_test),
                 cmocka_unit_test(find_test),
         };
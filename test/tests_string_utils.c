@@ -3,6 +3,8 @@
 #include "cgs_string_utils.h"
 
 #include <stdlib.h>     // free
+#include <string.h>
+#include <stdint.h>     // INT32_MAX, INT32_MIN
 
 static void
 strdup_test(void** state)
@@ -61,11 +63,38 @@ strtoi_test(void** state)
         const char* p4 = NULL;
         int n4 = cgs_strtoi(s4, &p4);
 
-        (void)n4;
+        assert_int_equal(n4, 0);
         assert_non_null(p4);
         assert_ptr_equal(p4, s4);               // error indication
 }
 
+static void
+strtoi_limits_test(void** state)
+{
+        (void)state;
+
+        const char* p = NULL;
+        assert_int_equal(cgs_strtoi("2147483647", &p), INT32_MAX);
+        assert_string_equal(p, "");
+        assert_int_equal(cgs_strtoi("-2147483648,", &p), INT32_MIN);
+        assert_string_equal(p, ",");
+
+        // one past either end must fail rather than stop part way
+        const char* s1 = "2147483648";
+        assert_int_equal(cgs_strtoi(s1, &p), 0);
+        assert_ptr_equal(p, s1);
+
+        const char* s2 = " -2147483649 ";
+        assert_int_equal(cgs_strtoi(s2, &p), 0);
+        assert_ptr_equal(p, s2);
+
+        const char* s3 = "-";
+        assert_int_equal(cgs_strtoi(s3, &p), 0);
+        assert_ptr_equal(p, s3);
+
+        assert_int_equal(cgs_strtoi("\t+42", NULL), 42);
+}
+
 /*
 int strmove_test(void* data)
 {
@@ -279,6 +308,193 @@ int strtrimch_test(void* data)
 }
 */
 
+static size_t
+naive_find(const char* s, size_t n, const char* sub, size_t m)
+{
+        for (size_t i = 0; i + m <= n; ++i)
+                if (memcmp(&s[i], sub, m) == 0)
+                        return i;
+        return m == 0 ? 0 : n;
+}
+
+static size_t
+naive_rfind(const char* s, size_t n, const char* sub, size_t m)
+{
+        if (m == 0 || m > n)
+                return n;
+        for (size_t i = n - m + 1; i-- > 0; )
+                if (memcmp(&s[i], sub, m) == 0)
+                        return i;
+        return n;
+}
+
+static void
+memfind_test(void** state)
+{
+        (void)state;
+        enum { LEN = 4096 };
+
+        // a small alphabet makes partial matches common
+        char buf[LEN];
+        unsigned x = 7;
+        for (size_t i = 0; i < LEN; ++i) {
+                x = x * 1103515245u + 12345u;
+                buf[i] = "abc\0"[(x >> 16) % 4];
+        }
+
+        // every tier and every alignment of the haystack
+        for (size_t m = 0; m <= 80; m += m < 8 ? 1 : 9) {
+                for (size_t off = 0; off < 300; off += 37) {
+                        const char* sub = &buf[LEN - 200 + off % 100];
+                        const char* hay = &buf[off];
+                        size_t n = LEN - 300;
+
+                        assert_int_equal(cgs_memfind(hay, n, sub, m),
+                                        naive_find(hay, n, sub, m));
+                        assert_int_equal(cgs_memrfind(hay, n, sub, m),
+                                        naive_rfind(hay, n, sub, m));
+                }
+        }
+
+        // matches at the very end and needles longer than the haystack
+        const char* text = "needle in a haystack with a needle";
+        size_t n = strlen(text);
+        assert_int_equal(cgs_memfind(text, n, "needle", 6), 0);
+        assert_int_equal(cgs_memrfind(text, n, "needle", 6), n - 6);
+        assert_int_equal(cgs_memfind(text, n, "e", 1), 1);
+        assert_int_equal(cgs_memrfind(text, n, "e", 1), n - 1);
+        assert_int_equal(cgs_memfind(text, 3, "needle", 6), 3);
+        assert_int_equal(cgs_memfind(text, n, "haystacks", 9), n);
+}
+
+static void
+byte_histogram_test(void** state)
+{
+        (void)state;
+        enum { LEN = 5000 };
+
+        char buf[LEN];
+        size_t expect[256] = { 0 };
+        for (size_t i = 0; i < LEN; ++i) {
+                buf[i] = (char)(i * i % 251);
+                ++expect[(unsigned char)buf[i]];
+        }
+
+        // a long buffer, then a short one added to the same histogram
+        size_t counts[256] = { 0 };
+        cgs_str_byte_histogram(buf, LEN, counts);
+        assert_memory_equal(counts, expect, sizeof(counts));
+
+        cgs_str_byte_histogram("\xff\xff" "a", 3, counts);
+        expect[0xff] += 2;
+        expect['a'] += 1;
+        assert_memory_equal(counts, expect, sizeof(counts));
+
+        assert_true(cgs_str_is_anagram("listen", 6, "silent", 6));
+        assert_true(cgs_str_is_anagram("", 0, "", 0));
+        assert_false(cgs_str_is_anagram("listen", 6, "silence", 7));
+        assert_false(cgs_str_is_anagram("aab", 3, "abb", 3));
+}
+
+static void
+case_test(void** state)
+{
+        (void)state;
+        enum { LEN = 300 };
+
+        // every byte value at every position of a block
+        char src[LEN];
+        char lower[LEN];
+        char upper[LEN];
+        for (size_t i = 0; i < LEN; ++i)
+                src[i] = (char)(i * 7);
+
+        for (size_t off = 0; off < 20; ++off) {
+                size_t n = LEN - off;
+                cgs_memlower(lower, &src[off], n);
+                cgs_memupper(upper, &src[off], n);
+                for (size_t i = 0; i < n; ++i) {
+                        unsigned char c = src[off + i];
+                        int lc = c >= 'A' && c <= 'Z' ? c + 32 : c;
+                        int uc = c >= 'a' && c <= 'z' ? c - 32 : c;
+                        assert_int_equal((unsigned char)lower[i], lc);
+                        assert_int_equal((unsigned char)upper[i], uc);
+                }
+                assert_int_equal(cgs_memcasecmp(lower, upper, n), 0);
+
+                // first difference after the case-folded prefix
+                for (size_t d = 0; d < n; d += 13) {
+                        char saved = upper[d];
+                        upper[d] = lower[d] == 'q' ? 'r' : 'Q';
+                        int expect = lower[d] == 'q' ? 'q' - 'r'
+                                : (unsigned char)lower[d] - 'q';
+                        assert_int_equal(cgs_memcasecmp(lower, upper, n),
+                                        expect);
+                        upper[d] = saved;
+                }
+        }
+
+        // in place
+        char buf[] = "Hello, World! ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+        cgs_memlower(buf, buf, strlen(buf));
+        assert_string_equal(buf, "hello, world! abcdefghijklmnopqrstuvwxyz");
+
+        assert_int_equal(cgs_strcasecmp("Howdy", "hOWDY"), 0);
+        assert_true(cgs_strcasecmp("long", "LONGER") < 0);
+        assert_true(cgs_strcasecmp("Less", "more") < 0);
+        assert_true(cgs_strcasecmp("[", "a") < 0);      // '[' < 'a' folded
+        assert_int_equal(cgs_ascii_tolower('Z'), 'z');
+        assert_int_equal(cgs_ascii_toupper('z'), 'Z');
+        assert_int_equal(cgs_ascii_toupper(0xE9), 0xE9);
+}
+
+static void
+trim_test(void** state)
+{
+        (void)state;
+
+        char s1[] = " \t trim it! \n\t \t";
+        cgs_strtrim(s1);
+        assert_string_equal(s1, "trim it!");
+
+        char s2[] = "";
+        cgs_strtrim(s2);
+        assert_string_equal(s2, "");
+
+        char s3[] = " \v\f\r\n ";
+        cgs_strtrim(s3);
+        assert_string_equal(s3, "");
+
+        char s4[] = "00Hello 0!000";
+        cgs_strtrimch(s4, '0');
+        assert_string_equal(s4, "Hello 0!");
+        cgs_strtrimch(s4, 'l');
+        assert_string_equal(s4, "Hello 0!");
+
+        char s5[] = "0000";
+        cgs_strtrimch(s5, '0');
+        assert_string_equal(s5, "");
+
+        // runs of every length around the block size, with all six
+        // whitespace bytes and their neighbours
+        const char ws[] = " \t\n\v\f\r";
+        char buf[100];
+        for (size_t lead = 0; lead < 40; ++lead) {
+                for (size_t i = 0; i < lead; ++i)
+                        buf[i] = ws[(i * 5 + lead) % 6];
+                buf[lead] = "\b\x0e\x1fx"[lead % 4];
+                for (size_t i = lead + 1; i < sizeof(buf); ++i)
+                        buf[i] = ws[i % 6];
+
+                assert_int_equal(cgs_memspn_space(buf, sizeof(buf)), lead);
+                assert_int_equal(cgs_memrspn_space(buf, lead + 1), 0);
+                assert_int_equal(cgs_memrspn_space(buf, sizeof(buf)),
+                                sizeof(buf) - lead - 1);
+                assert_int_equal(cgs_memspn_space(buf, lead), lead);
+                assert_int_equal(cgs_memrspn_space(buf, lead), lead);
+        }
+}
+
 int main(void)
 {
         /*
@@ -299,6 +515,11 @@ int main(void)
         const struct CMUnitTest tests[] = {
                 cmocka_unit_test(strdup_test),
                 cmocka_unit_test(strtoi_test),
+                cmocka_unit_test(strtoi_limits_test),
+                cmocka_unit_test(memfind_test),
+                cmocka_unit_test(byte_histogram_test),
+                cmocka_unit_test(case_test),
+                cmocka_unit_test(trim_test),
         };
 
         return cmocka_run_group_tests(tests, NULL, NULL);
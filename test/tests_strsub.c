@@ -163,6 +163,86 @@ strsub_to_string(void** state)
         cgs_string_free(&s2);
 }
 
+static void
+strsub_find(void** state)
+{
+        (void)state;
+
+        const char* s = "one two one two";
+        struct cgs_strsub ss = cgs_strsub_new(s + 4, 11);       // "two one two"
+        struct cgs_strsub two = cgs_strsub_from_str("two");
+        struct cgs_strsub three = cgs_strsub_from_str("three");
+
+        assert_int_equal(cgs_strsub_find(&ss, &two), 0);
+        assert_int_equal(cgs_strsub_rfind(&ss, &two), 8);
+        assert_int_equal(cgs_strsub_find(&ss, &three), ss.length);
+        assert_int_equal(cgs_strsub_rfind(&ss, &three), ss.length);
+
+        // matches may not run past the end of the view
+        struct cgs_strsub cut = cgs_strsub_new(s + 4, 10);
+        assert_int_equal(cgs_strsub_rfind(&cut, &two), 0);
+}
+
+static void
+strsub_nocase(void** state)
+{
+        (void)state;
+        const char* p = "Content-Length: 42 and some more text";
+        struct cgs_strsub ss1 = cgs_strsub_new(p, 14);
+        struct cgs_strsub ss2 = cgs_strsub_from_str("content-length");
+        struct cgs_strsub ss3 = cgs_strsub_from_str("content-lengths");
+        struct cgs_strsub ss4 = cgs_strsub_from_str("CONTENT-TYPE");
+
+        assert_true(cgs_strsub_eq_nocase(&ss1, &ss2));
+        assert_false(cgs_strsub_eq_nocase(&ss1, &ss3));
+        assert_true(cgs_strsub_eq_str_nocase(&ss1, "CONTENT-LENGTH"));
+        assert_false(cgs_strsub_eq_str_nocase(&ss1, "content-lengt"));
+
+        assert_int_equal(cgs_strsub_cmp_nocase(&ss1, &ss2), 0);
+        assert_true(cgs_strsub_cmp_nocase(&ss1, &ss3) < 0);
+        assert_true(cgs_strsub_cmp_nocase(&ss3, &ss1) > 0);
+        assert_true(cgs_strsub_cmp_nocase(&ss1, &ss4) < 0);
+
+        char buf[64];
+        struct cgs_strsub ss5 = cgs_strsub_from_str(p);
+        cgs_strsub_toupper(&ss5, buf);
+        assert_memory_equal(buf, "CONTENT-LENGTH: 42 AND SOME MORE TEXT",
+                        ss5.length);
+        cgs_strsub_tolower(&ss5, buf);
+        assert_memory_equal(buf, "content-length: 42 and some more text",
+                        ss5.length);
+}
+
+static void
+strsub_trim(void** state)
+{
+        (void)state;
+        const char* p = "  \t field value \r\n";
+
+        struct cgs_strsub ss = cgs_strsub_from_str(p);
+        cgs_strsub_trim_left(&ss);
+        assert_true(cgs_strsub_eq_str(&ss, "field value \r\n"));
+        cgs_strsub_trim_right(&ss);
+        assert_true(cgs_strsub_eq_str(&ss, "field value"));
+
+        ss = cgs_strsub_from_str(p);
+        cgs_strsub_trim(&ss);
+        assert_true(cgs_strsub_eq_str(&ss, "field value"));
+        assert_ptr_equal(ss.data, &p[4]);
+
+        ss = cgs_strsub_from_str("\"'quoted'\"");
+        cgs_strsub_trim_set(&ss, "\"'");
+        assert_true(cgs_strsub_eq_str(&ss, "quoted"));
+
+        ss = cgs_strsub_from_str(" \n ");
+        cgs_strsub_trim(&ss);
+        assert_int_equal(ss.length, 0);
+
+        ss = cgs_strsub_from_str("xxxx");
+        cgs_strsub_trim_set(&ss, "x");
+        assert_int_equal(ss.length, 0);
+}
+
 int main(void)
 {
         const struct CMUnitTest tests[] = {
@@ -172,6 +252,9 @@ int main(void)
                 cmocka_unit_test(strsub_to_int),
                 cmocka_unit_test(strsub_to_str),
                 cmocka_unit_test(strsub_to_string),
+                cmocka_unit_test(strsub_find),
+                cmocka_unit_test(strsub_nocase),
+                cmocka_unit_test(strsub_trim),
         };
 
         return cmocka_run_group_tests(tests, NULL, NULL);
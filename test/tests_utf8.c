@@ -0,0 +1,189 @@
+#include "cmocka_headers.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cgs_utf8.h"
+
+/**
+ * The well-formed byte sequences of Unicode Table 3-7, as ranges of each
+ * byte after the first.
+ */
+static size_t
+naive_sequence(const unsigned char* p, size_t n)
+{
+        static const struct {
+                unsigned char lead_lo, lead_hi;
+                size_t len;
+                unsigned char lo, hi;           // range of the second byte
+        } forms[] = {
+                { 0x00, 0x7F, 1, 0, 0 },
+                { 0xC2, 0xDF, 2, 0x80, 0xBF },
+                { 0xE0, 0xE0, 3, 0xA0, 0xBF },
+                { 0xE1, 0xEC, 3, 0x80, 0xBF },
+                { 0xED, 0xED, 3, 0x80, 0x9F },
+                { 0xEE, 0xEF, 3, 0x80, 0xBF },
+                { 0xF0, 0xF0, 4, 0x90, 0xBF },
+                { 0xF1, 0xF3, 4, 0x80, 0xBF },
+                { 0xF4, 0xF4, 4, 0x80, 0x8F },
+        };
+
+        for (size_t f = 0; f < sizeof(forms) / sizeof(forms[0]); ++f) {
+                if (p[0] < forms[f].lead_lo || p[0] > forms[f].lead_hi)
+                        continue;
+                size_t len = forms[f].len;
+                if (len > n)
+                        return 0;
+                if (len > 1 && (p[1] < forms[f].lo || p[1] > forms[f].hi))
+                        return 0;
+                for (size_t k = 2; k < len; ++k)
+                        if (p[k] < 0x80 || p[k] > 0xBF)
+                                return 0;
+                return len;
+        }
+        return 0;
+}
+
+static size_t
+naive_validate(const char* s, size_t n)
+{
+        size_t i = 0;
+        while (i < n) {
+                size_t len = naive_sequence((const unsigned char*)&s[i],
+                                n - i);
+                if (len == 0)
+                        return i;
+                i += len;
+        }
+        return n;
+}
+
+static void
+utf8_validate_test(void** state)
+{
+        (void)state;
+
+        static const struct {
+                const char* s;
+                size_t valid;
+        } cases[] = {
+                { "", 0 },
+                { "plain ascii", 11 },
+                { "caf\xc3\xa9", 5 },
+                { "\xe2\x82\xac 10", 6 },                       // euro sign
+                { "\xf0\x9f\x98\x80", 4 },                      // U+1F600
+                { "\xf4\x8f\xbf\xbf", 4 },                      // U+10FFFF
+                { "\xef\xbf\xbd", 3 },                          // U+FFFD
+                { "ab\x80", 2 },                                // stray
+                { "\xc0\xaf", 0 },                              // overlong
+                { "\xc1\xbf", 0 },
+                { "\xe0\x9f\xbf", 0 },
+                { "\xf0\x8f\xbf\xbf", 0 },
+                { "\xed\xa0\x80", 0 },                          // surrogate
+                { "\xed\x9f\xbf", 3 },                          // U+D7FF
+                { "\xf4\x90\x80\x80", 0 },                      // too large
+                { "\xf5\x80\x80\x80", 0 },
+                { "\xff", 0 },
+                { "x\xe2\x82", 1 },                             // truncated
+                { "\xe2\x82x", 0 },
+        };
+
+        for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+                size_t n = strlen(cases[i].s);
+                assert_int_equal(cgs_utf8_validate(cases[i].s, n),
+                                cases[i].valid);
+                assert_int_equal(cgs_utf8_valid(cases[i].s, n),
+                                cases[i].valid == n);
+        }
+
+        struct cgs_strsub ss = cgs_strsub_from_str("na\xc3\xafve");
+        assert_true(cgs_strsub_utf8_valid(&ss));
+        assert_int_equal(cgs_strsub_utf8_count(&ss), 5);
+}
+
+static void
+utf8_random_test(void** state)
+{
+        (void)state;
+        enum { LEN = 4096 };
+
+        // valid text of every sequence length, then a few corrupted bytes
+        static const char* const pieces[] = {
+                "a", "Hello, world. ", "\xc3\xa9", "\xd0\x96",
+                "\xe2\x82\xac", "\xe4\xb8\xad", "\xf0\x9f\x98\x80",
+                "\xf4\x8f\xbf\xbf", "\xed\x9f\xbf", "\xee\x80\x80",
+        };
+        char buf[LEN + 16];
+        unsigned x = 9;
+        for (int round = 0; round < 400; ++round) {
+                size_t n = 0;
+                size_t points = 0;
+                while (1) {
+                        x = x * 1103515245u + 12345u;
+                        const char* p = pieces[(x >> 16) % 10];
+                        size_t len = strlen(p);
+                        if (n + len > LEN)
+                                break;
+                        memcpy(&buf[n], p, len);
+                        n += len;
+                        points += (x >> 16) % 10 == 1 ? 14 : 1;
+                }
+
+                assert_int_equal(cgs_utf8_validate(buf, n), n);
+                assert_int_equal(cgs_utf8_count(buf, n), points);
+
+                for (int k = round % 4; k > 0; --k) {
+                        x = x * 1103515245u + 12345u;
+                        buf[(x >> 8) % n] = (char)(x >> 24);
+                }
+                for (size_t off = 0; off < 48; off += 7)
+                        assert_int_equal(cgs_utf8_validate(&buf[off],
+                                                n - off),
+                                        naive_validate(&buf[off], n - off));
+        }
+
+        // ASCII runs long enough for the wide skip
+        memset(buf, 'a', LEN);
+        assert_int_equal(cgs_utf8_ascii_prefix(buf, LEN), LEN);
+        buf[1000] = (char)0xc3;
+        assert_int_equal(cgs_utf8_ascii_prefix(buf, LEN), 1000);
+        assert_int_equal(cgs_utf8_validate(buf, LEN), 1000);
+}
+
+static void
+utf8_iter_test(void** state)
+{
+        (void)state;
+
+        struct cgs_strsub ss = cgs_strsub_from_str(
+                        "a\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80\x80z");
+        const uint32_t expect[] = {
+                'a', 0xE9, 0x20AC, 0x1F600, CGS_UTF8_REPLACEMENT, 'z',
+        };
+
+        struct cgs_utf8_iter it = cgs_utf8_iter_new(&ss);
+        uint32_t cp;
+        size_t i = 0;
+        while (cgs_utf8_iter_next(&it, &cp)) {
+                assert_true(i < sizeof(expect) / sizeof(expect[0]));
+                assert_int_equal(cp, expect[i++]);
+        }
+        assert_int_equal(i, sizeof(expect) / sizeof(expect[0]));
+        assert_null(cgs_utf8_iter_next(&it, &cp));
+
+        assert_int_equal(cgs_utf8_decode("\xe2\x82", 2, &cp), 0);
+        assert_int_equal(cgs_utf8_decode("\xe2\x82\xac", 3, &cp), 3);
+        assert_int_equal(cp, 0x20AC);
+}
+
+int main(void)
+{
+        const struct CMUnitTest tests[] = {
+                cmocka_unit_test(utf8_validate_test),
+                cmocka_unit_test(utf8_random_test),
+                cmocka_unit_test(utf8_iter_test),
+        };
+
+        return cmocka_run_group_tests(tests, NULL, NULL);
+}
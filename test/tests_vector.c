@@ -1,10 +1,13 @@
 #include "cmocka_headers.h"
 
+#include <stdint.h>	// uintptr_t
 #include <stdlib.h>	// malloc, free
+#include <string.h>	// memset
 
 #include "cgs_vector.h"
 
 #include "cgs_compare.h"
+#include "cgs_parallel.h"
 #include "cgs_string_utils.h"
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -513,6 +516,361 @@ vector_min_max_test(void** state)
         cgs_vector_free(&v1);
 }
 
+static void
+vector_reserve_resize_test(void** state)
+{
+        (void)state;
+        struct cgs_vector v = cgs_vector_new(sizeof(int));
+
+        assert_non_null(cgs_vector_reserve(&v, 100));
+        assert_int_equal(v.capacity, 100);
+        assert_int_equal(v.length, 0);
+
+        const char* data = v.data;
+        for (int i = 0; i < 100; ++i)
+                cgs_vector_push(&v, &i);
+        assert_ptr_equal(v.data, data);         // no reallocation
+
+        assert_non_null(cgs_vector_reserve(&v, 10));
+        assert_int_equal(v.capacity, 100);      // never shrinks
+
+        assert_non_null(cgs_vector_resize(&v, 5));
+        assert_int_equal(cgs_vector_length(&v), 5);
+
+        assert_non_null(cgs_vector_resize(&v, 150));
+        assert_int_equal(cgs_vector_length(&v), 150);
+        const int* p = cgs_vector_data(&v);
+        assert_int_equal(p[4], 4);
+        for (size_t i = 5; i < 150; ++i)
+                assert_int_equal(p[i], 0);
+
+        assert_non_null(cgs_vector_resize(&v, 3));
+        assert_non_null(cgs_vector_shrink(&v));
+        assert_int_equal(v.capacity, 3);
+        p = cgs_vector_data(&v);
+        assert_int_equal(p[2], 2);
+
+        cgs_vector_clear(&v);
+        assert_non_null(cgs_vector_shrink(&v));
+        assert_int_equal(v.capacity, 0);
+        assert_null(v.data);
+
+        cgs_vector_free(&v);
+}
+
+static size_t
+grow_by_three(size_t old)
+{
+        return old + 3;
+}
+
+static void
+vector_growth_test(void** state)
+{
+        (void)state;
+        struct cgs_vector v = cgs_vector_new(sizeof(int));
+        cgs_vector_set_growth(&v, grow_by_three);
+
+        int x = 7;
+        cgs_vector_push(&v, &x);
+        assert_int_equal(v.capacity, 3);
+        for (int i = 0; i < 3; ++i)
+                cgs_vector_push(&v, &x);
+        assert_int_equal(v.capacity, 6);
+
+        cgs_vector_set_growth(&v, NULL);
+        for (int i = 0; i < 3; ++i)
+                cgs_vector_push(&v, &x);
+        assert_int_equal(v.capacity, 12);
+
+        cgs_vector_free(&v);
+}
+
+static void
+vector_extend_test(void** state)
+{
+	const int* ints = *(const int**)state;
+        struct cgs_vector v1 = cgs_vector_new(sizeof(int));
+
+        assert_non_null(cgs_vector_extend(&v1, ints, NUM_RANDOMS));
+        assert_non_null(cgs_vector_extend(&v1, ints, 3));
+        assert_int_equal(cgs_vector_length(&v1), NUM_RANDOMS + 3);
+        for (int i = 0; i < NUM_RANDOMS; ++i)
+                assert_int_equal(*(const int*)cgs_vector_get(&v1, i), ints[i]);
+        assert_int_equal(*(const int*)cgs_vector_last(&v1), ints[2]);
+
+        struct cgs_vector v2 = cgs_vector_new(sizeof(int));
+        assert_non_null(cgs_vector_extend_vec(&v2, &v1));
+        assert_non_null(cgs_vector_extend_vec(&v2, &v1));
+        assert_int_equal(cgs_vector_length(&v2), 2 * (NUM_RANDOMS + 3));
+        assert_int_equal(*(const int*)cgs_vector_get(&v2, NUM_RANDOMS + 3),
+                        ints[0]);
+
+        struct cgs_vector v3 = cgs_vector_new(sizeof(double));
+        assert_null(cgs_vector_extend_vec(&v3, &v1));
+
+        cgs_vector_free(&v1);
+        cgs_vector_free(&v2);
+        cgs_vector_free(&v3);
+}
+
+static void
+vector_insert_range_test(void** state)
+{
+        (void)state;
+        const int a1[] = { 1, 2, 6, 7 };
+        const int a2[] = { 3, 4, 5 };
+        const int a3[] = { 0 };
+        const int a4[] = { 8, 9 };
+
+        struct cgs_vector v = cgs_vector_new(sizeof(int));
+        assert_non_null(cgs_vector_insert_range(&v, 0, a1, 4));
+        assert_non_null(cgs_vector_insert_range(&v, 2, a2, 3));
+        assert_non_null(cgs_vector_insert_range(&v, 0, a3, 1));
+        assert_non_null(cgs_vector_insert_range(&v, 8, a4, 2));
+        assert_non_null(cgs_vector_insert_range(&v, 4, a4, 0));
+
+        assert_int_equal(cgs_vector_length(&v), 10);
+        const int* p = cgs_vector_data(&v);
+        for (int i = 0; i < 10; ++i)
+                assert_int_equal(p[i], i);
+
+        cgs_vector_free(&v);
+}
+
+static int
+is_even(const void* a, const void* b)
+{
+        (void)b;
+        return *(const int*)a % 2 == 0;
+}
+
+static void
+vector_remove_if_test(void** state)
+{
+        (void)state;
+        struct cgs_vector v = cgs_vector_new(sizeof(int));
+        for (int i = 0; i < 20; ++i)
+                cgs_vector_push(&v, &i);
+
+        assert_int_equal(cgs_vector_remove_if(&v, is_even, NULL), 10);
+        assert_int_equal(cgs_vector_length(&v), 10);
+        const int* p = cgs_vector_data(&v);
+        for (int i = 0; i < 10; ++i)
+                assert_int_equal(p[i], 2 * i + 1);
+
+        assert_int_equal(cgs_vector_remove_if(&v, is_even, NULL), 0);
+        assert_int_equal(cgs_vector_retain(&v, is_even, NULL), 10);
+        assert_int_equal(cgs_vector_length(&v), 0);
+
+        int x = 4;
+        cgs_vector_push(&v, &x);
+        x = 5;
+        cgs_vector_push(&v, &x);
+        x = 6;
+        cgs_vector_push(&v, &x);
+        assert_int_equal(cgs_vector_retain(&v, is_even, NULL), 1);
+        p = cgs_vector_data(&v);
+        assert_int_equal(p[0], 4);
+        assert_int_equal(p[1], 6);
+
+        cgs_vector_free(&v);
+}
+
+static int
+is_among_first(const void* a, const void* b)
+{
+        (void)a;
+        size_t* left = (size_t*)b;
+        if (*left == 0)
+                return 0;
+        --*left;
+        return 1;
+}
+
+static void
+vector_remove_if_stateful_test(void** state)
+{
+        (void)state;
+        struct cgs_vector v = cgs_vector_new(sizeof(int));
+        for (int i = 0; i < 10; ++i)
+                cgs_vector_push(&v, &i);
+
+        // the predicate must see every element exactly once
+        size_t first = 3;
+        assert_int_equal(cgs_vector_remove_if(&v, is_among_first, &first), 3);
+        assert_int_equal(cgs_vector_length(&v), 7);
+        const int* p = cgs_vector_data(&v);
+        for (int i = 0; i < 7; ++i)
+                assert_int_equal(p[i], i + 3);
+
+        first = 2;
+        assert_int_equal(cgs_vector_retain(&v, is_among_first, &first), 5);
+        assert_int_equal(cgs_vector_length(&v), 2);
+        p = cgs_vector_data(&v);
+        assert_int_equal(p[0], 3);
+        assert_int_equal(p[1], 4);
+
+        cgs_vector_free(&v);
+}
+
+static void
+vector_small_test(void** state)
+{
+        (void)state;
+        const size_t n_local = CGS_VECTOR_INLINE_SIZE / sizeof(int);
+
+        struct cgs_vector v = cgs_vector_new_small(sizeof(int));
+        assert_int_equal(v.length, 0);
+        assert_int_equal(v.capacity, n_local);
+        assert_null(v.data);
+
+        for (int i = 0; i < (int)n_local; ++i)
+                cgs_vector_push(&v, &i);
+        assert_null(v.data);                    // still inline
+        assert_ptr_equal(cgs_vector_data(&v), v.local.bytes);
+        assert_int_equal(*(const int*)cgs_vector_last(&v), n_local - 1);
+
+        // moving a small vector keeps its elements
+        struct cgs_vector moved = v;
+        memset(&v, 0xff, sizeof(v));
+        assert_int_equal(*(const int*)cgs_vector_get(&moved, 2), 2);
+
+        int x = 99;
+        cgs_vector_push(&moved, &x);            // spills to heap
+        assert_non_null(moved.data);
+        assert_int_equal(cgs_vector_length(&moved), n_local + 1);
+        int sum = 0;
+        for (const int* b = cgs_vector_begin(&moved),
+                        *e = cgs_vector_end(&moved); b != e; ++b)
+                sum += *b;
+        assert_int_equal(sum, (int)(n_local * (n_local - 1) / 2) + 99);
+
+        cgs_vector_free(&moved);
+
+        struct cgs_vector big = cgs_vector_new_small(CGS_VECTOR_INLINE_SIZE + 1);
+        assert_int_equal(big.capacity, 0);
+}
+
+static void
+vector_small_xfer_test(void** state)
+{
+        (void)state;
+        struct cgs_vector v = cgs_vector_new_small(sizeof(int));
+        for (int i = 1; i <= 3; ++i)
+                cgs_vector_push(&v, &i);
+
+        size_t len = 0;
+        int* p = cgs_vector_xfer(&v, &len);
+        assert_non_null(p);
+        assert_int_equal(len, 3);
+        assert_int_equal(p[0], 1);
+        assert_int_equal(p[2], 3);
+        free(p);
+
+        struct cgs_vector vp = cgs_vector_new_small(sizeof(char*));
+        char* s = cgs_strdup("Anola");
+        cgs_vector_push(&vp, &s);
+        cgs_vector_free_all(&vp);
+}
+
+static void
+count_visits(const void* p, size_t i, void* data)
+{
+        (void)p;
+        __atomic_fetch_add(&((size_t*)data)[i], 1, __ATOMIC_RELAXED);
+}
+
+static void
+square_in_place(void* p, size_t i, void* data)
+{
+        (void)i;
+        (void)data;
+        long* x = p;
+        *x *= *x;
+}
+
+static void
+vector_parallel_test(void** state)
+{
+        (void)state;
+        enum { NUM = 1000 };
+
+        struct cgs_vector v = cgs_vector_new(sizeof(long));
+        for (long i = 0; i < NUM; ++i)
+                cgs_vector_push(&v, &i);
+
+        size_t visits[NUM] = { 0 };
+        struct cgs_parallel_opts opts = { .threads = 4, .chunk = 7 };
+        cgs_vector_foreach_parallel(&v, count_visits, visits, &opts);
+        for (size_t i = 0; i < NUM; ++i)
+                assert_int_equal(visits[i], 1);
+
+        cgs_vector_transform_parallel(&v, square_in_place, NULL, NULL);
+        for (long i = 0; i < NUM; ++i)
+                assert_int_equal(*(const long*)cgs_vector_get(&v, i), i * i);
+
+        cgs_vector_free(&v);
+}
+
+static void
+sum_double(void* acc, const void* e)
+{
+        *(double*)acc += *(const double*)e;
+}
+
+static void
+combine_double(void* acc, const void* part)
+{
+        // each partial starts its own cache line
+        assert_int_equal((uintptr_t)part % CGS_PARALLEL_CACHE_LINE, 0);
+        *(double*)acc += *(const double*)part;
+}
+
+static void
+vector_reduce_parallel_test(void** state)
+{
+        (void)state;
+        enum { NUM = 10000 };
+
+        struct cgs_vector v = cgs_vector_new(sizeof(double));
+        for (int i = 0; i < NUM; ++i) {
+                double d = 1.0 / (i + 1);
+                cgs_vector_push(&v, &d);
+        }
+
+        double seq = 0.0;
+        struct cgs_parallel_opts one = { .threads = 1, .chunk = 64,
+                .ordered = 1 };
+        assert_non_null(cgs_vector_reduce_parallel(&v, &seq, sizeof(seq),
+                                sum_double, combine_double, &one));
+
+        // the same chunking gives the same bits on any number of threads
+        struct cgs_parallel_opts many = { .threads = 8, .chunk = 64,
+                .ordered = 1 };
+        for (int run = 0; run < 5; ++run) {
+                double par = 0.0;
+                assert_non_null(cgs_vector_reduce_parallel(&v, &par,
+                                        sizeof(par), sum_double,
+                                        combine_double, &many));
+                assert_memory_equal(&par, &seq, sizeof(double));
+        }
+
+        double fast = 0.0;
+        assert_non_null(cgs_vector_reduce_parallel(&v, &fast, sizeof(fast),
+                                sum_double, combine_double, NULL));
+        assert_true(fast > seq - 1e-9 && fast < seq + 1e-9);
+
+        struct cgs_vector empty = cgs_vector_new(sizeof(double));
+        double zero = 0.0;
+        assert_non_null(cgs_vector_reduce_parallel(&empty, &zero,
+                                sizeof(zero), sum_double, combine_double,
+                                NULL));
+        assert_true(zero == 0.0);
+
+        cgs_vector_free(&v);
+}
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
  * Main
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */ 
@@ -539,6 +897,16 @@ int main(void)
 		cmocka_unit_test(vector_foreach_test),
 		cmocka_unit_test(vector_transform_test),
 		cmocka_unit_test(vector_min_max_test),
+		cmocka_unit_test(vector_reserve_resize_test),
+		cmocka_unit_test(vector_growth_test),
+		cmocka_unit_test(vector_extend_test),
+		cmocka_unit_test(vector_insert_range_test),
+		cmocka_unit_test(vector_remove_if_test),
+		cmocka_unit_test(vector_remove_if_stateful_test),
+		cmocka_unit_test(vector_small_test),
+		cmocka_unit_test(vector_small_xfer_test),
+		cmocka_unit_test(vector_parallel_test),
+		cmocka_unit_test(vector_reduce_parallel_test),
 	};
 
 	return cmocka_run_group_tests(tests, setup_random, teardown_ptr);